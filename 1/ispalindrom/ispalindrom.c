@@ -2,20 +2,28 @@
  * The main module.
  * @brief Entry point of the program.
  * @details The program reads from stdin or other files and evaluates for each line, if it was a palindrom.<br>
- * The response will be printed to stdout and can additionally be written to a specified output file.
+ * The response will be printed to stdout or, if specified, written to an output file instead (see output.h).<br>
+ * Regular files can be evaluated by several threads at once (see parallel.h), and lines can be compared by UTF-8
+ * code points instead of bytes (see unicode.h).
  * @file ispalindrom.c
  * @author Tobias Gruber, 11912367
  * @date 12.10.2022
  */
 
-#include "strfun.h"
+#include "palindrom.h"
+#include "unicode.h"
+#include "parallel.h"
+#include "output.h"
 #include <stdio.h>
 #include <getopt.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 
 /**
  * @brief Options of the program.
@@ -24,9 +32,11 @@
 struct Options {
     int ignore_casing; /**< Whether letter spacing is ignored. */
     int ignore_whitespaces; /**< Whether whitespaces are ignored. */
-    int output_to_file; /**< Whether the output should also be written to a file. */
+    int utf8; /**< Whether lines are checked by UTF-8 code points instead of bytes. */
+    int output_to_file; /**< Whether the output should be written to a file instead of stdout. */
     char *output_path; /**< Output file path. */
-    FILE *output_fp; /**< Output file stream. */
+    struct Output output; /**< Output the results are appended to. */
+    int threads; /**< Count of threads that evaluate regular files, 0 if they are evaluated line by line. */
 };
 
 static char *prog_name; /**< The program's name. */
@@ -38,7 +48,7 @@ static char *prog_name; /**< The program's name. */
  * Used global variables: prog_name
  */
 static void usage(void) {
-    fprintf(stderr, "Usage: %s [-s] [-i] [-o outfile] [file...]\n", prog_name);
+    fprintf(stderr, "Usage: %s [-s] [-i] [-u] [-t threads] [-o outfile] [file...]\n", prog_name);
     exit(EXIT_FAILURE);
 }
 
@@ -51,7 +61,8 @@ static void usage(void) {
  */
 static void evaluate_options(int argc, char *argv[], struct Options *options) {
     int option; /**< Currently evaluated option. */
-    while((option = getopt(argc, argv, "iso:")) > 0) {
+    int threads_given = 0; /**< Count of passed -t options. */
+    while((option = getopt(argc, argv, "isuo:t:")) > 0) {
         switch(option) {
             case 'i': {
                 ++options->ignore_casing;
@@ -61,34 +72,42 @@ static void evaluate_options(int argc, char *argv[], struct Options *options) {
                 ++options->ignore_whitespaces;
                 break;
             }
+            case 'u': {
+                ++options->utf8;
+                break;
+            }
             case 'o': {
                 ++options->output_to_file;
                 options->output_path = optarg;
                 break;
             }
+            case 't': {
+                ++threads_given;
+                char *end; /**< End of the parsed number. */
+                long threads = strtol(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || threads < 1 || threads > 1024) usage();
+                options->threads = (int) threads;
+                break;
+            }
             case '?':
             default: {
                 usage();
             }
         }
     }
-    if (options->ignore_whitespaces > 1 || options->ignore_casing > 1 || options->output_to_file > 1) {
+    if (options->ignore_whitespaces > 1 || options->ignore_casing > 1 || options->utf8 > 1 ||
+        options->output_to_file > 1 || threads_given > 1) {
         usage();
     }
 }
 
 /**
- * @brief Checks if a string is a palindrom.
- * @details Compares the leftmost and the rightmost characters and brings them with each step closer.<br>
- * Continue until every character was compared or unequal characters were found.
- * @param src String to be checked.
- * @return 1 if src is a palindrom, 0 otherwise.
+ * @brief Returns the name of the output for error messages.
+ * @param options Program options.
+ * @return Output file path, or "stdout".
  */
-static int is_palindrom(char src[]) {
-    for (int i = 0; i < strlen(src) / 2 + 1; i++) {
-        if (src[i] != src[strlen(src) - 1 - i]) return 0;
-    }
-    return 1;
+static const char *output_name(struct Options *options) {
+    return options->output_to_file ? options->output_path : "stdout";
 }
 
 /**
@@ -102,43 +121,53 @@ static int is_palindrom(char src[]) {
  */
 static int evaluate_file(FILE *fp, struct Options *options) {
     char *line = NULL; /**< String of the current line. */
-    size_t len = 0; /**< Length of the current line. */
-    while ((getline(&line, &len, fp)) > 0) {
-        remove_newline(line);
-        if (strlen(line) <= 0) continue;
-        char evaluated[strlen(line) + 1]; /**< Manipulated line (based on options) that will be evaluated. */
-        strcpy(evaluated, line);
-        if (options->ignore_whitespaces) {
-            char temp[strlen(evaluated) + 1];
-            strcpy(temp, evaluated);
-            trim(evaluated, temp);
-        }
-        if (options->ignore_casing) to_lower(evaluated);
-        char palindromSuffix[] = " is a palindrom\n"; /**< Line suffix, printed if palindrom. */
-        char noPalindromSuffix[] = " is not a palindrom\n"; /**< Line suffix, printed if no palindrom. */
-        char line_res[strlen(line) + strlen(noPalindromSuffix) + 1]; /**< Printed response for this line. */
-        strcpy(line_res, line);
-        strcat(line_res, is_palindrom(evaluated) ? palindromSuffix : noPalindromSuffix);
-        if (options->output_to_file) {
-            if (fprintf(options->output_fp, "%s", line_res) < 0) {
-                fprintf(stderr, "[%s] ERROR: fprintf failed for file '%s': %s\n", prog_name, options->output_path, strerror(errno));
-                free(line);
-                return -1;
-            }
-        } else {
-            printf("%s", line_res);
+    size_t cap = 0; /**< Capacity of the current line. */
+    ssize_t len; /**< Length of the current line. */
+    while ((len = getline(&line, &cap, fp)) > 0) {
+        if (line[len - 1] == '\n') len--;
+        if (len == 0) continue;
+        int res = options->utf8 ? check_line_utf8(line, len, options->ignore_whitespaces, options->ignore_casing)
+            : check_line(line, len, options->ignore_whitespaces, options->ignore_casing);
+        if (output_line(&options->output, line, len, res) == -1) {
+            fprintf(stderr, "[%s] ERROR: writev failed for file '%s': %s\n", prog_name, output_name(options),
+                strerror(errno));
+            free(line);
+            return -1;
         }
     }
     free(line);
     return 0;
 }
 
+/**
+ * @brief Performs a palindrom check for every line of an input.
+ * @details Regular files are evaluated by several threads if the options ask for it, other inputs line by line.
+ * @param fp Pointer to the read file.
+ * @param options Program options.
+ * @return 0 on success, -1 on error.
+ */
+static int evaluate_input(FILE *fp, struct Options *options) {
+    struct stat st; /**< Status of the input. */
+    if (options->threads == 0 || fstat(fileno(fp), &st) == -1 || !S_ISREG(st.st_mode)) {
+        return evaluate_file(fp, options);
+    }
+    int threads = options->threads; /**< Count of worker threads. */
+    int res = evaluate_parallel(fileno(fp), &options->output, threads, options->ignore_whitespaces,
+        options->ignore_casing, options->utf8); /**< Result of the evaluation. */
+    if (res == -1) {
+        fprintf(stderr, "[%s] ERROR: evaluate_parallel failed: %s\n", prog_name, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * @brief Entry point of the program.
  * @details Structures the procedure of the program based on given options and arguments.<br>
  * It reads from stdin or other files and evaluates for each line, if it was a palindrom.<br>
- * Based on the options, it respects casing and whitespaces for the input or not.<br>
- * The response will be printed to stdout and is optionally written to a specified output file.<br>
+ * Based on the options, it respects casing and whitespaces for the input or not, decodes UTF-8 and evaluates
+ * regular files with several threads.<br>
+ * The response is buffered and printed to stdout or, if specified, written to an output file instead.<br>
  * Exits the program with EXIT_FAILURE in case of errors.<br>
  * Used global variables: prog_name
  *
@@ -148,38 +177,49 @@ static int evaluate_file(FILE *fp, struct Options *options) {
  * */
 int main(int argc, char *argv[]) {
     prog_name = argv[0];
-    struct Options options = {0, 0, 0, NULL, NULL}; /**< Program options. */
+    struct Options options = {0, 0, 0, 0, NULL, {-1, NULL, 0}, 0}; /**< Program options. */
     evaluate_options(argc, argv, &options);
+    int fd = STDOUT_FILENO; /**< File descriptor the results are written to. */
     if (options.output_to_file) {
-        options.output_fp = fopen(options.output_path, "w");
-        if (options.output_fp == NULL) {
-            fprintf(stderr, "[%s] ERROR: fopen failed for file '%s': %s\n", prog_name, options.output_path, strerror(errno));
+        fd = open(options.output_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd == -1) {
+            fprintf(stderr, "[%s] ERROR: open failed for file '%s': %s\n", prog_name, options.output_path,
+                strerror(errno));
             exit(EXIT_FAILURE);
         }
     }
+    if (output_init(&options.output, fd) == -1) {
+        fprintf(stderr, "[%s] ERROR: malloc failed: %s\n", prog_name, strerror(errno));
+        if (options.output_to_file) close(fd);
+        exit(EXIT_FAILURE);
+    }
+    int failed = 0; /**< Whether an input could not be evaluated. */
     int has_input_files = optind < argc;
     if (has_input_files) {
-        for(; optind < argc; optind++){
+        for(; optind < argc && !failed; optind++){
             char *file_path = argv[optind]; /**< Path to the input file. */
             FILE *input_fp = fopen(file_path, "r");
             if (input_fp == NULL) {
                 fprintf(stderr, "[%s] ERROR: fopen failed for file '%s': %s\n", prog_name, file_path, strerror(errno));
-                if (options.output_to_file) fclose(options.output_fp);
-                exit(EXIT_FAILURE);
-            }
-            if (evaluate_file(input_fp, &options) == -1) {
-                fclose(input_fp);
-                if (options.output_to_file) fclose(options.output_fp);
-                exit(EXIT_FAILURE);
+                failed = 1;
+                break;
             }
+            if (evaluate_input(input_fp, &options) == -1) failed = 1;
             fclose(input_fp);
         }
     } else {
-        if (evaluate_file(stdin, &options) == -1) {
-            if (options.output_to_file) fclose(options.output_fp);
-            exit(EXIT_FAILURE);
-        }
+        if (evaluate_input(stdin, &options) == -1) failed = 1;
+    }
+    if (output_flush(&options.output) == -1 && !failed) {
+        fprintf(stderr, "[%s] ERROR: writev failed for file '%s': %s\n", prog_name, output_name(&options),
+            strerror(errno));
+        failed = 1;
+    }
+    output_free(&options.output);
+    if (options.output_to_file && close(fd) == -1 && !failed) {
+        fprintf(stderr, "[%s] ERROR: close failed for file '%s': %s\n", prog_name, options.output_path,
+            strerror(errno));
+        failed = 1;
     }
-    if (options.output_to_file) fclose(options.output_fp);
-    return EXIT_SUCCESS;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
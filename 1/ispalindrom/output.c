@@ -0,0 +1,98 @@
+/**
+ * Output module.
+ * @brief Implementation of the output module definitions.
+ * @file output.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include "output.h"
+#include "palindrom.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/uio.h>
+
+#define IOV_N 3 /**< Maximum count of parts of a write. */
+
+/**
+ * @brief Writes all parts, continuing after short writes and interrupts.
+ * @param fd File descriptor.
+ * @param iov Parts to be written, which are updated.
+ * @param iov_c Count of parts.
+ * @return 0 on success, -1 on error.
+ */
+static int write_all(int fd, struct iovec *iov, int iov_c) {
+    while (iov_c > 0) {
+        ssize_t n = writev(fd, iov, iov_c); /**< Count of written bytes. */
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        while (iov_c > 0 && (size_t) n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iov_c--;
+        }
+        if (iov_c > 0) {
+            iov->iov_base = (char *) iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Appends parts to the buffer, or writes them together with the buffer if they do not fit.
+ * @param out Output.
+ * @param iov Parts to be appended.
+ * @param iov_c Count of parts (at most IOV_N - 1).
+ * @return 0 on success, -1 on error.
+ */
+static int append(struct Output *out, const struct iovec *iov, int iov_c) {
+    size_t len = 0; /**< Length of all parts. */
+    for (int i = 0; i < iov_c; i++) len += iov[i].iov_len;
+    if (out->len + len > OUTPUT_SIZE) {
+        struct iovec all[IOV_N] = { { out->buf, out->len } }; /**< Buffer followed by the parts. */
+        memcpy(all + 1, iov, iov_c * sizeof(struct iovec));
+        out->len = 0;
+        return write_all(out->fd, all, iov_c + 1);
+    }
+    for (int i = 0; i < iov_c; i++) {
+        memcpy(out->buf + out->len, iov[i].iov_base, iov[i].iov_len);
+        out->len += iov[i].iov_len;
+    }
+    return 0;
+}
+
+int output_init(struct Output *out, int fd) {
+    out->fd = fd;
+    out->len = 0;
+    out->buf = malloc(OUTPUT_SIZE);
+    return (out->buf == NULL) ? -1 : 0;
+}
+
+int output_line(struct Output *out, const char *line, size_t len, int palindrom) {
+    struct iovec iov[2] = {
+        { (void *) line, len },
+        palindrom ? (struct iovec) { PALINDROM_SUFFIX, sizeof(PALINDROM_SUFFIX) - 1 }
+            : (struct iovec) { NO_PALINDROM_SUFFIX, sizeof(NO_PALINDROM_SUFFIX) - 1 }
+    };
+    return append(out, iov, 2);
+}
+
+int output_write(struct Output *out, const char *data, size_t len) {
+    struct iovec iov = { (void *) data, len };
+    return append(out, &iov, 1);
+}
+
+int output_flush(struct Output *out) {
+    struct iovec iov = { out->buf, out->len };
+    out->len = 0;
+    return write_all(out->fd, &iov, 1);
+}
+
+void output_free(struct Output *out) {
+    free(out->buf);
+    out->buf = NULL;
+}
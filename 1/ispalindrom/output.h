@@ -0,0 +1,64 @@
+/**
+ * Output module definitions.
+ * @brief Provides buffered writing of the results.
+ * @details Results are copied into a buffer of OUTPUT_SIZE bytes and written with writev() once the buffer is full, so
+ * millions of short lines need only a few system calls and no formatting. Data that does not fit anymore is written
+ * together with the buffer in one call, without being copied.
+ * @file output.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include <stddef.h>
+
+#define OUTPUT_SIZE 1048576 /**< Size of the buffer. */
+
+/**
+ * @brief Buffered output.
+ */
+struct Output {
+    int fd; /**< File descriptor the results are written to. */
+    char *buf; /**< Buffered results. */
+    size_t len; /**< Length of the buffered results. */
+};
+
+/**
+ * @brief Sets up an output.
+ * @details Must be released with output_free() on success.
+ * @param out Output to be initialized.
+ * @param fd File descriptor the results are written to.
+ * @return 0 on success, -1 on error (errno is set).
+ */
+int output_init(struct Output *out, int fd);
+
+/**
+ * @brief Appends the result of a line.
+ * @param out Output.
+ * @param line Checked line (without newline, does not need to be null terminated).
+ * @param len Length of the line.
+ * @param palindrom Whether the line is a palindrom.
+ * @return 0 on success, -1 on error (errno is set).
+ */
+int output_line(struct Output *out, const char *line, size_t len, int palindrom);
+
+/**
+ * @brief Appends bytes, e.g. results that are already formatted.
+ * @param out Output.
+ * @param data Bytes to be appended.
+ * @param len Count of bytes.
+ * @return 0 on success, -1 on error (errno is set).
+ */
+int output_write(struct Output *out, const char *data, size_t len);
+
+/**
+ * @brief Writes the buffered results.
+ * @param out Output.
+ * @return 0 on success, -1 on error (errno is set).
+ */
+int output_flush(struct Output *out);
+
+/**
+ * @brief Releases an output without writing the buffered results.
+ * @param out Output to be released.
+ */
+void output_free(struct Output *out);
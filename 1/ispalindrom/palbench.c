@@ -0,0 +1,171 @@
+/**
+ * Palbench module.
+ * @brief Main entry point for the palindrom check benchmark.
+ * @details Generates palindroms of 16 bytes up to 1 MiB and checks them with check_line(), check_line_scalar() and
+ * check_line_utf8() (whose ASCII check passes them on to check_line()) for every combination of the options -s and
+ * -i. For -i, the casing of the letters differs between both halves, for -s, spaces are spread over the line. So every
+ * check has to compare the whole line.<br>
+ * Each measurement checks about BYTES bytes (set with -b) and reports nanoseconds per line and megabytes per second.
+ * The results of all checks must be palindroms.<br>
+ * Results are printed as CSV to <strong>stdout</strong>, so they can be compared across builds.
+ * @file palbench.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include "palindrom.h"
+#include "unicode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <time.h>
+
+#define MIN_LENGTH 16 /**< Length of the shortest line. */
+#define MAX_LENGTH 1048576 /**< Length of the longest line. */
+#define DEFAULT_BYTES (256LL << 20) /**< Default count of bytes checked per measurement. */
+#define SPACE_EVERY 6 /**< Average distance of spaces in lines for -s. */
+
+/**
+ * @brief Check to be measured.
+ */
+struct Kernel {
+    const char *name; /**< Name printed in the results. */
+    int (*check)(const char *line, size_t len, int ignore_whitespaces, int ignore_casing); /**< Check function. */
+};
+
+static const struct Kernel kernels[] = {
+    { "dispatch", check_line },
+    { "scalar", check_line_scalar },
+    { "utf8", check_line_utf8 }
+}; /**< All measured checks. */
+
+static char *prog_name; /**< The program's name. */
+
+/**
+ * @brief Prints the usage of the program to stderr and exists with an error.
+ * @details Used global variables: prog_name
+ */
+static void usage(void) {
+    fprintf(stderr, "Usage: %s [-b BYTES] [-l LENGTH]\n", prog_name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses a positive number argument.
+ * @details Exits the program with EXIT_FAILURE on invalid input.
+ * @param arg Argument to be parsed.
+ * @return Parsed number.
+ */
+static long long parse_number(const char *arg) {
+    char *end;
+    errno = 0;
+    long long res = strtoll(arg, &end, 10);
+    if (errno != 0 || *end != '\0' || res <= 0) usage();
+    return res;
+}
+
+/**
+ * @brief Fills a line with a palindrom for the passed options.
+ * @details Spaces are placed first, the letters are then filled in from both ends.
+ * @param line Line to be filled.
+ * @param len Length of the line.
+ * @param ignore_whitespaces Whether spaces are spread over the line.
+ * @param ignore_casing Whether letters of the right half get a random casing.
+ */
+static void fill_line(char *line, size_t len, int ignore_whitespaces, int ignore_casing) {
+    for (size_t i = 0; i < len; i++) line[i] = (ignore_whitespaces && rand() % SPACE_EVERY == 0) ? ' ' : 'a';
+    size_t left = 0; /**< Next position from the left. */
+    size_t right = len; /**< Position after the next position from the right. */
+    while (1) {
+        while (left < right && line[left] == ' ') left++;
+        while (left < right && line[right - 1] == ' ') right--;
+        if (right - left < 2) break;
+        char c = 'a' + rand() % 26;
+        line[left++] = c;
+        line[--right] = (ignore_casing && rand() % 2) ? c - 'a' + 'A' : c;
+    }
+}
+
+/**
+ * @brief Measures a check.
+ * @param kernel Check to be measured.
+ * @param line Line to be checked.
+ * @param len Length of the line.
+ * @param bytes Count of bytes to be checked.
+ * @param ignore_whitespaces Whether whitespaces are ignored.
+ * @param ignore_casing Whether letter casing is ignored.
+ * @param count Pointer to the count of checked lines, which is set.
+ * @param ok Pointer to whether every check found a palindrom, which is set.
+ * @return Elapsed wall clock time in nanoseconds.
+ */
+static double measure(const struct Kernel *kernel, const char *line, size_t len, long long bytes,
+    int ignore_whitespaces, int ignore_casing, long long *count, int *ok) {
+    long long n = (bytes + len - 1) / len; /**< Count of checks. */
+    int res = 1; /**< Whether every check found a palindrom. */
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long long i = 0; i < n; i++) res &= kernel->check(line, len, ignore_whitespaces, ignore_casing);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *count = n;
+    *ok = res;
+    return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+/**
+ * @brief Entry point of the benchmark.
+ * @details Prints one CSV line per length, options and check to <strong>stdout</strong>.<br>
+ * Exits with <strong>EXIT_FAILURE</strong> if a check did not find a palindrom.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ * @return <strong>EXIT_SUCCESS</strong> if all checks found palindroms.
+ */
+int main(int argc, char **argv) {
+    prog_name = argv[0];
+    long long bytes = DEFAULT_BYTES; /**< Count of bytes checked per measurement. */
+    long long only = 0; /**< Only length to be measured, 0 for all. */
+    int option; /**< Currently evaluated option. */
+    while ((option = getopt(argc, argv, "b:l:")) > 0) {
+        switch (option) {
+            case 'b':
+                bytes = parse_number(optarg);
+                break;
+            case 'l':
+                only = parse_number(optarg);
+                break;
+            default:
+                usage();
+        }
+    }
+    if (optind != argc) usage();
+    size_t cap = (only > MAX_LENGTH) ? only : MAX_LENGTH; /**< Capacity of the line. */
+    char *line = malloc(cap);
+    if (line == NULL) {
+        fprintf(stderr, "[%s] ERROR: malloc failed: %s\n", prog_name, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    int failed = 0; /**< Whether a check did not find a palindrom. */
+    printf("length,options,check,lines,ns_per_line,mb_per_s,result\n");
+    for (size_t len = (only > 0) ? only : MIN_LENGTH; len <= cap; len *= 4) {
+        for (int mode = 0; mode < 4; mode++) {
+            int ignore_whitespaces = mode & 1; /**< Whether -s is measured. */
+            int ignore_casing = (mode & 2) != 0; /**< Whether -i is measured. */
+            const char *options[] = { "none", "-s", "-i", "-s -i" };
+            srand(len);
+            fill_line(line, len, ignore_whitespaces, ignore_casing);
+            for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+                long long count;
+                int ok;
+                double ns = measure(&kernels[k], line, len, bytes, ignore_whitespaces, ignore_casing, &count, &ok);
+                printf("%zu,%s,%s,%lld,%.1f,%.1f,%s\n", len, options[mode], kernels[k].name, count, ns / count,
+                    (ns > 0) ? count * len / ns * 1e3 : 0, ok ? "ok" : "fail");
+                fflush(stdout);
+                if (!ok) failed = 1;
+            }
+        }
+        if (only > 0) break;
+    }
+    free(line);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
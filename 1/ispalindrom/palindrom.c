@@ -0,0 +1,230 @@
+/**
+ * Palindrom module.
+ * @brief Implementation of the palindrom module definitions.
+ * @file palindrom.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include "palindrom.h"
+#include <ctype.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PALINDROM_SIMD
+#include <immintrin.h>
+#endif
+
+#define ASCII_SPACE 32
+#define SIMD_MIN 64 /**< Minimum length of lines that are checked with vector instructions. */
+#define STREAM_CAP 48 /**< Capacity of a stream of compacted characters. */
+
+int check_line_scalar(const char *line, size_t len, int ignore_whitespaces, int ignore_casing) {
+    const unsigned char *left = (const unsigned char *) line; /**< Next character from the left. */
+    const unsigned char *right = left + len; /**< Position after the next character from the right. */
+    while (1) {
+        if (ignore_whitespaces) {
+            while (left < right && *left == ASCII_SPACE) left++;
+            while (left < right && right[-1] == ASCII_SPACE) right--;
+        }
+        if (right - left < 2) return 1;
+        int a = *left++; /**< Character from the left. */
+        int b = *--right; /**< Character from the right. */
+        if (ignore_casing) {
+            a = tolower(a);
+            b = tolower(b);
+        }
+        if (a != b) return 0;
+    }
+}
+
+#ifdef PALINDROM_SIMD
+
+/**
+ * @brief Characters without spaces, taken from one end of a line.
+ * @details Characters from the right end are stored in reverse order, so both streams are compared index by index.
+ */
+struct Stream {
+    unsigned char buf[STREAM_CAP]; /**< Characters that are not compared yet. */
+    size_t len; /**< Count of characters. */
+};
+
+static unsigned char compact_table[256][8]; /**< Shuffle indices that move the non-spaces of 8 bytes to the front. */
+static unsigned char compact_len[256]; /**< Count of non-spaces of 8 bytes. */
+
+/**
+ * @brief Fills the compaction tables.
+ * @details Entry m holds the indices of the bytes whose bit in m is not set, followed by 0x80 (which yields 0).
+ */
+static void init_compact_table(void) __attribute__((constructor));
+static void init_compact_table(void) {
+    for (int mask = 0; mask < 256; mask++) {
+        int n = 0; /**< Count of indices in the entry. */
+        for (int i = 0; i < 8; i++) {
+            if ((mask & (1 << i)) == 0) compact_table[mask][n++] = i;
+        }
+        compact_len[mask] = n;
+        while (n < 8) compact_table[mask][n++] = 0x80;
+    }
+}
+
+/**
+ * @brief Converts the upper case letters of 16 bytes to lower case.
+ * @details Shifts 'A' to -128, so upper case letters are the only bytes below -102 (signed), and sets their bit 0x20.
+ * @param x Bytes to be converted.
+ * @return Converted bytes.
+ */
+__attribute__((target("ssse3")))
+static inline __m128i fold_sse(__m128i x) {
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(-102), _mm_add_epi8(x, _mm_set1_epi8(0x80 - 'A')));
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+/**
+ * @brief Converts the upper case letters of 32 bytes to lower case (see fold_sse()).
+ * @param x Bytes to be converted.
+ * @return Converted bytes.
+ */
+__attribute__((target("avx2")))
+static inline __m256i fold_avx2(__m256i x) {
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(-102), _mm256_add_epi8(x, _mm256_set1_epi8(0x80 - 'A')));
+    return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+/**
+ * @brief Checks a line with 16 bytes from each end at a time.
+ * @details The block from the right end is reversed with a shuffle, so it is compared to the left block at once.
+ * @param left First character of the line.
+ * @param right Position after the last character of the line.
+ * @param ignore_casing Whether letter casing is ignored.
+ * @return 1 if the line is a palindrom, 0 otherwise.
+ */
+__attribute__((target("ssse3")))
+static int check_sse(const unsigned char *left, const unsigned char *right, int ignore_casing) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    while (right - left >= 32) {
+        __m128i a = _mm_loadu_si128((const __m128i *) left);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (right - 16)), reverse);
+        if (ignore_casing) {
+            a = fold_sse(a);
+            b = fold_sse(b);
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) return 0;
+        left += 16;
+        right -= 16;
+    }
+    return check_line_scalar((const char *) left, right - left, 0, ignore_casing);
+}
+
+/**
+ * @brief Checks a line with 32 bytes from each end at a time.
+ * @details Like check_sse(), the reverse shuffle works within 128 bit lanes, so the lanes are swapped afterwards. The
+ * upper halves of the registers are cleared before the rest is passed to the SSE code.
+ * @param left First character of the line.
+ * @param right Position after the last character of the line.
+ * @param ignore_casing Whether letter casing is ignored.
+ * @return 1 if the line is a palindrom, 0 otherwise.
+ */
+__attribute__((target("avx2")))
+static int check_avx2(const unsigned char *left, const unsigned char *right, int ignore_casing) {
+    const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    while (right - left >= 64) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) left);
+        __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *) (right - 32)), reverse);
+        b = _mm256_permute2x128_si256(b, b, 1);
+        if (ignore_casing) {
+            a = fold_avx2(a);
+            b = fold_avx2(b);
+        }
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) != -1) return 0;
+        left += 32;
+        right -= 32;
+    }
+    _mm256_zeroupper();
+    return check_sse(left, right, ignore_casing);
+}
+
+/**
+ * @brief Appends the characters of 16 bytes that are not spaces to a stream.
+ * @details Each half is compacted with a shuffle from the compaction table. The stream must hold less than 16
+ * characters, as every half is stored with 8 bytes.
+ * @param s Stream to be appended to.
+ * @param x Bytes to be appended.
+ */
+__attribute__((target("ssse3")))
+static void push_block(struct Stream *s, __m128i x) {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8(ASCII_SPACE))); /**< Bits of the spaces. */
+    __m128i lo = _mm_shuffle_epi8(x, _mm_loadl_epi64((const __m128i *) compact_table[mask & 0xFF]));
+    __m128i hi = _mm_shuffle_epi8(_mm_srli_si128(x, 8), _mm_loadl_epi64((const __m128i *) compact_table[mask >> 8]));
+    _mm_storel_epi64((__m128i *) (s->buf + s->len), lo);
+    s->len += compact_len[mask & 0xFF];
+    _mm_storel_epi64((__m128i *) (s->buf + s->len), hi);
+    s->len += compact_len[mask >> 8];
+}
+
+/**
+ * @brief Checks a line with 16 bytes from each end at a time, ignoring spaces.
+ * @details Blocks from both ends are compacted into two streams (the right one reversed), which are compared 16
+ * characters at a time. Once the ends are closer than two blocks, the rest of both streams and the bytes between
+ * the ends are checked by the scalar check.
+ * @param left First character of the line.
+ * @param right Position after the last character of the line.
+ * @param ignore_casing Whether letter casing is ignored.
+ * @return 1 if the line is a palindrom, 0 otherwise.
+ */
+__attribute__((target("ssse3")))
+static int check_compact(const unsigned char *left, const unsigned char *right, int ignore_casing) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    struct Stream front; /**< Characters from the left end. */
+    struct Stream back; /**< Characters from the right end, reversed. */
+    front.len = 0;
+    back.len = 0;
+    while (right - left >= 32) {
+        if (front.len < 16) {
+            push_block(&front, _mm_loadu_si128((const __m128i *) left));
+            left += 16;
+        }
+        if (back.len < 16) {
+            push_block(&back, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (right - 16)), reverse));
+            right -= 16;
+        }
+        if (front.len < 16 || back.len < 16) continue;
+        __m128i a = _mm_loadu_si128((const __m128i *) front.buf);
+        __m128i b = _mm_loadu_si128((const __m128i *) back.buf);
+        if (ignore_casing) {
+            a = fold_sse(a);
+            b = fold_sse(b);
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) return 0;
+        _mm_storeu_si128((__m128i *) front.buf, _mm_loadu_si128((const __m128i *) (front.buf + 16)));
+        _mm_storeu_si128((__m128i *) back.buf, _mm_loadu_si128((const __m128i *) (back.buf + 16)));
+        front.len -= 16;
+        back.len -= 16;
+    }
+    unsigned char rest[2 * STREAM_CAP + 32]; /**< Characters that are not compared yet, in line order. */
+    size_t n = front.len; /**< Count of characters in rest. */
+    memcpy(rest, front.buf, front.len);
+    memcpy(rest + n, left, right - left);
+    n += right - left;
+    for (size_t i = back.len; i > 0; i--) rest[n++] = back.buf[i - 1];
+    return check_line_scalar((const char *) rest, n, 1, ignore_casing);
+}
+
+#endif
+
+int check_line(const char *line, size_t len, int ignore_whitespaces, int ignore_casing) {
+#ifdef PALINDROM_SIMD
+    if (len >= SIMD_MIN) {
+        const unsigned char *left = (const unsigned char *) line; /**< First character of the line. */
+        if (ignore_whitespaces) {
+            if (__builtin_cpu_supports("ssse3")) return check_compact(left, left + len, ignore_casing);
+        } else if (__builtin_cpu_supports("avx2")) {
+            return check_avx2(left, left + len, ignore_casing);
+        } else if (__builtin_cpu_supports("ssse3")) {
+            return check_sse(left, left + len, ignore_casing);
+        }
+    }
+#endif
+    return check_line_scalar(line, len, ignore_whitespaces, ignore_casing);
+}
@@ -0,0 +1,43 @@
+/**
+ * Palindrom module definitions.
+ * @brief Provides the palindrom check of single lines.
+ * @details Lines are checked in place in a single pass from both ends. Based on the options, whitespaces are skipped
+ * and letters are compared without their casing on the fly. The check is shared by the sequential and the parallel
+ * evaluation.<br>
+ * On x86, long lines are compared a block from each end at a time with AVX2 or SSSE3, chosen by the features of the
+ * CPU at runtime. The block from the right end is reversed with a shuffle and letters are converted to lower case
+ * with vector compares. If whitespaces are ignored, spaces are removed from the blocks with a shuffle before they are
+ * compared. Other CPUs use the scalar check.
+ * @file palindrom.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include <stddef.h>
+
+#define PALINDROM_SUFFIX " is a palindrom\n" /**< Line suffix, printed if palindrom. */
+#define NO_PALINDROM_SUFFIX " is not a palindrom\n" /**< Line suffix, printed if no palindrom. */
+
+/**
+ * @brief Checks if a line is a palindrom.
+ * @details Uses the fastest check supported by the CPU. A line without characters besides ignored whitespaces is a
+ * palindrom.
+ * @param line Line to be checked (without newline, does not need to be null terminated).
+ * @param len Length of the line.
+ * @param ignore_whitespaces Whether whitespaces are ignored.
+ * @param ignore_casing Whether letter casing is ignored.
+ * @return 1 if the line is a palindrom, 0 otherwise.
+ */
+int check_line(const char *line, size_t len, int ignore_whitespaces, int ignore_casing);
+
+/**
+ * @brief Checks if a line is a palindrom without vector instructions.
+ * @details Compares the leftmost and the rightmost characters and brings them with each step closer, until they meet
+ * or unequal characters were found. Used for short lines, for the rest of long lines and as reference.
+ * @param line Line to be checked (without newline, does not need to be null terminated).
+ * @param len Length of the line.
+ * @param ignore_whitespaces Whether whitespaces are ignored.
+ * @param ignore_casing Whether letter casing is ignored.
+ * @return 1 if the line is a palindrom, 0 otherwise.
+ */
+int check_line_scalar(const char *line, size_t len, int ignore_whitespaces, int ignore_casing);
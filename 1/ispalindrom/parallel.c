@@ -0,0 +1,212 @@
+/**
+ * Parallel module.
+ * @brief Implementation of the parallel module definitions.
+ * @file parallel.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include "parallel.h"
+#include "palindrom.h"
+#include "unicode.h"
+#include "output.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Results of a chunk.
+ * @details Slots are reused for every chunk whose index has the same remainder by the count of slots.
+ */
+struct Slot {
+    char *out; /**< Results of the lines of the chunk. */
+    size_t len; /**< Length of the results. */
+    size_t cap; /**< Capacity of the results. */
+    int done; /**< Whether all lines of the chunk are checked. */
+};
+
+/**
+ * @brief State shared by the workers and the writing thread.
+ * @details All members except the mapped file and the options are protected by the lock.
+ */
+struct Shared {
+    pthread_mutex_t lock; /**< Lock of the state. */
+    pthread_cond_t cond; /**< Signaled when a chunk is done or written. */
+    const char *data; /**< Mapped file. */
+    size_t size; /**< Size of the mapped file. */
+    size_t pos; /**< Offset of the first byte that is not in a taken chunk. */
+    size_t taken; /**< Count of chunks taken by the workers. */
+    size_t written; /**< Count of chunks whose results are written. */
+    struct Slot *slots; /**< Slots of the chunks that may be ahead of the written output. */
+    size_t slot_c; /**< Count of slots. */
+    int ignore_whitespaces; /**< Whether whitespaces are ignored. */
+    int ignore_casing; /**< Whether letter casing is ignored. */
+    int utf8; /**< Whether lines are checked by UTF-8 code points. */
+    int err; /**< Error number of the first failure, 0 if nothing failed. */
+};
+
+/**
+ * @brief Appends bytes to the results of a chunk.
+ * @param slot Slot of the chunk.
+ * @param src Bytes to be appended.
+ * @param len Count of bytes.
+ * @return 0 on success, -1 on error.
+ */
+static int append(struct Slot *slot, const char *src, size_t len) {
+    if (slot->len + len > slot->cap) {
+        size_t cap = (slot->cap == 0) ? CHUNK_SIZE : slot->cap * 2;
+        while (cap < slot->len + len) cap *= 2;
+        char *temp = realloc(slot->out, cap);
+        if (temp == NULL) return -1;
+        slot->out = temp;
+        slot->cap = cap;
+    }
+    memcpy(slot->out + slot->len, src, len);
+    slot->len += len;
+    return 0;
+}
+
+/**
+ * @brief Checks every line of a chunk and collects the results.
+ * @param shared Shared state.
+ * @param slot Slot of the chunk.
+ * @param start Offset of the chunk.
+ * @param end Offset after the chunk.
+ * @return 0 on success, -1 on error.
+ */
+static int check_chunk(struct Shared *shared, struct Slot *slot, size_t start, size_t end) {
+    const char *p = shared->data + start;
+    const char *stop = shared->data + end;
+    while (p < stop) {
+        const char *newline = memchr(p, '\n', stop - p);
+        const char *line_end = (newline != NULL) ? newline : stop;
+        size_t len = line_end - p;
+        if (len > 0) {
+            int res = shared->utf8 ? check_line_utf8(p, len, shared->ignore_whitespaces, shared->ignore_casing)
+                : check_line(p, len, shared->ignore_whitespaces, shared->ignore_casing);
+            const char *suffix = res ? PALINDROM_SUFFIX : NO_PALINDROM_SUFFIX;
+            if (append(slot, p, len) == -1 || append(slot, suffix, strlen(suffix)) == -1) return -1;
+        }
+        p = line_end + 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Takes chunks and checks them until the file is done or something failed.
+ * @details A chunk ends after the first newline that follows CHUNK_SIZE bytes.
+ * @param arg Shared state.
+ * @return NULL.
+ */
+static void *work_chunks(void *arg) {
+    struct Shared *shared = arg;
+    pthread_mutex_lock(&shared->lock);
+    while (1) {
+        while (shared->err == 0 && shared->pos < shared->size && shared->taken >= shared->written + shared->slot_c) {
+            pthread_cond_wait(&shared->cond, &shared->lock);
+        }
+        if (shared->err != 0 || shared->pos >= shared->size) break;
+        struct Slot *slot = &shared->slots[shared->taken++ % shared->slot_c];
+        size_t start = shared->pos;
+        size_t end = shared->size;
+        if (shared->size - start > CHUNK_SIZE) {
+            const char *newline = memchr(shared->data + start + CHUNK_SIZE, '\n', shared->size - start - CHUNK_SIZE);
+            if (newline != NULL) end = newline - shared->data + 1;
+        }
+        shared->pos = end;
+        slot->len = 0;
+        slot->done = 0;
+        pthread_mutex_unlock(&shared->lock);
+        int res = check_chunk(shared, slot, start, end);
+        int err = errno;
+        pthread_mutex_lock(&shared->lock);
+        if (res == -1 && shared->err == 0) shared->err = err;
+        slot->done = 1;
+        pthread_cond_broadcast(&shared->cond);
+    }
+    pthread_mutex_unlock(&shared->lock);
+    return NULL;
+}
+
+/**
+ * @brief Writes the results of the chunks in order as they are done.
+ * @param shared Shared state.
+ * @param out Output the results are appended to.
+ */
+static void write_chunks(struct Shared *shared, struct Output *out) {
+    pthread_mutex_lock(&shared->lock);
+    while (1) {
+        struct Slot *slot = &shared->slots[shared->written % shared->slot_c];
+        while (shared->err == 0 && !(shared->written < shared->taken && slot->done) &&
+            !(shared->pos >= shared->size && shared->written == shared->taken)) {
+            pthread_cond_wait(&shared->cond, &shared->lock);
+        }
+        if (shared->err != 0 || shared->written == shared->taken) break;
+        pthread_mutex_unlock(&shared->lock);
+        int res = output_write(out, slot->out, slot->len);
+        int err = errno;
+        pthread_mutex_lock(&shared->lock);
+        if (res == -1 && shared->err == 0) shared->err = err;
+        shared->written++;
+        pthread_cond_broadcast(&shared->cond);
+    }
+    pthread_mutex_unlock(&shared->lock);
+}
+
+int evaluate_parallel(int fd, struct Output *out, int threads, int ignore_whitespaces, int ignore_casing,
+    int utf8) {
+    struct stat st;
+    if (fstat(fd, &st) == -1) return -1;
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    if (start == -1 || start >= st.st_size) return 0;
+    char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return -1;
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    struct Shared shared;
+    memset(&shared, 0, sizeof(shared));
+    shared.data = data;
+    shared.size = st.st_size;
+    shared.pos = start;
+    shared.slot_c = (size_t) threads * CHUNK_WINDOW;
+    shared.ignore_whitespaces = ignore_whitespaces;
+    shared.ignore_casing = ignore_casing;
+    shared.utf8 = utf8;
+    shared.slots = calloc(shared.slot_c, sizeof(struct Slot));
+    pthread_t *workers = calloc(threads, sizeof(pthread_t));
+    if (shared.slots == NULL || workers == NULL) {
+        free(shared.slots);
+        free(workers);
+        munmap(data, st.st_size);
+        errno = ENOMEM;
+        return -1;
+    }
+    pthread_mutex_init(&shared.lock, NULL);
+    pthread_cond_init(&shared.cond, NULL);
+    int worker_c = 0; /**< Count of started workers. */
+    for (; worker_c < threads; worker_c++) {
+        int err = pthread_create(&workers[worker_c], NULL, work_chunks, &shared);
+        if (err == 0) continue;
+        pthread_mutex_lock(&shared.lock);
+        shared.err = err;
+        pthread_cond_broadcast(&shared.cond);
+        pthread_mutex_unlock(&shared.lock);
+        break;
+    }
+    if (worker_c > 0) write_chunks(&shared, out);
+    for (int i = 0; i < worker_c; i++) pthread_join(workers[i], NULL);
+    for (size_t i = 0; i < shared.slot_c; i++) free(shared.slots[i].out);
+    free(shared.slots);
+    free(workers);
+    pthread_cond_destroy(&shared.cond);
+    pthread_mutex_destroy(&shared.lock);
+    munmap(data, st.st_size);
+    if (shared.err != 0) {
+        errno = shared.err;
+        return -1;
+    }
+    return 0;
+}
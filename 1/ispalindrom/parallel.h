@@ -0,0 +1,31 @@
+/**
+ * Parallel module definitions.
+ * @brief Provides the palindrom check of whole files with several threads.
+ * @details The file is mapped into memory and split into chunks of about CHUNK_SIZE bytes, each ending after a newline.
+ * Worker threads take the chunks in order, check their lines and collect the results of a chunk in its own buffer.
+ * The calling thread writes the buffers in the order of the chunks, so the output equals the one of the sequential
+ * check.<br>
+ * Workers are at most CHUNK_WINDOW chunks each ahead of the written output, which bounds the memory of the results.
+ * @file parallel.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+struct Output;
+
+#define CHUNK_SIZE 1048576 /**< Minimum size of a chunk (unless the file ends earlier). */
+#define CHUNK_WINDOW 4 /**< Count of chunks per worker that may be ahead of the written output. */
+
+/**
+ * @brief Checks every line of a regular file with several threads.
+ * @details Starts at the current offset of the file. Lines that are empty are skipped.
+ * @param fd File descriptor of the regular file.
+ * @param out Output the results are appended to.
+ * @param threads Count of worker threads.
+ * @param ignore_whitespaces Whether whitespaces are ignored.
+ * @param ignore_casing Whether letter casing is ignored.
+ * @param utf8 Whether lines are checked by UTF-8 code points (see unicode.h).
+ * @return 0 on success, -1 on error (errno is set).
+ */
+int evaluate_parallel(int fd, struct Output *out, int threads, int ignore_whitespaces, int ignore_casing,
+    int utf8);
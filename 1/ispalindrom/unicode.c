@@ -0,0 +1,454 @@
+/**
+ * Unicode module.
+ * @brief Implementation of the unicode module definitions.
+ * @file unicode.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include "unicode.h"
+#include "palindrom.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UNICODE_SIMD
+#include <immintrin.h>
+#endif
+
+#define INVALID_BASE 0x110000 /**< Value of the first invalid byte, above all code points. */
+#define CODE_POINT_MAX 0x10FFFF /**< Largest code point. */
+#define SEQUENCE_MAX 4 /**< Maximum length of a UTF-8 sequence. */
+
+/**
+ * @brief Run of code points with the same case folding offset.
+ * @details Covers the code points start, start + stride, ... (count code points), each folds to itself plus delta.
+ */
+struct Fold {
+    unsigned start; /**< First code point. */
+    unsigned short count; /**< Count of code points. */
+    int delta; /**< Offset of the folded code points. */
+    unsigned char stride; /**< Distance of the code points. */
+};
+
+/**
+ * Simple case folding (statuses C and S of CaseFolding.txt, Unicode 14.0), sorted by the first code point.
+ */
+static const struct Fold folds[] = {
+    { 0x0041, 26, 32, 1 },
+    { 0x00B5, 1, 775, 1 },
+    { 0x00C0, 23, 32, 1 },
+    { 0x00D8, 7, 32, 1 },
+    { 0x0100, 24, 1, 2 },
+    { 0x0132, 3, 1, 2 },
+    { 0x0139, 8, 1, 2 },
+    { 0x014A, 23, 1, 2 },
+    { 0x0178, 1, -121, 1 },
+    { 0x0179, 3, 1, 2 },
+    { 0x017F, 1, -268, 1 },
+    { 0x0181, 1, 210, 1 },
+    { 0x0182, 2, 1, 2 },
+    { 0x0186, 1, 206, 1 },
+    { 0x0187, 1, 1, 1 },
+    { 0x0189, 2, 205, 1 },
+    { 0x018B, 1, 1, 1 },
+    { 0x018E, 1, 79, 1 },
+    { 0x018F, 1, 202, 1 },
+    { 0x0190, 1, 203, 1 },
+    { 0x0191, 1, 1, 1 },
+    { 0x0193, 1, 205, 1 },
+    { 0x0194, 1, 207, 1 },
+    { 0x0196, 1, 211, 1 },
+    { 0x0197, 1, 209, 1 },
+    { 0x0198, 1, 1, 1 },
+    { 0x019C, 1, 211, 1 },
+    { 0x019D, 1, 213, 1 },
+    { 0x019F, 1, 214, 1 },
+    { 0x01A0, 3, 1, 2 },
+    { 0x01A6, 1, 218, 1 },
+    { 0x01A7, 1, 1, 1 },
+    { 0x01A9, 1, 218, 1 },
+    { 0x01AC, 1, 1, 1 },
+    { 0x01AE, 1, 218, 1 },
+    { 0x01AF, 1, 1, 1 },
+    { 0x01B1, 2, 217, 1 },
+    { 0x01B3, 2, 1, 2 },
+    { 0x01B7, 1, 219, 1 },
+    { 0x01B8, 1, 1, 1 },
+    { 0x01BC, 1, 1, 1 },
+    { 0x01C4, 1, 2, 1 },
+    { 0x01C5, 1, 1, 1 },
+    { 0x01C7, 1, 2, 1 },
+    { 0x01C8, 1, 1, 1 },
+    { 0x01CA, 1, 2, 1 },
+    { 0x01CB, 9, 1, 2 },
+    { 0x01DE, 9, 1, 2 },
+    { 0x01F1, 1, 2, 1 },
+    { 0x01F2, 2, 1, 2 },
+    { 0x01F6, 1, -97, 1 },
+    { 0x01F7, 1, -56, 1 },
+    { 0x01F8, 20, 1, 2 },
+    { 0x0220, 1, -130, 1 },
+    { 0x0222, 9, 1, 2 },
+    { 0x023A, 1, 10795, 1 },
+    { 0x023B, 1, 1, 1 },
+    { 0x023D, 1, -163, 1 },
+    { 0x023E, 1, 10792, 1 },
+    { 0x0241, 1, 1, 1 },
+    { 0x0243, 1, -195, 1 },
+    { 0x0244, 1, 69, 1 },
+    { 0x0245, 1, 71, 1 },
+    { 0x0246, 5, 1, 2 },
+    { 0x0345, 1, 116, 1 },
+    { 0x0370, 2, 1, 2 },
+    { 0x0376, 1, 1, 1 },
+    { 0x037F, 1, 116, 1 },
+    { 0x0386, 1, 38, 1 },
+    { 0x0388, 3, 37, 1 },
+    { 0x038C, 1, 64, 1 },
+    { 0x038E, 2, 63, 1 },
+    { 0x0391, 17, 32, 1 },
+    { 0x03A3, 9, 32, 1 },
+    { 0x03C2, 1, 1, 1 },
+    { 0x03CF, 1, 8, 1 },
+    { 0x03D0, 1, -30, 1 },
+    { 0x03D1, 1, -25, 1 },
+    { 0x03D5, 1, -15, 1 },
+    { 0x03D6, 1, -22, 1 },
+    { 0x03D8, 12, 1, 2 },
+    { 0x03F0, 1, -54, 1 },
+    { 0x03F1, 1, -48, 1 },
+    { 0x03F4, 1, -60, 1 },
+    { 0x03F5, 1, -64, 1 },
+    { 0x03F7, 1, 1, 1 },
+    { 0x03F9, 1, -7, 1 },
+    { 0x03FA, 1, 1, 1 },
+    { 0x03FD, 3, -130, 1 },
+    { 0x0400, 16, 80, 1 },
+    { 0x0410, 32, 32, 1 },
+    { 0x0460, 17, 1, 2 },
+    { 0x048A, 27, 1, 2 },
+    { 0x04C0, 1, 15, 1 },
+    { 0x04C1, 7, 1, 2 },
+    { 0x04D0, 48, 1, 2 },
+    { 0x0531, 38, 48, 1 },
+    { 0x10A0, 38, 7264, 1 },
+    { 0x10C7, 1, 7264, 1 },
+    { 0x10CD, 1, 7264, 1 },
+    { 0x13F8, 6, -8, 1 },
+    { 0x1C80, 1, -6222, 1 },
+    { 0x1C81, 1, -6221, 1 },
+    { 0x1C82, 1, -6212, 1 },
+    { 0x1C83, 2, -6210, 1 },
+    { 0x1C85, 1, -6211, 1 },
+    { 0x1C86, 1, -6204, 1 },
+    { 0x1C87, 1, -6180, 1 },
+    { 0x1C88, 1, 35267, 1 },
+    { 0x1C90, 43, -3008, 1 },
+    { 0x1CBD, 3, -3008, 1 },
+    { 0x1E00, 75, 1, 2 },
+    { 0x1E9B, 1, -58, 1 },
+    { 0x1E9E, 1, -7615, 1 },
+    { 0x1EA0, 48, 1, 2 },
+    { 0x1F08, 8, -8, 1 },
+    { 0x1F18, 6, -8, 1 },
+    { 0x1F28, 8, -8, 1 },
+    { 0x1F38, 8, -8, 1 },
+    { 0x1F48, 6, -8, 1 },
+    { 0x1F59, 4, -8, 2 },
+    { 0x1F68, 8, -8, 1 },
+    { 0x1F88, 8, -8, 1 },
+    { 0x1F98, 8, -8, 1 },
+    { 0x1FA8, 8, -8, 1 },
+    { 0x1FB8, 2, -8, 1 },
+    { 0x1FBA, 2, -74, 1 },
+    { 0x1FBC, 1, -9, 1 },
+    { 0x1FBE, 1, -7173, 1 },
+    { 0x1FC8, 4, -86, 1 },
+    { 0x1FCC, 1, -9, 1 },
+    { 0x1FD8, 2, -8, 1 },
+    { 0x1FDA, 2, -100, 1 },
+    { 0x1FE8, 2, -8, 1 },
+    { 0x1FEA, 2, -112, 1 },
+    { 0x1FEC, 1, -7, 1 },
+    { 0x1FF8, 2, -128, 1 },
+    { 0x1FFA, 2, -126, 1 },
+    { 0x1FFC, 1, -9, 1 },
+    { 0x2126, 1, -7517, 1 },
+    { 0x212A, 1, -8383, 1 },
+    { 0x212B, 1, -8262, 1 },
+    { 0x2132, 1, 28, 1 },
+    { 0x2160, 16, 16, 1 },
+    { 0x2183, 1, 1, 1 },
+    { 0x24B6, 26, 26, 1 },
+    { 0x2C00, 48, 48, 1 },
+    { 0x2C60, 1, 1, 1 },
+    { 0x2C62, 1, -10743, 1 },
+    { 0x2C63, 1, -3814, 1 },
+    { 0x2C64, 1, -10727, 1 },
+    { 0x2C67, 3, 1, 2 },
+    { 0x2C6D, 1, -10780, 1 },
+    { 0x2C6E, 1, -10749, 1 },
+    { 0x2C6F, 1, -10783, 1 },
+    { 0x2C70, 1, -10782, 1 },
+    { 0x2C72, 1, 1, 1 },
+    { 0x2C75, 1, 1, 1 },
+    { 0x2C7E, 2, -10815, 1 },
+    { 0x2C80, 50, 1, 2 },
+    { 0x2CEB, 2, 1, 2 },
+    { 0x2CF2, 1, 1, 1 },
+    { 0xA640, 23, 1, 2 },
+    { 0xA680, 14, 1, 2 },
+    { 0xA722, 7, 1, 2 },
+    { 0xA732, 31, 1, 2 },
+    { 0xA779, 2, 1, 2 },
+    { 0xA77D, 1, -35332, 1 },
+    { 0xA77E, 5, 1, 2 },
+    { 0xA78B, 1, 1, 1 },
+    { 0xA78D, 1, -42280, 1 },
+    { 0xA790, 2, 1, 2 },
+    { 0xA796, 10, 1, 2 },
+    { 0xA7AA, 1, -42308, 1 },
+    { 0xA7AB, 1, -42319, 1 },
+    { 0xA7AC, 1, -42315, 1 },
+    { 0xA7AD, 1, -42305, 1 },
+    { 0xA7AE, 1, -42308, 1 },
+    { 0xA7B0, 1, -42258, 1 },
+    { 0xA7B1, 1, -42282, 1 },
+    { 0xA7B2, 1, -42261, 1 },
+    { 0xA7B3, 1, 928, 1 },
+    { 0xA7B4, 8, 1, 2 },
+    { 0xA7C4, 1, -48, 1 },
+    { 0xA7C5, 1, -42307, 1 },
+    { 0xA7C6, 1, -35384, 1 },
+    { 0xA7C7, 2, 1, 2 },
+    { 0xA7D0, 1, 1, 1 },
+    { 0xA7D6, 2, 1, 2 },
+    { 0xA7F5, 1, 1, 1 },
+    { 0xAB70, 80, -38864, 1 },
+    { 0xFF21, 26, 32, 1 },
+    { 0x10400, 40, 40, 1 },
+    { 0x104B0, 36, 40, 1 },
+    { 0x10570, 11, 39, 1 },
+    { 0x1057C, 15, 39, 1 },
+    { 0x1058C, 7, 39, 1 },
+    { 0x10594, 2, 39, 1 },
+    { 0x10C80, 51, 64, 1 },
+    { 0x118A0, 32, 32, 1 },
+    { 0x16E40, 32, 32, 1 },
+    { 0x1E900, 34, 34, 1 },
+};
+
+#define FOLD_N (sizeof(folds) / sizeof(folds[0])) /**< Count of runs in the case folding table. */
+
+/**
+ * @brief Applies the simple case folding to a code point.
+ * @param cp Code point (or invalid byte).
+ * @return Folded code point.
+ */
+static unsigned fold(unsigned cp) {
+    if (cp < 0x80) return (cp - 'A' < 26) ? cp + ('a' - 'A') : cp;
+    size_t lo = 0; /**< Count of runs that start at or before the code point. */
+    size_t hi = FOLD_N; /**< Upper bound of lo. */
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (folds[mid].start <= cp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) return cp;
+    const struct Fold *f = &folds[lo - 1];
+    unsigned off = cp - f->start; /**< Distance to the first code point of the run. */
+    return (off < (unsigned) f->count * f->stride && off % f->stride == 0) ? cp + f->delta : cp;
+}
+
+/**
+ * @brief Checks if a code point has the Unicode property White_Space.
+ * @param cp Code point (or invalid byte).
+ * @return 1 if the code point is a whitespace, 0 otherwise.
+ */
+static int is_space(unsigned cp) {
+    if (cp < 0x80) return cp == ' ' || (cp >= '\t' && cp <= '\r');
+    switch (cp) {
+        case 0x85: case 0xA0: case 0x1680: case 0x2028: case 0x2029: case 0x202F: case 0x205F: case 0x3000:
+            return 1;
+        default:
+            return cp >= 0x2000 && cp <= 0x200A;
+    }
+}
+
+/**
+ * @brief Decodes the code point that starts at a position.
+ * @details A byte that does not start a valid sequence (overlong, surrogate, too large or cut off) is returned as
+ * INVALID_BASE plus its value.
+ * @param p Position of the code point.
+ * @param end End of the line.
+ * @param cp Pointer to the decoded code point, which is set.
+ * @return Length of the code point in bytes.
+ */
+static size_t decode(const unsigned char *p, const unsigned char *end, unsigned *cp) {
+    unsigned c = p[0]; /**< First byte. */
+    size_t n; /**< Length of the sequence. */
+    unsigned min; /**< Smallest code point that needs the length. */
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    } else if (c >= 0xC2 && c <= 0xDF) {
+        n = 2;
+        min = 0x80;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        n = 3;
+        min = 0x800;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        n = 4;
+        min = 0x10000;
+    } else {
+        *cp = INVALID_BASE + c;
+        return 1;
+    }
+    unsigned res = c & (0x7F >> n); /**< Decoded code point. */
+    for (size_t i = 1; i < n; i++) {
+        if (p + i >= end || (p[i] & 0xC0) != 0x80) {
+            *cp = INVALID_BASE + c;
+            return 1;
+        }
+        res = (res << 6) | (p[i] & 0x3F);
+    }
+    if (res < min || res > CODE_POINT_MAX || (res >= 0xD800 && res <= 0xDFFF)) {
+        *cp = INVALID_BASE + c;
+        return 1;
+    }
+    *cp = res;
+    return n;
+}
+
+/**
+ * @brief Decodes the code point that ends at a position.
+ * @details Splits the line the same way as decode() from the left, so both ends meet at the same code point.
+ * @param begin Start of the line.
+ * @param end Position after the code point.
+ * @param cp Pointer to the decoded code point, which is set.
+ * @return Length of the code point in bytes.
+ */
+static size_t decode_prev(const unsigned char *begin, const unsigned char *end, unsigned *cp) {
+    const unsigned char *p = end - 1; /**< Candidate for the first byte of the code point. */
+    while (p > begin && end - p < SEQUENCE_MAX && (*p & 0xC0) == 0x80) p--;
+    if (decode(p, end, cp) == (size_t) (end - p)) return end - p;
+    *cp = INVALID_BASE + end[-1];
+    return 1;
+}
+
+/**
+ * @brief Checks if bytes are ASCII characters without vector instructions.
+ * @param p First byte.
+ * @param len Count of bytes.
+ * @param ignore_whitespaces Whether control whitespaces (tab to carriage return) disqualify the bytes.
+ * @return 1 if all bytes qualify, 0 otherwise.
+ */
+static int is_ascii_scalar(const unsigned char *p, size_t len, int ignore_whitespaces) {
+    unsigned high = 0; /**< Bits of all bytes. */
+    unsigned space = 0; /**< Whether a control whitespace was found. */
+    for (size_t i = 0; i < len; i++) {
+        high |= p[i];
+        space |= (unsigned) (p[i] - '\t') <= '\r' - '\t';
+    }
+    return (high & 0x80) == 0 && !(ignore_whitespaces && space);
+}
+
+#ifdef UNICODE_SIMD
+
+/**
+ * @brief Checks if bytes are ASCII characters, 16 bytes at a time.
+ * @details Collects the high bits and the control whitespaces of all blocks without branches and tests them once.
+ * Control whitespaces are shifted to -128, so they are the only bytes below -123 (signed).
+ * @param p First byte.
+ * @param len Count of bytes.
+ * @param ignore_whitespaces Whether control whitespaces (tab to carriage return) disqualify the bytes.
+ * @return 1 if all bytes qualify, 0 otherwise.
+ */
+__attribute__((target("sse2")))
+static int is_ascii_sse(const unsigned char *p, size_t len, int ignore_whitespaces) {
+    __m128i high = _mm_setzero_si128(); /**< Bits of all blocks. */
+    __m128i space = _mm_setzero_si128(); /**< Control whitespaces of all blocks. */
+    size_t i = 0; /**< Offset of the next block. */
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (p + i));
+        high = _mm_or_si128(high, x);
+        space = _mm_or_si128(space, _mm_cmpgt_epi8(_mm_set1_epi8(-123), _mm_add_epi8(x, _mm_set1_epi8(0x80 - '\t'))));
+    }
+    int mask = _mm_movemask_epi8(high) | (ignore_whitespaces ? _mm_movemask_epi8(space) : 0);
+    return mask == 0 && is_ascii_scalar(p + i, len - i, ignore_whitespaces);
+}
+
+/**
+ * @brief Checks if bytes are ASCII characters, 32 bytes at a time (see is_ascii_sse()).
+ * @details The upper halves of the registers are cleared before the SSE code runs, which would be slowed down by them
+ * otherwise.
+ * @param p First byte.
+ * @param len Count of bytes.
+ * @param ignore_whitespaces Whether control whitespaces (tab to carriage return) disqualify the bytes.
+ * @return 1 if all bytes qualify, 0 otherwise.
+ */
+__attribute__((target("avx2")))
+static int is_ascii_avx2(const unsigned char *p, size_t len, int ignore_whitespaces) {
+    __m256i high = _mm256_setzero_si256(); /**< Bits of all blocks. */
+    __m256i space = _mm256_setzero_si256(); /**< Control whitespaces of all blocks. */
+    size_t i = 0; /**< Offset of the next block. */
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (p + i));
+        high = _mm256_or_si256(high, x);
+        space = _mm256_or_si256(space,
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(-123), _mm256_add_epi8(x, _mm256_set1_epi8(0x80 - '\t'))));
+    }
+    int mask = _mm256_movemask_epi8(high) | (ignore_whitespaces ? _mm256_movemask_epi8(space) : 0);
+    _mm256_zeroupper();
+    return mask == 0 && is_ascii_sse(p + i, len - i, ignore_whitespaces);
+}
+
+#endif
+
+/**
+ * @brief Checks if bytes are ASCII characters with the fastest check supported by the CPU.
+ * @param p First byte.
+ * @param len Count of bytes.
+ * @param ignore_whitespaces Whether control whitespaces (tab to carriage return) disqualify the bytes.
+ * @return 1 if all bytes qualify, 0 otherwise.
+ */
+static int is_ascii(const unsigned char *p, size_t len, int ignore_whitespaces) {
+#ifdef UNICODE_SIMD
+    if (len >= 32 && __builtin_cpu_supports("avx2")) return is_ascii_avx2(p, len, ignore_whitespaces);
+    if (len >= 16 && __builtin_cpu_supports("sse2")) return is_ascii_sse(p, len, ignore_whitespaces);
+#endif
+    return is_ascii_scalar(p, len, ignore_whitespaces);
+}
+
+int check_line_utf8(const char *line, size_t len, int ignore_whitespaces, int ignore_casing) {
+    const unsigned char *begin = (const unsigned char *) line; /**< Start of the line. */
+    const unsigned char *end = begin + len; /**< End of the line. */
+    if (is_ascii(begin, len, ignore_whitespaces)) return check_line(line, len, ignore_whitespaces, ignore_casing);
+    const unsigned char *left = begin; /**< Next code point from the left. */
+    const unsigned char *right = end; /**< Position after the next code point from the right. */
+    while (left < right) {
+        unsigned a; /**< Code point from the left. */
+        unsigned b; /**< Code point from the right. */
+        size_t a_len = decode(left, end, &a); /**< Length of the code point from the left. */
+        if (ignore_whitespaces && is_space(a)) {
+            left += a_len;
+            continue;
+        }
+        size_t b_len = decode_prev(begin, right, &b); /**< Length of the code point from the right. */
+        if (ignore_whitespaces && is_space(b)) {
+            right -= b_len;
+            continue;
+        }
+        if (right - b_len <= left) return 1;
+        if (ignore_casing) {
+            a = fold(a);
+            b = fold(b);
+        }
+        if (a != b) return 0;
+        left += a_len;
+        right -= b_len;
+    }
+    return 1;
+}
@@ -0,0 +1,26 @@
+/**
+ * Unicode module definitions.
+ * @brief Provides the palindrom check of single UTF-8 encoded lines.
+ * @details Lines are compared by code points instead of bytes. Based on the options, all Unicode whitespaces are
+ * skipped and code points are compared after their simple case folding. Bytes that are not part of a valid UTF-8
+ * sequence are compared as themselves.<br>
+ * Lines that consist of ASCII characters only (without tabs and other control whitespaces if whitespaces are ignored)
+ * are found with a vectorized check and passed to check_line(), so the common case keeps the fast byte check.
+ * @file unicode.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief Checks if a UTF-8 encoded line is a palindrom.
+ * @details Decodes code points from both ends and compares them, until they meet or unequal code points were found.
+ * A line without code points besides ignored whitespaces is a palindrom.
+ * @param line Line to be checked (without newline, does not need to be null terminated).
+ * @param len Length of the line in bytes.
+ * @param ignore_whitespaces Whether Unicode whitespaces are ignored.
+ * @param ignore_casing Whether letter casing is ignored (by simple case folding).
+ * @return 1 if the line is a palindrom, 0 otherwise.
+ */
+int check_line_utf8(const char *line, size_t len, int ignore_whitespaces, int ignore_casing);
@@ -0,0 +1,38 @@
+/**
+ * Arena module.
+ * @brief Implementation of the arena module definitions.
+ * @file arena.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "arena.h"
+#include "misc.h"
+#include <stdlib.h>
+#include <errno.h>
+
+int arena_init(t_arena *arena, size_t size) {
+    arena->buf = (char *) malloc(size);
+    if (arena->buf == NULL) return t_err("malloc");
+    arena->size = size;
+    arena->used = 0;
+    return 0;
+}
+
+void *arena_alloc(t_arena *arena, size_t size) {
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+    if (start > arena->size || size > arena->size - start) {
+        errno = ENOMEM;
+        t_err("arena_alloc");
+        return NULL;
+    }
+    arena->used = start + size;
+    return arena->buf + start;
+}
+
+void arena_free(t_arena *arena) {
+    if (arena->buf != NULL) free(arena->buf);
+    arena->buf = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * Arena module definitions.
+ * @brief Covers a bump allocator for temporary memory.
+ * @details An arena reserves one block of memory up front and hands out parts of it by advancing an offset, so
+ * allocations cost no allocator call and all of them are released in one step.
+ * @file arena.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 16 /**< Alignment of every allocation of an arena. */
+
+/**
+ * @brief Bump allocator.
+ */
+typedef struct Arena {
+    char *buf; /**< Reserved memory. */
+    size_t size; /**< Size of the reserved memory. */
+    size_t used; /**< Size of the memory that is handed out. */
+} t_arena;
+
+/**
+ * @brief Reserves the memory of an arena.
+ * @details The size must cover all later allocations incl. their alignment padding (ARENA_ALIGN - 1 bytes each).<br>
+ * Must be released with arena_free().
+ * @param arena Arena to be initialized.
+ * @param size Size of the memory to be reserved.
+ * @return 0 on success, -1 on error.
+ */
+int arena_init(t_arena *arena, size_t size);
+
+/**
+ * @brief Allocates memory from an arena.
+ * @details The memory is aligned to ARENA_ALIGN bytes and stays valid until the arena is released.
+ * @param arena Arena.
+ * @param size Size of the memory.
+ * @return Pointer to the memory, NULL if the arena is exhausted.
+ */
+void *arena_alloc(t_arena *arena, size_t size);
+
+/**
+ * @brief Releases the memory of an arena and all its allocations.
+ * @param arena Arena to be released.
+ */
+void arena_free(t_arena *arena);
@@ -0,0 +1,442 @@
+/**
+ * Big number module.
+ * @brief Implementation of the big number module definitions.
+ * @file big.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "big.h"
+#include "hex.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define KARATSUBA_MIN 32 /**< Minimal count of limbs for which Karatsuba multiplication is used. */
+#define F_PARTS 4 /**< Number of sub-multiplications of the threaded engine. */
+
+/**
+ * @brief Removes leading zero limbs of a big number.
+ * @param x Big number to be updated.
+ */
+static void normalize(t_big *x) {
+    while (x->n > 0 && x->d[x->n - 1] == 0) x->n--;
+}
+
+bool big_equal(const t_big *a, const t_big *b) {
+    return a == b || (a->n == b->n && memcmp(a->d, b->d, sizeof(uint32_t) * a->n) == 0);
+}
+
+int big_reserve(t_big *x, size_t n) {
+    if (n <= x->cap) return 0;
+    uint32_t *d = (uint32_t *) realloc(x->d, sizeof(uint32_t) * n);
+    if (d == NULL) return t_err("realloc");
+    x->d = d;
+    x->cap = n;
+    return 0;
+}
+
+void big_free(t_big *x) {
+    if (x->d != NULL) free(x->d);
+    x->d = NULL;
+    x->n = 0;
+    x->cap = 0;
+}
+
+int big_from_hex(t_big *x, const char *hex, size_t len) {
+    size_t n = (len + LIMB_DIGITS - 1) / LIMB_DIGITS;
+    if (big_reserve(x, n) == -1) return t_err("big_reserve");
+    for (size_t i = 0; i < n; i++) {
+        size_t end = len - i * LIMB_DIGITS; /**< Exclusive end of the limb's digits. */
+        size_t start = (end > LIMB_DIGITS) ? end - LIMB_DIGITS : 0;
+        uint32_t limb = 0;
+        for (size_t j = start; j < end; j++) limb = (limb << 4) | hex_val(hex[j]);
+        x->d[i] = limb;
+    }
+    x->n = n;
+    normalize(x);
+    return 0;
+}
+
+long big_to_hex(char **dst, size_t *cap, const t_big *x) {
+    static const char digits[] = "0123456789abcdef";
+    size_t len = 0;
+    if (x->n > 0) {
+        uint32_t top = x->d[x->n - 1];
+        len = (x->n - 1) * LIMB_DIGITS;
+        while (top != 0) {
+            len++;
+            top >>= 4;
+        }
+    }
+    if (len == 0) len = 1;
+    if (*dst == NULL || *cap < len + 1) {
+        char *temp = (char *) realloc(*dst, sizeof(char) * (len + 1));
+        if (temp == NULL) return t_err("realloc");
+        *dst = temp;
+        *cap = len + 1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        size_t limb = i / LIMB_DIGITS;
+        uint32_t val = (limb < x->n) ? (x->d[limb] >> (4 * (i % LIMB_DIGITS))) & 0xf : 0;
+        (*dst)[len - 1 - i] = digits[val];
+    }
+    (*dst)[len] = '\0';
+    return (long) len;
+}
+
+/**
+ * @brief Adds a number to another one in place.
+ * @details The carry is propagated through all limbs of <strong>r</strong>.
+ * @param r Limbs to be updated.
+ * @param rn Count of limbs of r.
+ * @param a Limbs to be added.
+ * @param an Count of limbs of a, must not exceed rn.
+ * @return Carry out of the most significant limb of r.
+ */
+static uint32_t add_limbs(uint32_t *r, size_t rn, const uint32_t *a, size_t an) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < an; i++) {
+        uint64_t t = (uint64_t) r[i] + a[i] + carry;
+        r[i] = (uint32_t) t;
+        carry = t >> 32;
+    }
+    for (; carry != 0 && i < rn; i++) {
+        uint64_t t = (uint64_t) r[i] + carry;
+        r[i] = (uint32_t) t;
+        carry = t >> 32;
+    }
+    return (uint32_t) carry;
+}
+
+/**
+ * @brief Subtracts a number from another one in place.
+ * @details The borrow is propagated through all limbs of <strong>r</strong>.
+ * @param r Limbs to be updated.
+ * @param rn Count of limbs of r.
+ * @param a Limbs to be subtracted.
+ * @param an Count of limbs of a, must not exceed rn.
+ * @return Borrow out of the most significant limb of r.
+ */
+static uint32_t sub_limbs(uint32_t *r, size_t rn, const uint32_t *a, size_t an) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < an; i++) {
+        uint64_t t = (uint64_t) r[i] - a[i] - borrow;
+        r[i] = (uint32_t) t;
+        borrow = (t >> 32) & 1;
+    }
+    for (; borrow != 0 && i < rn; i++) {
+        uint64_t t = (uint64_t) r[i] - borrow;
+        r[i] = (uint32_t) t;
+        borrow = (t >> 32) & 1;
+    }
+    return (uint32_t) borrow;
+}
+
+/**
+ * @brief Multiplies two limb arrays with schoolbook multiplication.
+ * @param r Limbs to be updated with the product, must have an + bn limbs.
+ * @param a Limbs of the first operand.
+ * @param an Count of limbs of a.
+ * @param b Limbs of the second operand.
+ * @param bn Count of limbs of b.
+ */
+static void mul_school(uint32_t *r, const uint32_t *a, size_t an, const uint32_t *b, size_t bn) {
+    memset(r, 0, sizeof(uint32_t) * (an + bn));
+    for (size_t i = 0; i < an; i++) {
+        uint64_t carry = 0;
+        uint64_t a_i = a[i];
+        for (size_t j = 0; j < bn; j++) {
+            uint64_t t = a_i * b[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t) t;
+            carry = t >> 32;
+        }
+        r[i + bn] = (uint32_t) carry;
+    }
+}
+
+/**
+ * @brief Squares a limb array with schoolbook multiplication.
+ * @details Every cross product a_i·a_j (i < j) is computed once and doubled, so only about half of the limb
+ * multiplications of mul_school() are needed.
+ * @param r Limbs to be updated with the square, must have 2 * n limbs.
+ * @param a Limbs of the operand.
+ * @param n Count of limbs of a.
+ */
+static void sqr_school(uint32_t *r, const uint32_t *a, size_t n) {
+    memset(r, 0, sizeof(uint32_t) * 2 * n);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t carry = 0;
+        uint64_t a_i = a[i];
+        for (size_t j = i + 1; j < n; j++) {
+            uint64_t t = a_i * a[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t) t;
+            carry = t >> 32;
+        }
+        r[i + n] = (uint32_t) carry;
+    }
+    uint32_t top = 0; /**< Bit shifted out of the previous limb. */
+    for (size_t i = 0; i < 2 * n; i++) {
+        uint32_t next = r[i] >> 31;
+        r[i] = (r[i] << 1) | top;
+        top = next;
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t t = (uint64_t) a[i] * a[i] + r[2 * i] + carry;
+        r[2 * i] = (uint32_t) t;
+        t = (uint64_t) r[2 * i + 1] + (t >> 32);
+        r[2 * i + 1] = (uint32_t) t;
+        carry = t >> 32;
+    }
+}
+
+/**
+ * @brief Calculates the scratch space that a Karatsuba multiplication needs.
+ * @param n Count of limbs of both operands.
+ * @return Count of scratch limbs.
+ */
+static size_t karatsuba_scratch(size_t n) {
+    size_t size = 0;
+    while (n >= KARATSUBA_MIN) {
+        size_t h = n - n / 2 + 1; /**< Length of the sums of both halves. */
+        size += 4 * h;
+        n = h;
+    }
+    return size;
+}
+
+/**
+ * @brief Multiplies two limb arrays of equal length with the Karatsuba algorithm.
+ * @details Splits both operands into a high and low half and needs three instead of four sub-multiplications:
+ * a_h·b_h, a_l·b_l and (a_h + a_l)·(b_h + b_l), from which the cross terms are derived.<br>
+ * Falls back to schoolbook multiplication for short operands.
+ * @param r Limbs to be updated with the product, must have 2 * n limbs.
+ * @param a Limbs of the first operand.
+ * @param b Limbs of the second operand.
+ * @param n Count of limbs of both operands.
+ * @param scratch Scratch space of at least karatsuba_scratch(n) limbs.
+ */
+static void mul_karatsuba(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n, uint32_t *scratch) {
+    if (n < KARATSUBA_MIN) {
+        mul_school(r, a, n, b, n);
+        return;
+    }
+    size_t m = n / 2; /**< Length of the low halves. */
+    size_t h = n - m; /**< Length of the high halves. */
+    uint32_t *sa = scratch; /**< Sum of both halves of a. */
+    uint32_t *sb = sa + h + 1; /**< Sum of both halves of b. */
+    uint32_t *z1 = sb + h + 1; /**< Product of both sums. */
+    uint32_t *next = z1 + 2 * (h + 1); /**< Scratch space of the sub-multiplications. */
+    memcpy(sa, a + m, sizeof(uint32_t) * h);
+    memcpy(sb, b + m, sizeof(uint32_t) * h);
+    sa[h] = add_limbs(sa, h, a, m);
+    sb[h] = add_limbs(sb, h, b, m);
+    mul_karatsuba(r, a, b, m, next);
+    mul_karatsuba(r + 2 * m, a + m, b + m, h, next);
+    mul_karatsuba(z1, sa, sb, h + 1, next);
+    sub_limbs(z1, 2 * (h + 1), r, 2 * m);
+    sub_limbs(z1, 2 * (h + 1), r + 2 * m, 2 * h);
+    size_t z1_n = 2 * (h + 1);
+    if (z1_n > 2 * n - m) z1_n = 2 * n - m;
+    add_limbs(r + m, 2 * n - m, z1, z1_n);
+}
+
+/**
+ * @brief Squares a limb array with the Karatsuba algorithm.
+ * @details Needs the three squarings a_h², a_l² and (a_h + a_l)², from which the cross term is derived.<br>
+ * Falls back to schoolbook squaring for short operands.
+ * @param r Limbs to be updated with the square, must have 2 * n limbs.
+ * @param a Limbs of the operand.
+ * @param n Count of limbs of a.
+ * @param scratch Scratch space of at least karatsuba_scratch(n) limbs.
+ */
+static void sqr_karatsuba(uint32_t *r, const uint32_t *a, size_t n, uint32_t *scratch) {
+    if (n < KARATSUBA_MIN) {
+        sqr_school(r, a, n);
+        return;
+    }
+    size_t m = n / 2; /**< Length of the low half. */
+    size_t h = n - m; /**< Length of the high half. */
+    uint32_t *sa = scratch; /**< Sum of both halves. */
+    uint32_t *z1 = sa + h + 1; /**< Square of the sum. */
+    uint32_t *next = z1 + 2 * (h + 1); /**< Scratch space of the sub-squarings. */
+    memcpy(sa, a + m, sizeof(uint32_t) * h);
+    sa[h] = add_limbs(sa, h, a, m);
+    sqr_karatsuba(r, a, m, next);
+    sqr_karatsuba(r + 2 * m, a + m, h, next);
+    sqr_karatsuba(z1, sa, h + 1, next);
+    sub_limbs(z1, 2 * (h + 1), r, 2 * m);
+    sub_limbs(z1, 2 * (h + 1), r + 2 * m, 2 * h);
+    size_t z1_n = 2 * (h + 1);
+    if (z1_n > 2 * n - m) z1_n = 2 * n - m;
+    add_limbs(r + m, 2 * n - m, z1, z1_n);
+}
+
+/**
+ * @brief Squares a big number with the Karatsuba algorithm.
+ * @param dst Big number to be updated with the square.
+ * @param a Operand.
+ * @return 0 on success, -1 on error.
+ */
+static int sqr_big_karatsuba(t_big *dst, const t_big *a) {
+    if (a->n == 0) {
+        dst->n = 0;
+        return 0;
+    }
+    uint32_t *scratch = (uint32_t *) malloc(sizeof(uint32_t) * (karatsuba_scratch(a->n) + 1));
+    if (scratch == NULL) return t_err("malloc");
+    if (big_reserve(dst, 2 * a->n) == -1) {
+        free(scratch);
+        return t_err("big_reserve");
+    }
+    sqr_karatsuba(dst->d, a->d, a->n, scratch);
+    free(scratch);
+    dst->n = 2 * a->n;
+    normalize(dst);
+    return 0;
+}
+
+int big_mul_karatsuba(t_big *dst, const t_big *a, const t_big *b) {
+    if (big_equal(a, b)) return sqr_big_karatsuba(dst, a);
+    if (a->n < b->n) {
+        const t_big *temp = a;
+        a = b;
+        b = temp;
+    }
+    if (b->n == 0) {
+        dst->n = 0;
+        return 0;
+    }
+    size_t n = a->n + b->n;
+    size_t bn = b->n;
+    uint32_t *scratch = (uint32_t *) malloc(sizeof(uint32_t) * (karatsuba_scratch(bn) + 3 * bn));
+    if (scratch == NULL) return t_err("malloc");
+    if (big_reserve(dst, n) == -1) {
+        free(scratch);
+        return t_err("big_reserve");
+    }
+    memset(dst->d, 0, sizeof(uint32_t) * n);
+    uint32_t *block = scratch; /**< Block of a, filled up with zeroes if necessary. */
+    uint32_t *prod = block + bn; /**< Product of the block and b. */
+    uint32_t *next = prod + 2 * bn; /**< Scratch space of the block multiplications. */
+    for (size_t i = 0; i < a->n; i += bn) {
+        size_t len = (a->n - i < bn) ? a->n - i : bn;
+        memcpy(block, a->d + i, sizeof(uint32_t) * len);
+        memset(block + len, 0, sizeof(uint32_t) * (bn - len));
+        mul_karatsuba(prod, block, b->d, bn, next);
+        size_t prod_n = (2 * bn < n - i) ? 2 * bn : n - i;
+        add_limbs(dst->d + i, n - i, prod, prod_n);
+    }
+    free(scratch);
+    dst->n = n;
+    normalize(dst);
+    return 0;
+}
+
+/**
+ * @brief Arguments of a sub-multiplication of the threaded engine.
+ */
+typedef struct Part {
+    t_big a; /**< First operand, borrows the limbs of the original operand. */
+    t_big b; /**< Second operand, borrows the limbs of the original operand. */
+    t_big prod; /**< Product. */
+    int thread_c; /**< Count of threads the sub-multiplication may use. */
+    int err; /**< Whether the sub-multiplication failed. */
+} t_part;
+
+/**
+ * @brief Computes a sub-multiplication of the threaded engine.
+ * @param arg Pointer to the part.
+ * @return NULL.
+ */
+static void *mul_part(void *arg) {
+    t_part *part = (t_part *) arg;
+    if (big_mul_threaded(&(part->prod), &(part->a), &(part->b), part->thread_c) == -1) part->err = 1;
+    return NULL;
+}
+
+/**
+ * @brief Borrows the limbs of a part of a big number.
+ * @param dst Big number to be updated, must not be freed.
+ * @param x Big number to be split.
+ * @param start Index of the first limb.
+ * @param end Exclusive index of the last limb.
+ */
+static void slice(t_big *dst, const t_big *x, size_t start, size_t end) {
+    if (end > x->n) end = x->n;
+    dst->d = x->d + start;
+    dst->n = (start < end) ? end - start : 0;
+    dst->cap = 0;
+    normalize(dst);
+}
+
+int big_mul_threaded(t_big *dst, const t_big *a, const t_big *b, int thread_c) {
+    size_t len = (a->n > b->n) ? a->n : b->n;
+    if (thread_c <= 1 || len < 2) return big_mul(dst, a, b);
+    size_t m = len / 2; /**< Length of the low halves. */
+    bool square = big_equal(a, b); /**< Whether the cross terms are equal and only computed once. */
+    int part_c = square ? F_PARTS - 1 : F_PARTS; /**< Count of sub-multiplications. */
+    t_part parts[F_PARTS];
+    memset(parts, 0, sizeof(parts));
+    slice(&(parts[0].a), a, m, len);
+    slice(&(parts[0].b), b, m, len);
+    slice(&(parts[1].a), a, m, len);
+    slice(&(parts[1].b), b, 0, m);
+    if (square) {
+        slice(&(parts[2].a), a, 0, m);
+        slice(&(parts[2].b), b, 0, m);
+    } else {
+        slice(&(parts[2].a), a, 0, m);
+        slice(&(parts[2].b), b, m, len);
+        slice(&(parts[3].a), a, 0, m);
+        slice(&(parts[3].b), b, 0, m);
+    }
+    pthread_t tids[F_PARTS];
+    bool started[F_PARTS] = { false };
+    for (int i = 0; i < part_c; i++) {
+        parts[i].thread_c = (thread_c + part_c - 1 - i) / part_c;
+        if (i < thread_c - 1 && i < part_c - 1 && pthread_create(&(tids[i]), NULL, mul_part, &(parts[i])) == 0) {
+            started[i] = true;
+        } else {
+            mul_part(&(parts[i]));
+        }
+    }
+    int err = 0;
+    for (int i = 0; i < part_c; i++) {
+        if (started[i]) pthread_join(tids[i], NULL);
+        if (parts[i].err) err = 1;
+    }
+    size_t n = a->n + b->n;
+    if (err == 0 && big_reserve(dst, n) == -1) err = t_err("big_reserve");
+    if (err == 0) {
+        size_t shift[F_PARTS] = { 2 * m, m, m, 0 }; /**< Limb offsets of the parts in the product. */
+        if (square) shift[2] = 0;
+        memset(dst->d, 0, sizeof(uint32_t) * n);
+        for (int i = 0; i < part_c; i++) {
+            add_limbs(dst->d + shift[i], n - shift[i], parts[i].prod.d, parts[i].prod.n);
+        }
+        if (square) add_limbs(dst->d + m, n - m, parts[1].prod.d, parts[1].prod.n);
+        dst->n = n;
+        normalize(dst);
+    }
+    for (int i = 0; i < F_PARTS; i++) big_free(&(parts[i].prod));
+    return err ? t_err("mul_part") : 0;
+}
+
+int big_mul(t_big *dst, const t_big *a, const t_big *b) {
+    if (a->n == 0 || b->n == 0) {
+        dst->n = 0;
+        return 0;
+    }
+    size_t n = a->n + b->n;
+    if (big_reserve(dst, n) == -1) return t_err("big_reserve");
+    if (big_equal(a, b)) sqr_school(dst->d, a->d, a->n);
+    else mul_school(dst->d, a->d, a->n, b->d, b->n);
+    dst->n = n;
+    normalize(dst);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * Big number module definitions.
+ * @brief Covers in-process arithmetic on hexadecimal numbers of any length.
+ * @details Numbers are stored as arrays of 32 bit limbs (8 hex digits each, least significant limb first), which
+ * allows multiplying them without forking child processes or parsing single digits.<br>
+ * The buffers of a number are reused across calls, so repeated operations do not allocate once they are big enough.
+ * @file big.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LIMB_DIGITS 8 /**< Hex digits per limb. */
+
+/**
+ * @brief Big number.
+ * @details Limbs are stored least significant first. Zero is represented by n = 0.
+ */
+typedef struct Big {
+    uint32_t *d; /**< Limbs of the number. */
+    size_t n; /**< Count of used limbs (without leading zero limbs). */
+    size_t cap; /**< Count of allocated limbs. */
+} t_big;
+
+/**
+ * @brief Checks whether two big numbers are equal.
+ * @details Used by all multiplications to detect squaring.
+ * @param a First big number.
+ * @param b Second big number.
+ * @return true if both are equal, false otherwise.
+ */
+bool big_equal(const t_big *a, const t_big *b);
+
+/**
+ * @brief Ensures that a big number can hold a given count of limbs.
+ * @details Reallocates the limbs of <strong>x</strong> if necessary, existing limbs are kept.
+ * @param x Big number to be updated.
+ * @param n Required count of limbs.
+ * @return 0 on success, -1 on error.
+ */
+int big_reserve(t_big *x, size_t n);
+
+/**
+ * @brief Frees the memory of a big number.
+ * @param x Big number to be freed.
+ */
+void big_free(t_big *x);
+
+/**
+ * @brief Parses a big number from a hexadecimal string.
+ * @details The string must only consist of hexadecimal characters (see is_hex()).<br>
+ * Allocates necessary memory for <strong>x</strong>.
+ * @param x Big number to be updated.
+ * @param hex Hexadecimal string.
+ * @param len Length of the string.
+ * @return 0 on success, -1 on error.
+ */
+int big_from_hex(t_big *x, const char *hex, size_t len);
+
+/**
+ * @brief Writes a big number as hexadecimal string.
+ * @details The string has no leading zeroes.<br>
+ * Reallocates <strong>dst</strong> if its capacity is not sufficient.
+ * @param dst Pointer to the string to be updated.
+ * @param cap Pointer to the capacity of the string, updated on reallocation.
+ * @param x Big number to be written.
+ * @return Length of the string on success, -1 on error.
+ */
+long big_to_hex(char **dst, size_t *cap, const t_big *x);
+
+/**
+ * @brief Multiplies two big numbers.
+ * @details Uses schoolbook multiplication on limbs, which is the fastest for short operands.<br>
+ * If both operands are equal, every cross product is only computed once.<br>
+ * <strong>dst</strong> must not be the same number as <strong>a</strong> or <strong>b</strong>.
+ * @param dst Big number to be updated with the product.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return 0 on success, -1 on error.
+ */
+int big_mul(t_big *dst, const t_big *a, const t_big *b);
+
+/**
+ * @brief Multiplies two big numbers with the Karatsuba algorithm.
+ * @details Needs three instead of four sub-multiplications per recursion level and falls back to schoolbook
+ * multiplication for short operands. If the lengths of the operands differ, the longer one is split into blocks of
+ * the length of the shorter one.<br>
+ * If both operands are equal, three squarings are computed instead.<br>
+ * <strong>dst</strong> must not be the same number as <strong>a</strong> or <strong>b</strong>.
+ * @param dst Big number to be updated with the product.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return 0 on success, -1 on error.
+ */
+int big_mul_karatsuba(t_big *dst, const t_big *a, const t_big *b);
+
+/**
+ * @brief Multiplies two big numbers with a tree of threads.
+ * @details Works like the process tree: splits both operands in half and computes the four sub-multiplications in
+ * separate threads, until the threads are used up. Remaining sub-multiplications use schoolbook multiplication.<br>
+ * If both operands are equal, the equal cross terms are only computed once (three sub-multiplications).<br>
+ * <strong>dst</strong> must not be the same number as <strong>a</strong> or <strong>b</strong>.
+ * @param dst Big number to be updated with the product.
+ * @param a First operand.
+ * @param b Second operand.
+ * @param thread_c Count of threads that may be used (incl. the calling one).
+ * @return 0 on success, -1 on error.
+ */
+int big_mul_threaded(t_big *dst, const t_big *a, const t_big *b, int thread_c);
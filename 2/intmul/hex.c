@@ -11,18 +11,20 @@
 #include <stdlib.h>
 #include <stdio.h>
 
-int multiply(char **dst, char *x, char *y) {
+int hex_val(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+int multiply(char *dst, char *x, char *y) {
     int x_int, y_int;
     if (
         parse_int(&x_int, x) == -1 ||
         parse_int(&y_int, y) == -1
     ) return t_err("parse_int");
     int prod_dec = x_int * y_int;
-    int len = strlen(x) * 2;
-    *dst = (char *) malloc(sizeof(char) * (len + 1));
-    if (*dst == NULL) return t_err("malloc");
-    sprintf(*dst, "%x", prod_dec);
-    fill_zeroes(dst, len, false);
+    sprintf(dst, "%x", prod_dec);
     return 0;
 }
 
@@ -31,68 +33,42 @@ int is_hex(char *str) {
     return (strlen(str) != 0 && valid_symbols == 0) ? 0 : -1;
 }
 
-void half_str(char *dst, char *src, int half, int half_length) {
-    char *start = src;
-    if (half == 1) start += half_length;
-    strncpy(dst, start, half_length);
-    dst[half_length] = '\0';
-}
-
-int fill_zeroes(char **str, int min_len, bool pow_of_two) {
-    char old_str[strlen(*str) + 1];
-    strcpy(old_str, *str);
-    int new_len = 1;
-    if (pow_of_two == true) {
-        while (new_len < min_len) new_len *= 2;
+void split_str(char *dst, char *src, int half, int low_length) {
+    int len = strlen(src);
+    int high_length = (len > low_length) ? len - low_length : 0;
+    if (half == 0) {
+        strncpy(dst, src, high_length);
+        dst[high_length] = '\0';
     } else {
-        new_len = min_len;
+        strcpy(dst, src + high_length);
     }
-    int diff = new_len - strlen(old_str);
-    if (diff <= 0) return 0;
-    free(*str);
-    *str = (char *) calloc(new_len + 1, sizeof(char));
-    if (str == NULL) return t_err("calloc");
-    memset(*str, '0', diff);
-    strcat(*str, old_str);
-    return 0;
 }
 
-int shift_left(char **str, int n) {
-    int len = strlen(*str);
-    *str = (char *) realloc(*str, sizeof(char) * (len + n + 1));
-    if (str == NULL) return t_err("realloc");
-    for (int i = 0; i < n; i++) {
-        (*str)[len + i] = '0';
-    }
-    (*str)[len + n] = '\0';
-    return 0;
+void strip_zeroes(char *str) {
+    size_t zeroes = strspn(str, "0");
+    if (zeroes > 0 && str[zeroes] == '\0') zeroes--;
+    if (zeroes > 0) memmove(str, str + zeroes, strlen(str + zeroes) + 1);
 }
 
-int add(char **res, char **x, char **y) {
-    int len = max(strlen(*x), strlen(*y));
-    if (fill_zeroes(x, len, false) == -1) return t_err("fill_zeroes");
-    if (fill_zeroes(y, len, false) == -1) return t_err("fill_zeroes");
-    char sum[len + 1];
-    memset(sum, '0', len);
-    int overflow = 0;
-    for (int i = len - 1; i >= 0; i--) {
-        int x_dec, y_dec;
-        if (parse_c_int(&x_dec, (*x)[i]) == -1) return t_err("parse_c_int");
-        if (parse_c_int(&y_dec, (*y)[i]) == -1) return t_err("parse_c_int");
-        int sum_dec = x_dec + y_dec + overflow;
-        overflow = 0;
-        if (sum_dec > HEX_B - 1) {
-            sum_dec -= HEX_B;
-            overflow = 1;
+int add_shifted(char *acc, int acc_len, char *x, int shift) {
+    static const char digits[] = "0123456789abcdef";
+    int carry = 0;
+    int i = acc_len - 1 - shift; /**< Index of the current digit of acc. */
+    for (int j = strlen(x) - 1; j >= 0; j--, i--) {
+        int x_dec = hex_val(x[j]);
+        if (i < 0) {
+            if (x_dec != 0) return m_err("Sum exceeds the accumulator");
+            continue;
         }
-        char sum_hex[2];
-        sprintf(sum_hex, "%x", sum_dec);
-        sum[i] = sum_hex[0];
+        int sum_dec = hex_val(acc[i]) + x_dec + carry;
+        carry = sum_dec >= HEX_B;
+        acc[i] = digits[sum_dec - carry * HEX_B];
     }
-    *res = (char *) realloc(*res, sizeof(char) * (len + 1 + overflow));
-    if (*res == NULL) return t_err("realloc");
-    (*res)[0] = '1';
-    strncpy((*res) + overflow, sum, len + overflow);
-    (*res)[len + overflow] = '\0';
+    for (; carry != 0 && i >= 0; i--) {
+        int sum_dec = hex_val(acc[i]) + carry;
+        carry = sum_dec >= HEX_B;
+        acc[i] = digits[sum_dec - carry * HEX_B];
+    }
+    if (carry != 0) return m_err("Sum exceeds the accumulator");
     return 0;
-}
\ No newline at end of file
+}
@@ -14,14 +14,13 @@
  * @brief Multiplies two hex numbers of restricted length.
  * @details Parses the input as decimal numbers, multiplies them and transforms them to hexadecimal numbers.<br>
  * x and y must not exceed a size of 8 bytes (size of an integer).<br>
- * Transforms res to have a length that is a power of two.<br>
- * Allocates necessary memory for <strong>res</strong>.
- * @param dst Pointer to be updated with the product as a string.
+ * <strong>dst</strong> must have enough allocated memory for the product (strlen(x) + strlen(y) + 1).
+ * @param dst String to be updated with the product.
  * @param x First hex number string.
  * @param y Second hex number string.
  * @return 0 on success, -1 on error.
  */
-int multiply(char **dst, char *x, char *y);
+int multiply(char *dst, char *x, char *y);
 
 /**
  * @brief Checks if a string is a valid hexadecimal number.
@@ -32,43 +31,40 @@ int multiply(char **dst, char *x, char *y);
 int is_hex(char *str);
 
 /**
- * @brief Copies half of a string to another string.<br>
- * @details <strong>dst</strong> must have enough allocated memory.
- * @param dst String to be updated.
- * @param src String to be copied.
- * @param half 0 if the first half should be copied, 1 for the second half.
- * @param half_length Half length of the source string.
+ * @brief Parses the value of a hexadecimal character.
+ * @details The character must be hexadecimal (see is_hex()).
+ * @param c Hexadecimal character.
+ * @return Value of the character.
  */
-void half_str(char *dst, char *src, int half, int half_length);
+int hex_val(char c);
 
 /**
- * @brief Fills up a hexadecimal number with leading zeroes.
- * @details Allocates necessary memory for <strong>str</strong>.
- * @param str Pointer to be updated with the resulting string.
- * @param min_len Length of the new string. It might become even longer if pow_of_two is true.
- * @param pow_of_two Whether the new string should have a length that is a power of two.
- * @return 0 on success, -1 on error.
+ * @brief Copies the high or low part of a hex number to another string.
+ * @details The low part consists of the last <strong>low_length</strong> digits, the high part of all digits
+ * before. If the number is not longer than low_length, the high part is empty and the low part is the whole number.<br>
+ * <strong>dst</strong> must have enough allocated memory.
+ * @param dst String to be updated.
+ * @param src String to be copied.
+ * @param half 0 if the high part should be copied, 1 for the low part.
+ * @param low_length Length of the low part.
  */
-int fill_zeroes(char **str, int min_len, bool pow_of_two);
+void split_str(char *dst, char *src, int half, int low_length);
 
 /**
- * @brief Shifts a hex number n digits to the left.
- * @details New digits are filled with zeroes.<br>
- * Frees existing and allocates new memory for <strong>str</strong>.
- * @param str Pointer to be updated with the resulting string.
- * @param n Digits to be shifted.
- * @return 0 on success, -1 on error.
+ * @brief Removes the leading zeroes of a hexadecimal number.
+ * @details Keeps a single zero if the number is zero.
+ * @param str String to be updated.
  */
-int shift_left(char **str, int n);
+void strip_zeroes(char *str);
 
 /**
- * @brief Calculates the sum of two hex numbers of any length.
- * @details Transforms both numbers to have the same length and iteratively sums up every digit
- * of both from right to left.<br>
- * Allocates necessary memory for <strong>res</strong>.
- * @param res Pointer to be updated with the resulting string.
- * @param x Pointer to the first hexadecimal string.
- * @param y Pointer to the second hexadecimal string.
- * @return 0 on success, -1 on error.
+ * @brief Adds a shifted hex number to an accumulator in place.
+ * @details Adds x·16^shift to the number in <strong>acc</strong>, which has a fixed count of digits (incl. leading
+ * zeroes), so no memory is allocated.
+ * @param acc Digits of the accumulator, to be updated with the sum.
+ * @param acc_len Count of digits of the accumulator.
+ * @param x Hex number to be added.
+ * @param shift Digits that x is shifted to the left.
+ * @return 0 on success, -1 if the sum exceeds the accumulator.
  */
-int add(char **res, char **x, char **y);
\ No newline at end of file
+int add_shifted(char *acc, int acc_len, char *x, int shift);
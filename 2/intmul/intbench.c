@@ -0,0 +1,426 @@
+/**
+ * Intbench module.
+ * @brief Main entry point for the intmul benchmark.
+ * @details Generates random hexadecimal operands with sizes from 2^4 to 2^22 digits and multiplies them with every
+ * engine of intmul.<br>
+ * For each run, the wall time, CPU time and peak memory of the whole process tree as well as the count of processes
+ * are reported. Every product is checked for correctness against a reference.<br>
+ * With -q, squarings (both operands equal) are benchmarked instead.<br>
+ * Results are printed as CSV to <strong>stdout</strong>, so they can be compared across builds.
+ * @file intbench.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "hex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#define DEFAULT_PROG "./intmul" /**< Default path to the intmul program. */
+#define DEFAULT_MIN_EXP 4 /**< Default exponent of the smallest operand size. */
+#define DEFAULT_MAX_EXP 22 /**< Default exponent of the largest operand size. */
+#define MAX_EXP 26 /**< Maximal exponent of the operand size. */
+#define REF_MAX_EXP 12 /**< Maximal exponent of the operand size for which the exact reference is computed. */
+#define E_N 5 /**< Number of engines. */
+#define P_N 2 /**< Number of pipe ends. */
+#define CHECK_N 3 /**< Number of primes of the residue check. */
+
+/**
+ * @brief Engine of intmul.
+ */
+typedef struct Engine {
+    char *name; /**< Name of the engine, as passed to intmul -e. */
+    int max_exp; /**< Exponent of the largest operand size to be benchmarked, as larger runs take too long. */
+} t_engine;
+
+/**
+ * @brief Program options.
+ * @details The program configurations that are specified by the arguments.
+ */
+typedef struct Options {
+    char *prog; /**< Path to the intmul program. */
+    int min_exp; /**< Exponent of the smallest operand size. */
+    int max_exp; /**< Exponent of the largest operand size. */
+    unsigned long seed; /**< Seed of the operand generator. */
+    char *engine; /**< Name of the only engine to be benchmarked, NULL for all. */
+    bool no_limit; /**< Whether the size limits of the engines are ignored. */
+    bool square; /**< Whether both operands are equal. */
+} t_opt;
+
+/**
+ * @brief Measurements of a single run.
+ */
+typedef struct Result {
+    double wall_ms; /**< Elapsed wall clock time. */
+    double cpu_ms; /**< User and system CPU time of all processes. */
+    long maxrss_kb; /**< Peak resident set size of the largest process. */
+    char *out; /**< Output of intmul. */
+} t_result;
+
+static const t_engine engines[E_N] = {
+    { "tree", 6 },
+    { "school", 18 },
+    { "thread", 18 },
+    { "karatsuba", 20 },
+    { "ntt", 22 }
+}; /**< All engines with their size limits. */
+
+static const uint64_t primes[CHECK_N] = { 2147483647ULL, 2147483629ULL, 2147483587ULL }; /**< Primes of checks. */
+
+char *prog_name; /**< The program's name. */
+
+/**
+ * @brief Prints the usage of the program and exits.
+ * @details Prints to <strong>stderr</strong> and exits with <strong>EXIT_FAILURE</strong>.<br>
+ * Used global variables: prog_name
+ */
+static void usage(void) {
+    fprintf(stderr, "Usage: %s [-p INTMUL] [-n MIN_EXP] [-x MAX_EXP] [-s SEED] [-e ENGINE] [-a] [-q]\n", prog_name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses an exponent argument.
+ * @details Might exit the program with <strong>EXIT_FAILURE</strong> if the argument is invalid.
+ * @param src Argument string.
+ * @return Parsed exponent.
+ */
+static int parse_exp(char *src) {
+    char *end = NULL;
+    long exp = strtol(src, &end, 10);
+    if (*end != '\0' || exp < 0 || exp > MAX_EXP) usage();
+    return (int) exp;
+}
+
+/**
+ * @brief Parses the program arguments.
+ * @details Might exit the program with <strong>EXIT_FAILURE</strong> if arguments are invalid.
+ * @param opts Pointer to program options.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ */
+static void parse_args(t_opt *opts, int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "p:n:x:s:e:aq")) != -1) {
+        switch (opt) {
+            case 'p': opts->prog = optarg; break;
+            case 'n': opts->min_exp = parse_exp(optarg); break;
+            case 'x': opts->max_exp = parse_exp(optarg); break;
+            case 's': opts->seed = strtoul(optarg, NULL, 10); break;
+            case 'e': opts->engine = optarg; break;
+            case 'a': opts->no_limit = true; break;
+            case 'q': opts->square = true; break;
+            case '?':
+            default: usage();
+        }
+    }
+    if (optind != argc || opts->min_exp > opts->max_exp) usage();
+}
+
+/**
+ * @brief Generates the next pseudo random number.
+ * @details Xorshift generator, so operands are the same on every platform for the same seed.
+ * @param state Pointer to the state of the generator.
+ * @return Pseudo random number.
+ */
+static uint64_t next_rand(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * @brief Generates a random hexadecimal operand.
+ * @details The first digit is never zero, so the operand has exactly <strong>len</strong> significant digits.
+ * @param len Count of digits.
+ * @param state Pointer to the state of the generator.
+ * @return Operand string (must be freed), NULL on error.
+ */
+static char *gen_rand(size_t len, uint64_t *state) {
+    static const char digits[] = "0123456789abcdef";
+    char *x = (char *) malloc(sizeof(char) * (len + 1));
+    if (x == NULL) return NULL;
+    for (size_t i = 0; i < len; i++) x[i] = digits[next_rand(state) & 0xf];
+    if (x[0] == '0') x[0] = '1';
+    x[len] = '\0';
+    return x;
+}
+
+/**
+ * @brief Calculates the residue of a hexadecimal number.
+ * @param x Hexadecimal string.
+ * @param p Modulus.
+ * @return x mod p.
+ */
+static uint64_t residue(const char *x, uint64_t p) {
+    uint64_t r = 0;
+    for (; *x != '\0'; x++) r = (r * 16 + hex_val(*x)) % p;
+    return r;
+}
+
+/**
+ * @brief Skips the leading zeroes of a hexadecimal number.
+ * @param x Hexadecimal string.
+ * @return Pointer to the first significant digit (or the last zero).
+ */
+static const char *skip_zeroes(const char *x) {
+    while (x[0] == '0' && x[1] != '\0') x++;
+    return x;
+}
+
+/**
+ * @brief Computes the exact reference product.
+ * @details Schoolbook multiplication on hexadecimal digits, independent of the implementation of intmul.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return Product string without leading zeroes (must be freed), NULL on error.
+ */
+static char *reference(const char *a, const char *b) {
+    static const char digits[] = "0123456789abcdef";
+    size_t la = strlen(a), lb = strlen(b), n = la + lb;
+    uint32_t *acc = (uint32_t *) calloc(n, sizeof(uint32_t)); /**< Digits of the product, least significant first. */
+    char *prod = (char *) malloc(sizeof(char) * (n + 1));
+    if (acc == NULL || prod == NULL) {
+        free(acc);
+        free(prod);
+        return NULL;
+    }
+    for (size_t i = 0; i < la; i++) {
+        uint32_t carry = 0;
+        int a_i = hex_val(a[la - 1 - i]);
+        for (size_t j = 0; j < lb; j++) {
+            uint32_t t = acc[i + j] + a_i * hex_val(b[lb - 1 - j]) + carry;
+            acc[i + j] = t & 0xf;
+            carry = t >> 4;
+        }
+        for (size_t k = i + lb; carry != 0; k++) {
+            uint32_t t = acc[k] + carry;
+            acc[k] = t & 0xf;
+            carry = t >> 4;
+        }
+    }
+    for (size_t i = 0; i < n; i++) prod[i] = digits[acc[n - 1 - i]];
+    prod[n] = '\0';
+    free(acc);
+    memmove(prod, skip_zeroes(prod), strlen(skip_zeroes(prod)) + 1);
+    return prod;
+}
+
+/**
+ * @brief Checks whether a product is correct.
+ * @details Compares the product with the exact reference if there is one, otherwise checks if its residues match
+ * the ones of the operands for several primes.
+ * @param a First operand.
+ * @param b Second operand.
+ * @param prod Product computed by intmul.
+ * @param ref Exact reference product or NULL.
+ * @return true if the product is correct, false otherwise.
+ */
+static bool check(const char *a, const char *b, char *prod, const char *ref) {
+    size_t len = strlen(prod);
+    if (len > 0 && prod[len - 1] == '\n') prod[--len] = '\0';
+    if (len == 0 || strspn(prod, "0123456789abcdef") != len) return false;
+    if (ref != NULL) return strcmp(skip_zeroes(prod), ref) == 0;
+    for (int i = 0; i < CHECK_N; i++) {
+        if (residue(a, primes[i]) * residue(b, primes[i]) % primes[i] != residue(prod, primes[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Counts the processes that the process tree engine creates.
+ * @details Computed from the operands by mirroring the splitting of intmul: leading zeroes are removed, both operands
+ * are split at ceil(n/2) digits from the right and only sub-multiplications with non-empty parts get a child. Equal
+ * operands need one child less, as the cross terms are only computed once.
+ * @param a First operand (not null terminated).
+ * @param la Length of the first operand.
+ * @param b Second operand (not null terminated).
+ * @param lb Length of the second operand.
+ * @return Count of processes (incl. the root).
+ */
+static long tree_procs(const char *a, size_t la, const char *b, size_t lb) {
+    for (; la > 1 && *a == '0'; la--) a++;
+    for (; lb > 1 && *b == '0'; lb--) b++;
+    if (la == 1 && lb == 1) return 1;
+    size_t low = ((la > lb ? la : lb) + 1) / 2; /**< Length of the low parts. */
+    size_t a_h = (la > low) ? la - low : 0, b_h = (lb > low) ? lb - low : 0; /**< Lengths of the high parts. */
+    bool square = la == lb && memcmp(a, b, la) == 0;
+    long procs = 1 + tree_procs(a + a_h, la - a_h, b + b_h, lb - b_h);
+    if (a_h > 0) procs += tree_procs(a, a_h, b + b_h, lb - b_h);
+    if (b_h > 0 && !square) procs += tree_procs(a + a_h, la - a_h, b, b_h);
+    if (a_h > 0 && b_h > 0) procs += tree_procs(a, a_h, b, b_h);
+    return procs;
+}
+
+/**
+ * @brief Reads everything from a file descriptor.
+ * @param fd File descriptor.
+ * @return Null terminated content (must be freed), NULL on error.
+ */
+static char *read_all(int fd) {
+    size_t cap = 4096, len = 0;
+    char *buf = (char *) malloc(cap);
+    if (buf == NULL) return NULL;
+    while (true) {
+        if (len + 1 == cap) {
+            char *temp = (char *) realloc(buf, cap * 2);
+            if (temp == NULL) {
+                free(buf);
+                return NULL;
+            }
+            buf = temp;
+            cap *= 2;
+        }
+        ssize_t n = read(fd, buf + len, cap - 1 - len);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) {
+            free(buf);
+            return NULL;
+        }
+        if (n == 0) break;
+        len += n;
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+/**
+ * @brief Writes a whole buffer to a file descriptor.
+ * @param fd File descriptor.
+ * @param buf Buffer.
+ * @param len Length of the buffer.
+ * @return 0 on success, -1 on error.
+ */
+static int write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs intmul once and measures it.
+ * @details Passes both operands to intmul through a pipe and reads the product from another one.<br>
+ * CPU time and peak memory are taken from the resource usage of the terminated child, which includes all of its
+ * terminated descendants.
+ * @param res Pointer to the result to be updated, its output must be freed.
+ * @param prog Path to intmul.
+ * @param engine Name of the engine.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return 0 on success, -1 on error.
+ */
+static int run(t_result *res, char *prog, char *engine, const char *a, const char *b) {
+    int pin_fd[P_N], pout_fd[P_N];
+    if (pipe(pin_fd) == -1) return t_err("pipe");
+    if (pipe(pout_fd) == -1) return t_err("pipe");
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t cid = fork();
+    switch (cid) {
+        case -1:
+            return t_err("fork");
+        case 0:
+            close(pin_fd[1]);
+            close(pout_fd[0]);
+            if (
+                dup2(pin_fd[0], STDIN_FILENO) == -1 ||
+                dup2(pout_fd[1], STDOUT_FILENO) == -1
+            ) _exit(EXIT_FAILURE);
+            close(pin_fd[0]);
+            close(pout_fd[1]);
+            execl(prog, prog, "-e", engine, NULL);
+            t_err("execl");
+            _exit(EXIT_FAILURE);
+        default:
+            break;
+    }
+    close(pin_fd[0]);
+    close(pout_fd[1]);
+    int err = 0;
+    if (
+        write_all(pin_fd[1], a, strlen(a)) == -1 ||
+        write_all(pin_fd[1], "\n", 1) == -1 ||
+        write_all(pin_fd[1], b, strlen(b)) == -1 ||
+        write_all(pin_fd[1], "\n", 1) == -1
+    ) err = t_err("write");
+    close(pin_fd[1]);
+    res->out = read_all(pout_fd[0]);
+    if (res->out == NULL) err = t_err("read_all");
+    close(pout_fd[0]);
+    int status;
+    struct rusage usage;
+    if (wait4(cid, &status, 0, &usage) == -1) return t_err("wait4");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) err = -1;
+    res->wall_ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    res->cpu_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 +
+        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+    res->maxrss_kb = usage.ru_maxrss;
+    return err;
+}
+
+/**
+ * @brief Entry point of the benchmark.
+ * @details For every operand size, generates two random operands and runs every engine whose size limit is not
+ * exceeded (unless -a is passed). Prints one CSV line per run to <strong>stdout</strong>.<br>
+ * Exits with <strong>EXIT_FAILURE</strong> if any run failed or computed a wrong product.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ * @return <strong>EXIT_SUCCESS</strong> if all products are correct.
+ */
+int main(int argc, char **argv) {
+    prog_name = argv[0];
+    t_opt opts = { DEFAULT_PROG, DEFAULT_MIN_EXP, DEFAULT_MAX_EXP, 1, NULL, false, false };
+    parse_args(&opts, argc, argv);
+    uint64_t state = 0x9e3779b97f4a7c15ULL ^ opts.seed;
+    int failed = 0;
+    printf("engine,op,digits,wall_ms,cpu_ms,maxrss_kb,procs,check\n");
+    fflush(stdout);
+    for (int exp = opts.min_exp; exp <= opts.max_exp; exp++) {
+        size_t len = (size_t) 1 << exp;
+        char *a = gen_rand(len, &state), *b = gen_rand(len, &state);
+        if (a != NULL && b != NULL && opts.square) strcpy(b, a);
+        char *ref = (a != NULL && b != NULL && exp <= REF_MAX_EXP) ? reference(a, b) : NULL;
+        if (a == NULL || b == NULL || (exp <= REF_MAX_EXP && ref == NULL)) {
+            free(a);
+            free(b);
+            free(ref);
+            t_err("malloc");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < E_N; i++) {
+            if (opts.engine != NULL && strcmp(opts.engine, engines[i].name) != 0) continue;
+            if (!opts.no_limit && exp > engines[i].max_exp) continue;
+            t_result res = { 0, 0, 0, NULL };
+            bool ok = run(&res, opts.prog, engines[i].name, a, b) == 0 && check(a, b, res.out, ref);
+            long procs = (i == 0) ? tree_procs(a, len, b, len) : 1;
+            printf(
+                "%s,%s,%zu,%.3f,%.3f,%ld,%ld,%s\n", engines[i].name, opts.square ? "sqr" : "mul", len, res.wall_ms,
+                res.cpu_ms, res.maxrss_kb, procs, ok ? "ok" : "fail"
+            );
+            fflush(stdout);
+            if (!ok) failed = 1;
+            free(res.out);
+        }
+        free(a);
+        free(b);
+        free(ref);
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -4,24 +4,121 @@
  * @details Efficiently performs a multiplication of two hexadecimal numbers of any length.<br>
  * To split up and accelerate the computation, it recursively creates child processes that calculate parts of the
  * multiplication.<br>
- * Numbers are read from <strong>stdin</strong> and outputted to <strong>stdout</strong>.
+ * Numbers are read from <strong>stdin</strong> and outputted to <strong>stdout</strong>.<br>
+ * In batch mode, pairs of numbers are read continuously and multiplied in-process by a pool of threads.<br>
+ * Instead of the process tree, one of several in-process engines can be chosen for the multiplication.<br>
+ * In pow mode, a single number is raised to a power by repeated squaring.
  * @file intmul.c
  * @author Tobias Gruber, 11912367
  * @date 18.11.2022
  **/
 
 #include "hex.h"
+#include "ntt.h"
+#include "arena.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
+#include <pthread.h>
 
 #define R_N 2 /**< Number of operands for the multiplication. */
 #define F_N 4 /**< Number of forked child processes. */
 #define P_N 2 /**< Number of pipe ends. */
+#define B_N 1024 /**< Maximal number of operand pairs per batch. */
+#define T_MAX 256 /**< Maximal number of worker threads. */
+#define R_BUF_SIZE 65536 /**< Initial size of the batch input buffer. */
+
+/**
+ * @brief Multiplication engines.
+ */
+typedef enum Engine {
+    E_TREE, /**< Recursive tree of child processes. */
+    E_SCHOOL, /**< In-process schoolbook multiplication. */
+    E_THREAD, /**< In-process recursive tree of threads. */
+    E_KARATSUBA, /**< In-process Karatsuba multiplication. */
+    E_NTT, /**< In-process multiplication with the number theoretic transform. */
+    E_N /**< Number of engines. */
+} t_engine;
+
+static const char *engine_names[E_N] = { "tree", "school", "thread", "karatsuba", "ntt" }; /**< Names of engines. */
+
+/**
+ * @brief Program options.
+ * @details The program configurations that are specified by the arguments.
+ */
+typedef struct Options {
+    int bflag; /**< Count of passed -b flags (from the arguments). */
+    int tflag; /**< Count of passed -t flags (from the arguments). */
+    int eflag; /**< Count of passed -e flags (from the arguments). */
+    int pflag; /**< Count of passed -p flags (from the arguments). */
+    unsigned long exp; /**< Exponent in pow mode. */
+    int thread_c; /**< Count of worker threads in batch mode or of the threaded engine. */
+    t_engine engine; /**< Multiplication engine. */
+} t_opt;
+
+/**
+ * @brief Buffered line reader.
+ * @details Reads lines of any length from a file descriptor without copying them and allows to check whether a
+ * line is available without blocking.
+ */
+typedef struct Reader {
+    int fd; /**< File descriptor to read from. */
+    char *buf; /**< Buffered input. */
+    size_t cap; /**< Size of the buffer. */
+    size_t start; /**< Start of the unread input in the buffer. */
+    size_t end; /**< End of the unread input in the buffer. */
+    size_t scanned; /**< End of the input that was already scanned for a newline. */
+    bool eof; /**< Whether the end of the input was reached. */
+} t_reader;
+
+/**
+ * @brief Multiplication job of the batch mode.
+ * @details Buffers are kept across batches, so they are only reallocated if an operand or product is longer than
+ * all before.
+ */
+typedef struct Job {
+    char *a; /**< First operand (in hex). */
+    size_t a_cap; /**< Capacity of the first operand. */
+    size_t a_len; /**< Length of the first operand. */
+    char *b; /**< Second operand (in hex). */
+    size_t b_cap; /**< Capacity of the second operand. */
+    size_t b_len; /**< Length of the second operand. */
+    char *res; /**< Product (in hex). */
+    size_t res_cap; /**< Capacity of the product. */
+    long res_len; /**< Length of the product. */
+} t_job;
+
+/**
+ * @brief State of the batch mode shared by all workers.
+ */
+typedef struct Batch {
+    t_job jobs[B_N]; /**< Jobs of the current batch. */
+    size_t job_c; /**< Count of jobs in the current batch. */
+    int thread_c; /**< Count of workers (incl. the main thread). */
+    t_engine engine; /**< Multiplication engine. */
+    bool quit; /**< Whether the workers should terminate. */
+    pthread_barrier_t start; /**< Barrier that starts the processing of a batch. */
+    pthread_barrier_t done; /**< Barrier that ends the processing of a batch. */
+} t_batch;
+
+/**
+ * @brief Worker of the batch mode.
+ * @details Holds its own big numbers, so they can be reused for every job without allocating.
+ */
+typedef struct Worker {
+    t_batch *batch; /**< Shared batch state. */
+    int id; /**< Index of the worker, the main thread has index 0. */
+    int err; /**< Whether a job of the worker failed. */
+    t_big a; /**< First operand. */
+    t_big b; /**< Second operand. */
+    t_big prod; /**< Product. */
+} t_worker;
 
 char *prog_name;
 
@@ -31,10 +128,95 @@ char *prog_name;
  * Used global variables: prog_name
  */
 static void usage(void) {
-    fprintf(stderr, "Usage: %s\n", prog_name);
+    fprintf(
+        stderr,
+        "Usage: %s [-b | -p EXPONENT] [-e tree|school|thread|karatsuba|ntt] [-t THREADS]\n",
+        prog_name
+    );
     exit(EXIT_FAILURE);
 }
 
+/**
+ * @brief Parses the program arguments.
+ * @details Reads and validates program options.<br>
+ * Might exit the program with <strong>EXIT_FAILURE</strong> if arguments are invalid.
+ * @param opts Pointer to program options.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ */
+static void parse_args(t_opt *opts, int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "be:p:t:")) != -1) {
+        switch (opt) {
+            case 'b':
+                opts->bflag++;
+                break;
+            case 'e': {
+                opts->eflag++;
+                int engine = 0;
+                while (engine < E_N && strcmp(optarg, engine_names[engine]) != 0) engine++;
+                if (engine == E_N) usage();
+                opts->engine = (t_engine) engine;
+                break;
+            }
+            case 'p': {
+                opts->pflag++;
+                char *end = NULL;
+                errno = 0;
+                opts->exp = strtoul(optarg, &end, 10);
+                if (*end != '\0' || *optarg == '-' || errno == ERANGE) usage();
+                break;
+            }
+            case 't': {
+                opts->tflag++;
+                char *end = NULL;
+                long thread_c = strtol(optarg, &end, 10);
+                if (*end != '\0' || thread_c < 1 || thread_c > T_MAX) usage();
+                opts->thread_c = (int) thread_c;
+                break;
+            }
+            case '?':
+            default: usage();
+        }
+    }
+    if (
+        optind != argc ||
+        opts->bflag > 1 ||
+        opts->tflag > 1 ||
+        opts->eflag > 1 ||
+        opts->pflag > 1 ||
+        (opts->bflag == 1 && opts->pflag == 1) ||
+        ((opts->bflag == 1 || opts->pflag == 1) && opts->engine == E_TREE && opts->eflag == 1) ||
+        (opts->tflag == 1 && opts->bflag == 0 && opts->engine != E_THREAD)
+    ) usage();
+    if (opts->bflag == 1 && opts->eflag == 0) opts->engine = E_SCHOOL;
+    if (opts->pflag == 1 && opts->eflag == 0) opts->engine = E_KARATSUBA;
+    if (opts->thread_c == 0) {
+        long cpu_c = sysconf(_SC_NPROCESSORS_ONLN);
+        opts->thread_c = (cpu_c < 1) ? 1 : (cpu_c > T_MAX) ? T_MAX : (int) cpu_c;
+    }
+}
+
+/**
+ * @brief Multiplies two big numbers in-process.
+ * @details Dispatches the multiplication to the given engine.<br>
+ * <strong>dst</strong> must not be the same number as <strong>a</strong> or <strong>b</strong>.
+ * @param dst Big number to be updated with the product.
+ * @param a First operand.
+ * @param b Second operand.
+ * @param engine In-process multiplication engine.
+ * @param thread_c Count of threads of the threaded engine.
+ * @return 0 on success, -1 on error.
+ */
+static int multiply_big(t_big *dst, const t_big *a, const t_big *b, t_engine engine, int thread_c) {
+    switch (engine) {
+        case E_THREAD: return big_mul_threaded(dst, a, b, thread_c);
+        case E_KARATSUBA: return big_mul_karatsuba(dst, a, b);
+        case E_NTT: return big_mul_ntt(dst, a, b);
+        default: return big_mul(dst, a, b);
+    }
+}
+
 /**
  * @brief Waits for all given processes to terminate.
  * @param pid Array of all process ids. -1 as id indicates, that is was not set yet.
@@ -65,14 +247,14 @@ static void free_rands(char *a, char *b) {
 
 /**
  * @brief Reads the operands from <strong>stdin</strong>.
- * @details Validates the operands as hexadecimal numbers and transforms them
- * so that their lengths are equal and a power of two.<br>
+ * @details Validates the operands as hexadecimal numbers and removes their leading zeroes.<br>
  * Allocates the necessary memory for <strong>a</strong> and <strong>b</strong>.
  * @param a Pointer to be updated with the first operand string.
- * @param b Pointer to be updated with the second operand string.
+ * @param b Pointer to be updated with the second operand string, NULL if only one operand should be read.
  * @return 0 on success, -1 on error.
  */
 static int receive_rands(char **a, char **b) {
+    size_t rand_c = (b == NULL) ? 1 : R_N; /**< Count of operands to be read. */
     char *line = NULL; /**< String of the current line. */
     size_t len = 0; /**< Line length. */
     size_t line_c = 0; /**< Line counter. */
@@ -91,33 +273,56 @@ static int receive_rands(char **a, char **b) {
             return t_err("malloc");
         }
         strcpy(*x, line);
-        if (++line_c >= R_N) break;
+        if (++line_c >= rand_c) break;
     }
     free(line);
-    if (line_c < R_N) {
+    if (line_c < rand_c) {
         errno = EINVAL;
-        return m_err("Less than two hexadecimal numbers provided");
+        return m_err((rand_c == 1) ? "No hexadecimal number provided" : "Less than two hexadecimal numbers provided");
+    }
+    strip_zeroes(*a);
+    if (b != NULL) strip_zeroes(*b);
+    return 0;
+}
+
+/**
+ * @brief Writes all buffers to a file descriptor.
+ * @details Uses as few writev() calls as possible and continues after partial writes.
+ * @param fd File descriptor.
+ * @param iov Buffers to be written, updated on partial writes.
+ * @param iov_c Count of buffers.
+ * @return 0 on success, -1 on error.
+ */
+static int write_all(int fd, struct iovec *iov, int iov_c) {
+    while (iov_c > 0) {
+        ssize_t n = writev(fd, iov, iov_c);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return t_err("writev");
+        }
+        for (; iov_c > 0 && (size_t) n >= iov->iov_len; iov++, iov_c--) n -= iov->iov_len;
+        if (iov_c > 0) {
+            iov->iov_base = (char *) iov->iov_base + n;
+            iov->iov_len -= n;
+        }
     }
-    int max_len = max(strlen(*a), strlen(*b)); /**< Max length of both operands. */
-    if (
-        fill_zeroes(a, max_len, true) < 0 ||
-        fill_zeroes(b, max_len, true) < 0
-    ) t_err("fill_zeroes");
     return 0;
 }
 
 /**
  * @brief Delegates a hex multiplication to a forked child.
  * @details Forks the process and communicates the input and output of the child with pipes.<br>
- * Allocates necessary memory for <strong>res</strong>.<br>
+ * The response is read into <strong>res</strong> without allocating memory.<br>
  * Used global variables: prog_name
- * @param res Pointer to be updated with the result string.
+ * @param res String to be updated with the result, must have space for the product, a newline and the null
+ * terminator.
+ * @param res_cap Capacity of res.
+ * @param cid Pointer to be updated with the child's process id.
  * @param x String of the first operand (in hex).
  * @param y String of the second operand (in hex).
- * @param cid Pointer to be updated with the child's process id.
  * @return 0 on success, -1 on error.
  */
-static int fork_child(char **res, pid_t *cid, char *x, char *y) {
+static int fork_child(char *res, size_t res_cap, pid_t *cid, char *x, char *y) {
     /**
      * Pipe to pass input to child as an array.
      * @details First element is read end, second one the write end.
@@ -149,51 +354,50 @@ static int fork_child(char **res, pid_t *cid, char *x, char *y) {
             close(pin_fd[0]);
             close(pout_fd[1]);
 
-            FILE *pin_p = fdopen(pin_fd[1], "w"); /**< Pointer to the input pipe. */
-            if (pin_p == NULL) t_err("fdopen");
-            if (
-                fprintf(pin_p, "%s\n", x) == -1 ||
-                fprintf(pin_p, "%s\n", y) == -1
-            ) {
-                fclose(pin_p);
+            struct iovec iov[2 * R_N] = {
+                { x, strlen(x) },
+                { "\n", 1 },
+                { y, strlen(y) },
+                { "\n", 1 }
+            }; /**< Operands passed to the child. */
+            if (write_all(pin_fd[1], iov, 2 * R_N) == -1) {
                 close(pin_fd[1]);
                 close(pout_fd[0]);
-                return t_err("fprintf");
+                return t_err("write_all");
             }
-            fflush(pin_p);
-            fclose(pin_p);
             close(pin_fd[1]);
 
-            FILE *pout_p = fdopen(pout_fd[0], "r"); /**< Pointer to the output pipe. */
-            if (pout_p == NULL) t_err("fdopen");
-            char *line = NULL;
-            size_t len = 0;
-            if ((getline(&line, &len, pout_p)) == -1) {
-                free(line);
-                fclose(pout_p);
-                close(pout_fd[0]);
-                return t_err("getline");
+            size_t len = 0; /**< Length of the response. */
+            ssize_t n;
+            while (len < res_cap - 1 && (n = read(pout_fd[0], res + len, res_cap - 1 - len)) != 0) {
+                if (n == -1 && errno == EINTR) continue;
+                if (n == -1) {
+                    close(pout_fd[0]);
+                    return t_err("read");
+                }
+                len += n;
             }
-            fflush(pout_p);
-            fclose(pout_p);
             close(pout_fd[0]);
-
-            *res = (char *) malloc(sizeof(char) * (strlen(line) + 1));
-            if (*res == NULL) {
-                free(line);
-                return t_err("malloc");
+            res[len] = '\0';
+            if (len == 0 || res[len - 1] != '\n') {
+                errno = EIO;
+                return m_err("Invalid response of child");
             }
-            strcpy(*res, line);
-            remove_newline(*res);
-            free(line);
+            remove_newline(res);
     }
     return 0;
 }
 
 /**
  * @brief Multiplies two hex numbers of any length recursively.
- * @details Output is printed to <strong>stdout</strong>.<br>
- * Delegates parts of the calculation to four child processes and brings them together to receive the product.<br>
+ * @details Output is printed to <strong>stdout</strong> without leading zeroes.<br>
+ * Splits both operands at ceil(n/2) digits from the right, where n is the length of the longer operand, and
+ * delegates the sub-multiplications to child processes. Sub-multiplications with an empty high part are skipped, so
+ * operands of different lengths need only two children (unbalanced split).<br>
+ * If both operands are equal, the equal cross terms a_h·a_l and a_l·a_h are only computed by one child, whose
+ * response is added twice (three children).<br>
+ * All parts, responses and the product are allocated from one arena that is sized from the operand lengths up front,
+ * and the responses are summed up in place.<br>
  * The parent process is waiting until all children are done.<br>
  * The operands are not limited in length.
  * @param a String of the first operand (in hex).
@@ -201,60 +405,398 @@ static int fork_child(char **res, pid_t *cid, char *x, char *y) {
  * @return 0 on success, -1 on error.
  */
 static int multiply_recursively(char *a, char *b) {
-    int len = strlen(a); /**< Length of the operands. */
-    int half_len = len / 2; /**< Half length of the operands. */
-    char a_h[half_len + 1], a_l[half_len + 1], b_h[half_len + 1], b_l[half_len + 1];
-    half_str(a_h, a, 0, half_len);
-    half_str(a_l, a, 1, half_len);
-    half_str(b_h, b, 0, half_len);
-    half_str(b_l, b, 1, half_len);
+    int la = strlen(a), lb = strlen(b); /**< Lengths of the operands. */
+    int len = max(la, lb); /**< Length of the longer operand. */
+    int low_len = (len + 1) / 2; /**< Length of the low parts of the operands. */
+    size_t part_size = len + 1; /**< Size of a part of an operand. */
+    size_t res_size = 2 * len + 2; /**< Size of a response (product, newline and null terminator). */
+    size_t prod_size = la + lb + 1; /**< Size of the product. */
+    t_arena arena;
+    if (arena_init(
+        &arena,
+        F_N * (part_size + ARENA_ALIGN) + F_N * (res_size + ARENA_ALIGN) + prod_size + ARENA_ALIGN
+    ) == -1) return t_err("arena_init");
+    char *a_h = arena_alloc(&arena, part_size), *a_l = arena_alloc(&arena, part_size);
+    char *b_h = arena_alloc(&arena, part_size), *b_l = arena_alloc(&arena, part_size);
+    if (a_h == NULL || a_l == NULL || b_h == NULL || b_l == NULL) {
+        arena_free(&arena);
+        return t_err("arena_alloc");
+    }
+    split_str(a_h, a, 0, low_len);
+    split_str(a_l, a, 1, low_len);
+    split_str(b_h, b, 0, low_len);
+    split_str(b_l, b, 1, low_len);
+    char *x[F_N] = { a_h, a_h, a_l, a_l }; /** First operands of the children. */
+    char *y[F_N] = { b_h, b_l, b_h, b_l }; /** Second operands of the children. */
+    int shift[F_N] = { 2 * low_len, low_len, low_len, 0 }; /** Digits the results of the children are shifted. */
     char *res[F_N] = { NULL, NULL, NULL, NULL }; /** Responses of the children. */
     pid_t pid[F_N] = { -1, -1, -1, -1 }; /** Process ids of the children. */
-    if (
-        fork_child(&(res[0]), &(pid[0]), a_h, b_h) == -1 ||
-        fork_child(&(res[1]), &(pid[1]), a_h, b_l) == -1 ||
-        fork_child(&(res[2]), &(pid[2]), a_l, b_h) == -1 ||
-        fork_child(&(res[3]), &(pid[3]), a_l, b_l) == -1
-    ) {
-        wait_all(pid);
-        free_arr(res, F_N);
-        return t_err("fork_child");
+    bool square = strcmp(a, b) == 0; /**< Whether the cross terms are equal. */
+    for (int i = 0; i < F_N; i++) {
+        if (strlen(x[i]) == 0 || strlen(y[i]) == 0 || (square && i == 2)) continue;
+        res[i] = arena_alloc(&arena, res_size);
+        if (res[i] == NULL || fork_child(res[i], res_size, &(pid[i]), x[i], y[i]) == -1) {
+            wait_all(pid);
+            arena_free(&arena);
+            return t_err("fork_child");
+        }
     }
     if (wait_all(pid) == -1) {
-        free_arr(res, F_N);
+        arena_free(&arena);
         return t_err("wait_all");
     }
-    if (
-        shift_left(&(res[0]), len) == -1 ||
-        shift_left(&(res[1]), half_len) == -1 ||
-        shift_left(&(res[2]), half_len) == -1
-    ) {
-        free_arr(res, F_N);
-        return t_err("shift_left");
-    }
-    char *prod = NULL; /**< Product of the multiplication. */
-    if (
-        add(&prod, &(res[0]), &(res[1])) == -1 ||
-        add(&prod, &prod, &(res[2])) == -1 ||
-        add(&prod, &prod, &(res[3])) == -1
-    ) {
-        free_arr(res, F_N);
-        return t_err("add");
+    char *prod = arena_alloc(&arena, prod_size); /**< Product of the multiplication. */
+    if (prod == NULL) {
+        arena_free(&arena);
+        return t_err("arena_alloc");
     }
+    memset(prod, '0', la + lb);
+    prod[la + lb] = '\0';
+    for (int i = 0; i < F_N; i++) {
+        if (res[i] != NULL && add_shifted(prod, la + lb, res[i], shift[i]) == -1) {
+            arena_free(&arena);
+            return t_err("add_shifted");
+        }
+    }
+    if (square && res[1] != NULL && add_shifted(prod, la + lb, res[1], shift[1]) == -1) {
+        arena_free(&arena);
+        return t_err("add_shifted");
+    }
+    strip_zeroes(prod);
     printf("%s\n", prod);
     fflush(stdout);
-    free_arr(res, F_N);
-    free(prod);
+    arena_free(&arena);
+    return 0;
+}
+
+/**
+ * @brief Reads the next line from a reader.
+ * @details The line is not copied, <strong>line</strong> points into the buffer of the reader and is only valid until
+ * the next call. The newline is not part of the line.<br>
+ * If <strong>block</strong> is false and no complete line is buffered, it only reads if input is available right
+ * away.
+ * @param r Reader.
+ * @param line Pointer to be updated with the start of the line.
+ * @param len Pointer to be updated with the length of the line.
+ * @param block Whether it should wait for input.
+ * @return 1 if a line was read, 0 at the end of the input, 2 if no line is available yet, -1 on error.
+ */
+static int read_line(t_reader *r, char **line, size_t *len, bool block) {
+    while (true) {
+        char *nl = memchr(r->buf + r->scanned, '\n', r->end - r->scanned); /**< End of the line. */
+        if (nl != NULL || (r->eof && r->start < r->end)) {
+            size_t end = (nl != NULL) ? (size_t) (nl - r->buf) : r->end;
+            *line = r->buf + r->start;
+            *len = end - r->start;
+            if (*len > 0 && (*line)[*len - 1] == '\r') (*len)--;
+            r->start = (nl != NULL) ? end + 1 : end;
+            r->scanned = r->start;
+            return 1;
+        }
+        r->scanned = r->end;
+        if (r->eof) return 0;
+        if (!block) {
+            struct pollfd pfd = { r->fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, 0);
+            if (ready == -1) return t_err("poll");
+            if (ready == 0) return 2;
+        }
+        if (r->start > 0) {
+            memmove(r->buf, r->buf + r->start, r->end - r->start);
+            r->end -= r->start;
+            r->scanned -= r->start;
+            r->start = 0;
+        }
+        if (r->end == r->cap) {
+            char *temp = (char *) realloc(r->buf, sizeof(char) * r->cap * 2);
+            if (temp == NULL) return t_err("realloc");
+            r->buf = temp;
+            r->cap *= 2;
+        }
+        ssize_t n = read(r->fd, r->buf + r->end, r->cap - r->end);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return t_err("read");
+        }
+        if (n == 0) r->eof = true;
+        r->end += n;
+    }
+}
+
+/**
+ * @brief Copies an operand into a buffer of a job.
+ * @details Validates the operand as hexadecimal number.<br>
+ * Reallocates <strong>dst</strong> if its capacity is not sufficient.
+ * @param dst Pointer to the buffer to be updated.
+ * @param cap Pointer to the capacity of the buffer.
+ * @param dst_len Pointer to be updated with the length of the operand.
+ * @param line Operand (not null terminated).
+ * @param len Length of the operand.
+ * @return 0 on success, -1 on error.
+ */
+static int store_rand(char **dst, size_t *cap, size_t *dst_len, char *line, size_t len) {
+    if (*dst == NULL || *cap < len + 1) {
+        char *temp = (char *) realloc(*dst, sizeof(char) * (len + 1));
+        if (temp == NULL) return t_err("realloc");
+        *dst = temp;
+        *cap = len + 1;
+    }
+    memcpy(*dst, line, len);
+    (*dst)[len] = '\0';
+    *dst_len = len;
+    if (is_hex(*dst) == -1) {
+        m_err("Input must be a hexadecimal number");
+        errno = EINVAL;
+        return t_err("is_hex");
+    }
+    return 0;
+}
+
+/**
+ * @brief Computes all jobs of the current batch that are assigned to a worker.
+ * @details Jobs are assigned round robin, so every worker gets a share of the batch without synchronization.
+ * @param w Worker.
+ */
+static void run_jobs(t_worker *w) {
+    t_batch *batch = w->batch;
+    for (size_t i = w->id; i < batch->job_c; i += batch->thread_c) {
+        t_job *job = &(batch->jobs[i]);
+        job->res_len = -1;
+        if (
+            big_from_hex(&(w->a), job->a, job->a_len) == -1 ||
+            big_from_hex(&(w->b), job->b, job->b_len) == -1 ||
+            multiply_big(&(w->prod), &(w->a), &(w->b), batch->engine, 1) == -1 ||
+            (job->res_len = big_to_hex(&(job->res), &(job->res_cap), &(w->prod))) == -1
+        ) w->err = 1;
+    }
+}
+
+/**
+ * @brief Entry point of worker threads.
+ * @details Computes its jobs of every batch until the batch mode quits.
+ * @param arg Pointer to the worker.
+ * @return NULL.
+ */
+static void *work(void *arg) {
+    t_worker *w = (t_worker *) arg;
+    while (true) {
+        pthread_barrier_wait(&(w->batch->start));
+        if (w->batch->quit) break;
+        run_jobs(w);
+        pthread_barrier_wait(&(w->batch->done));
+    }
+    return NULL;
+}
+
+/**
+ * @brief Computes and outputs the current batch.
+ * @details The main thread computes its share of jobs alongside the workers.<br>
+ * Products are printed to <strong>stdout</strong> in the order of the jobs.
+ * @param batch Batch state.
+ * @param workers Array of all workers.
+ * @return 0 on success, -1 on error.
+ */
+static int run_batch(t_batch *batch, t_worker *workers) {
+    if (batch->job_c == 0) return 0;
+    if (batch->thread_c > 1) pthread_barrier_wait(&(batch->start));
+    run_jobs(&(workers[0]));
+    if (batch->thread_c > 1) pthread_barrier_wait(&(batch->done));
+    for (int i = 0; i < batch->thread_c; i++) {
+        if (workers[i].err) return m_err("Multiplication failed");
+    }
+    for (size_t i = 0; i < batch->job_c; i++) {
+        t_job *job = &(batch->jobs[i]);
+        job->res[job->res_len] = '\n';
+        if (fwrite(job->res, 1, job->res_len + 1, stdout) != (size_t) job->res_len + 1) return t_err("fwrite");
+    }
+    if (fflush(stdout) == EOF) return t_err("fflush");
+    batch->job_c = 0;
     return 0;
 }
 
+/**
+ * @brief Reads all operand pairs of the batch mode and computes their products.
+ * @details Pairs are collected into batches, which are computed as soon as they are full or no further input is
+ * available right away.<br>
+ * @param batch Batch state.
+ * @param workers Array of all workers.
+ * @return 0 on success, -1 on error.
+ */
+static int read_batches(t_batch *batch, t_worker *workers) {
+    t_reader r = { STDIN_FILENO, NULL, R_BUF_SIZE, 0, 0, 0, false };
+    r.buf = (char *) malloc(sizeof(char) * r.cap);
+    if (r.buf == NULL) return t_err("malloc");
+    bool has_a = false; /**< Whether the first operand of the next job was read. */
+    int err = 0;
+    while (err == 0) {
+        char *line = NULL;
+        size_t len = 0;
+        int res = read_line(&r, &line, &len, batch->job_c == 0 || has_a);
+        if (res == -1) {
+            err = t_err("read_line");
+        } else if (res == 0) {
+            if (has_a) {
+                errno = EINVAL;
+                err = m_err("Odd number of hexadecimal numbers provided");
+            } else if (run_batch(batch, workers) == -1) err = t_err("run_batch");
+            break;
+        } else if (res == 2) {
+            if (run_batch(batch, workers) == -1) err = t_err("run_batch");
+        } else {
+            t_job *job = &(batch->jobs[batch->job_c]);
+            if (!has_a) {
+                if (store_rand(&(job->a), &(job->a_cap), &(job->a_len), line, len) == -1) err = t_err("store_rand");
+                has_a = true;
+                continue;
+            }
+            if (store_rand(&(job->b), &(job->b_cap), &(job->b_len), line, len) == -1) err = t_err("store_rand");
+            has_a = false;
+            if (++batch->job_c == B_N && run_batch(batch, workers) == -1) err = t_err("run_batch");
+        }
+    }
+    free(r.buf);
+    return err;
+}
+
+/**
+ * @brief Multiplies pairs of hex numbers in batch mode.
+ * @details Reads pairs of operands continuously from <strong>stdin</strong> and prints one product per line to
+ * <strong>stdout</strong>, in the order of the input.<br>
+ * Products are computed in-process by a pool of worker threads instead of a tree of child processes.
+ * @param thread_c Count of worker threads (incl. the main thread).
+ * @param engine In-process multiplication engine.
+ * @return 0 on success, -1 on error.
+ */
+static int multiply_batch(int thread_c, t_engine engine) {
+    t_batch *batch = (t_batch *) calloc(1, sizeof(t_batch));
+    t_worker *workers = (t_worker *) calloc(thread_c, sizeof(t_worker));
+    pthread_t tids[T_MAX];
+    if (batch == NULL || workers == NULL) {
+        if (batch != NULL) free(batch);
+        if (workers != NULL) free(workers);
+        return t_err("calloc");
+    }
+    batch->thread_c = thread_c;
+    batch->engine = engine;
+    for (int i = 0; i < thread_c; i++) {
+        workers[i].batch = batch;
+        workers[i].id = i;
+    }
+    if (thread_c > 1) {
+        if (
+            pthread_barrier_init(&(batch->start), NULL, thread_c) != 0 ||
+            pthread_barrier_init(&(batch->done), NULL, thread_c) != 0
+        ) return t_err("pthread_barrier_init");
+        for (int i = 1; i < thread_c; i++) {
+            // started workers cannot be stopped without all workers passing the barrier, the caller exits anyway
+            if (pthread_create(&(tids[i]), NULL, work, &(workers[i])) != 0) return t_err("pthread_create");
+        }
+    }
+    int err = 0;
+    if (read_batches(batch, workers) == -1) err = t_err("read_batches");
+    if (thread_c > 1) {
+        batch->quit = true;
+        pthread_barrier_wait(&(batch->start));
+        for (int i = 1; i < thread_c; i++) pthread_join(tids[i], NULL);
+        pthread_barrier_destroy(&(batch->start));
+        pthread_barrier_destroy(&(batch->done));
+    }
+    for (int i = 0; i < thread_c; i++) {
+        big_free(&(workers[i].a));
+        big_free(&(workers[i].b));
+        big_free(&(workers[i].prod));
+    }
+    for (size_t i = 0; i < B_N; i++) {
+        if (batch->jobs[i].a != NULL) free(batch->jobs[i].a);
+        if (batch->jobs[i].b != NULL) free(batch->jobs[i].b);
+        if (batch->jobs[i].res != NULL) free(batch->jobs[i].res);
+    }
+    free(workers);
+    free(batch);
+    return err;
+}
+
+/**
+ * @brief Multiplies two hex numbers of any length in-process.
+ * @details Output is printed to <strong>stdout</strong> without leading zeroes.
+ * @param a String of the first operand (in hex).
+ * @param b String of the second operand (in hex).
+ * @param engine In-process multiplication engine.
+ * @param thread_c Count of threads of the threaded engine.
+ * @return 0 on success, -1 on error.
+ */
+static int multiply_in_process(char *a, char *b, t_engine engine, int thread_c) {
+    t_big a_big = { NULL, 0, 0 }, b_big = { NULL, 0, 0 }, prod = { NULL, 0, 0 };
+    char *prod_hex = NULL;
+    size_t cap = 0;
+    int err = 0;
+    if (
+        big_from_hex(&a_big, a, strlen(a)) == -1 ||
+        big_from_hex(&b_big, b, strlen(b)) == -1
+    ) err = t_err("big_from_hex");
+    else if (multiply_big(&prod, &a_big, &b_big, engine, thread_c) == -1) err = t_err("multiply_big");
+    else if (big_to_hex(&prod_hex, &cap, &prod) == -1) err = t_err("big_to_hex");
+    else if (printf("%s\n", prod_hex) < 0 || fflush(stdout) == EOF) err = t_err("printf");
+    big_free(&a_big);
+    big_free(&b_big);
+    big_free(&prod);
+    if (prod_hex != NULL) free(prod_hex);
+    return err;
+}
+
+/**
+ * @brief Raises a hex number of any length to a power in-process.
+ * @details Uses left-to-right binary exponentiation: the intermediate result is squared for every bit of the
+ * exponent and multiplied with the base for every set bit. Intermediate results stay big numbers and are never
+ * converted to hex strings.<br>
+ * Output is printed to <strong>stdout</strong> without leading zeroes.
+ * @param a String of the base (in hex).
+ * @param exp Exponent.
+ * @param engine In-process multiplication engine.
+ * @param thread_c Count of threads of the threaded engine.
+ * @return 0 on success, -1 on error.
+ */
+static int power_in_process(char *a, unsigned long exp, t_engine engine, int thread_c) {
+    t_big base = { NULL, 0, 0 }, acc = { NULL, 0, 0 }, temp = { NULL, 0, 0 };
+    char *pow_hex = NULL;
+    size_t cap = 0;
+    int err = 0;
+    if (big_from_hex(&base, a, strlen(a)) == -1) err = t_err("big_from_hex");
+    else if (big_from_hex(&acc, "1", 1) == -1) err = t_err("big_from_hex");
+    unsigned long bit = 1; /**< Current bit of the exponent. */
+    while (exp != 0 && bit <= exp / 2) bit <<= 1;
+    for (; exp != 0 && bit != 0 && err == 0; bit >>= 1) {
+        if (multiply_big(&temp, &acc, &acc, engine, thread_c) == -1) err = t_err("multiply_big");
+        t_big swap = acc;
+        acc = temp;
+        temp = swap;
+        if (err == 0 && (exp & bit) != 0) {
+            if (multiply_big(&temp, &acc, &base, engine, thread_c) == -1) err = t_err("multiply_big");
+            swap = acc;
+            acc = temp;
+            temp = swap;
+        }
+    }
+    if (err == 0 && big_to_hex(&pow_hex, &cap, &acc) == -1) err = t_err("big_to_hex");
+    if (err == 0 && (printf("%s\n", pow_hex) < 0 || fflush(stdout) == EOF)) err = t_err("printf");
+    big_free(&base);
+    big_free(&acc);
+    big_free(&temp);
+    if (pow_hex != NULL) free(pow_hex);
+    return err;
+}
+
 /**
  * @brief Performs a multiplication of two hexadecimal numbers.
  * @details Reads two numbers of any length as operands from <strong>stdin</strong> and outputs the product to
  * <strong>stdout</strong>.<br>
  * Generates child processes that recursively call this program to split up the calculation work.<br>
  * Child processes communicate with their parents by pipes.<br>
- * Takes no arguments.<br>
+ * With -b, it runs in batch mode instead and multiplies pairs of numbers until the end of the input with a pool of
+ * -t threads (defaults to the count of online processors).<br>
+ * With -e, the multiplication is computed by the given engine instead of the process tree (tree).<br>
+ * With -p, it reads a single number and raises it to the given power in-process (defaults to the karatsuba
+ * engine).<br>
  * If an error occurs it exits with <strong>EXIT_FAILURE</strong>.
  * @param argc Argument counter.
  * @param argv Argument vector.
@@ -262,21 +804,41 @@ static int multiply_recursively(char *a, char *b) {
  */
 int main(int argc, char **argv) {
     prog_name = argv[0];
-    if (argc > 1) usage();
+    t_opt opts = { 0, 0, 0, 0, 0, 0, E_TREE };
+    parse_args(&opts, argc, argv);
+    if (opts.bflag) {
+        if (multiply_batch(opts.thread_c, opts.engine) == -1) e_err("multiply_batch");
+        return EXIT_SUCCESS;
+    }
     char *a = NULL, *b = NULL; /**< Operands to be multiplied. */
+    if (opts.pflag) {
+        if (receive_rands(&a, NULL) < 0) {
+            free_rands(a, b);
+            e_err("receive_rands");
+        }
+        if (power_in_process(a, opts.exp, opts.engine, opts.thread_c) == -1) {
+            free_rands(a, b);
+            e_err("power_in_process");
+        }
+        free_rands(a, b);
+        return EXIT_SUCCESS;
+    }
     if (receive_rands(&a, &b) < 0) {
         free_rands(a, b);
         e_err("receive_rands");
     }
-    if (strlen(a) == 1) {
-        char *prod_hex;
-        if (multiply(&prod_hex, a, b) == -1) {
-            free(prod_hex);
+    if (opts.engine != E_TREE) {
+        if (multiply_in_process(a, b, opts.engine, opts.thread_c) == -1) {
+            free_rands(a, b);
+            e_err("multiply_in_process");
+        }
+    } else if (strlen(a) == 1 && strlen(b) == 1) {
+        char prod_hex[3]; /**< Product of two digits. */
+        if (multiply(prod_hex, a, b) == -1) {
             free_rands(a, b);
             e_err("multiply");
         } else {
             printf("%s\n", prod_hex);
-            free(prod_hex);
             fflush(stdout);
         };
     } else if (multiply_recursively(a, b) == -1) {
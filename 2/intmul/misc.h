@@ -9,7 +9,7 @@
 
 #define HEX_B 16 /**< Base of hexadecimal numbers. */
 
-char *prog_name; /**> The programs name. */
+extern char *prog_name; /**> The programs name. */
 
 /**
  * @brief Logs an error.
@@ -0,0 +1,178 @@
+/**
+ * NTT module.
+ * @brief Implementation of the NTT module definitions.
+ * @file ntt.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "ntt.h"
+#include "misc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define NTT_P 0xffffffff00000001ULL /**< Prime of the field, 2^64 - 2^32 + 1. */
+#define NTT_E 0xffffffffULL /**< 2^64 mod p, 2^32 - 1. */
+#define NTT_G 7 /**< Generator of the multiplicative group of the field. */
+#define NTT_MAX_LOG 32 /**< Logarithm of the maximal transform length. */
+#define COEF_BITS 16 /**< Bits per coefficient. */
+
+__extension__ typedef unsigned __int128 t_u128; /**< 128 bit integer for products of field elements. */
+
+/**
+ * @brief Adds two field elements.
+ * @param a First summand.
+ * @param b Second summand.
+ * @return Sum modulo p.
+ */
+static uint64_t f_add(uint64_t a, uint64_t b) {
+    uint64_t s = a + b;
+    if (s < a) s += NTT_E;
+    if (s >= NTT_P) s -= NTT_P;
+    return s;
+}
+
+/**
+ * @brief Subtracts two field elements.
+ * @param a Minuend.
+ * @param b Subtrahend.
+ * @return Difference modulo p.
+ */
+static uint64_t f_sub(uint64_t a, uint64_t b) {
+    uint64_t d = a - b;
+    if (a < b) d += NTT_P;
+    return d;
+}
+
+/**
+ * @brief Multiplies two field elements.
+ * @details Reduces the 128 bit product without division, using 2^64 = 2^32 - 1 and 2^96 = -1 (mod p).
+ * @param a First factor.
+ * @param b Second factor.
+ * @return Product modulo p.
+ */
+static uint64_t f_mul(uint64_t a, uint64_t b) {
+    t_u128 x = (t_u128) a * b;
+    uint64_t lo = (uint64_t) x;
+    uint64_t hi = (uint64_t) (x >> 64);
+    uint64_t hi_hi = hi >> 32;
+    uint64_t hi_lo = hi & NTT_E;
+    uint64_t t = lo - hi_hi;
+    if (lo < hi_hi) t -= NTT_E;
+    uint64_t u = hi_lo * NTT_E;
+    uint64_t r = t + u;
+    if (r < u) r += NTT_E;
+    if (r >= NTT_P) r -= NTT_P;
+    return r;
+}
+
+/**
+ * @brief Raises a field element to a power.
+ * @param x Base.
+ * @param k Exponent.
+ * @return x^k modulo p.
+ */
+static uint64_t f_pow(uint64_t x, uint64_t k) {
+    uint64_t r = 1;
+    while (k > 0) {
+        if (k & 1) r = f_mul(r, x);
+        x = f_mul(x, x);
+        k >>= 1;
+    }
+    return r;
+}
+
+/**
+ * @brief Transforms coefficients in place.
+ * @details Iterative radix-2 transform with bit reversed input order.
+ * @param x Coefficients to be transformed.
+ * @param log_n Logarithm of the count of coefficients.
+ * @param inverse Whether the inverse transform should be computed (incl. the division by n).
+ * @param roots Scratch space for the roots of unity of a stage, must have half the count of coefficients.
+ */
+static void transform(uint64_t *x, int log_n, bool inverse, uint64_t *roots) {
+    size_t n = (size_t) 1 << log_n;
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            uint64_t temp = x[i];
+            x[i] = x[j];
+            x[j] = temp;
+        }
+    }
+    for (int s = 1; s <= log_n; s++) {
+        size_t len = (size_t) 1 << s;
+        uint64_t w_len = f_pow(NTT_G, (NTT_P - 1) >> s); /**< Primitive root of unity of order len. */
+        if (inverse) w_len = f_pow(w_len, NTT_P - 2);
+        roots[0] = 1;
+        for (size_t j = 1; j < len / 2; j++) roots[j] = f_mul(roots[j - 1], w_len);
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < len / 2; j++) {
+                uint64_t u = x[i + j];
+                uint64_t v = f_mul(x[i + j + len / 2], roots[j]);
+                x[i + j] = f_add(u, v);
+                x[i + j + len / 2] = f_sub(u, v);
+            }
+        }
+    }
+    if (inverse) {
+        uint64_t n_inv = f_pow(n, NTT_P - 2);
+        for (size_t i = 0; i < n; i++) x[i] = f_mul(x[i], n_inv);
+    }
+}
+
+/**
+ * @brief Splits the limbs of a big number into coefficients.
+ * @param dst Coefficients to be updated, must have 2 * x->n elements.
+ * @param x Big number.
+ */
+static void to_coefs(uint64_t *dst, const t_big *x) {
+    for (size_t i = 0; i < x->n; i++) {
+        dst[2 * i] = x->d[i] & 0xffff;
+        dst[2 * i + 1] = x->d[i] >> COEF_BITS;
+    }
+}
+
+int big_mul_ntt(t_big *dst, const t_big *a, const t_big *b) {
+    if (a->n == 0 || b->n == 0) {
+        dst->n = 0;
+        return 0;
+    }
+    size_t coef_c = 2 * (a->n + b->n); /**< Count of coefficients of the product. */
+    int log_n = 0;
+    while (((size_t) 1 << log_n) < coef_c) log_n++;
+    if (log_n > NTT_MAX_LOG) return m_err("Operands too long for the NTT");
+    size_t n = (size_t) 1 << log_n;
+    uint64_t *fa = (uint64_t *) calloc(2 * n + n / 2, sizeof(uint64_t));
+    if (fa == NULL) return t_err("calloc");
+    uint64_t *fb = fa + n;
+    uint64_t *roots = fb + n;
+    to_coefs(fa, a);
+    transform(fa, log_n, false, roots);
+    if (big_equal(a, b)) {
+        for (size_t i = 0; i < n; i++) fa[i] = f_mul(fa[i], fa[i]);
+    } else {
+        to_coefs(fb, b);
+        transform(fb, log_n, false, roots);
+        for (size_t i = 0; i < n; i++) fa[i] = f_mul(fa[i], fb[i]);
+    }
+    transform(fa, log_n, true, roots);
+    if (big_reserve(dst, a->n + b->n) == -1) {
+        free(fa);
+        return t_err("big_reserve");
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a->n + b->n; i++) {
+        uint64_t lo = fa[2 * i] + carry;
+        uint64_t hi = fa[2 * i + 1] + (lo >> COEF_BITS);
+        dst->d[i] = (uint32_t) ((lo & 0xffff) | ((hi & 0xffff) << COEF_BITS));
+        carry = hi >> COEF_BITS;
+    }
+    free(fa);
+    dst->n = a->n + b->n;
+    while (dst->n > 0 && dst->d[dst->n - 1] == 0) dst->n--;
+    return 0;
+}
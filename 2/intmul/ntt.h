@@ -0,0 +1,24 @@
+/**
+ * NTT module definitions.
+ * @brief Covers multiplication of big numbers with the number theoretic transform.
+ * @details The number theoretic transform (NTT) is a fast Fourier transform over the prime field
+ * p = 2^64 - 2^32 + 1, so the convolution of both operands is computed exactly in O(n log n).
+ * @file ntt.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "big.h"
+
+/**
+ * @brief Multiplies two big numbers with the number theoretic transform.
+ * @details Splits both operands into 16 bit coefficients, transforms them, multiplies them point-wise and transforms
+ * the result back. Carries of the coefficients are propagated afterwards.<br>
+ * If both operands are equal, only one forward transform is needed.<br>
+ * <strong>dst</strong> must not be the same number as <strong>a</strong> or <strong>b</strong>.
+ * @param dst Big number to be updated with the product.
+ * @param a First operand.
+ * @param b Second operand.
+ * @return 0 on success, -1 on error.
+ */
+int big_mul_ntt(t_big *dst, const t_big *a, const t_big *b);
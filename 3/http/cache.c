@@ -0,0 +1,332 @@
+/**
+ * Cache module.
+ * @brief Implementation of the cache module definitions.
+ * @file cache.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "cache.h"
+#include "misc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+
+#define PATH_EXTRA 48 /**< Room for a suffix, a process id and an entry number behind the base path of an entry. */
+#define COPY_SIZE 65536 /**< Size of the buffer for copying without sendfile(). */
+
+static unsigned long entry_c; /**< Count of entries opened by this process. */
+
+/**
+ * @brief Builds a path of an entry.
+ * @details Temporary paths contain the process id and the number of the entry, so entries of the same url (e.g. an
+ * url that is requested twice) never share a temporary file.
+ * @param entry Entry.
+ * @param buf Buffer for the path, at least PATH_EXTRA bytes longer than the base path.
+ * @param suffix Suffix of the path.
+ * @param tmp Whether the path is a temporary one of this entry.
+ */
+static void entry_path(const t_entry *entry, char *buf, const char *suffix, bool tmp) {
+    if (tmp) sprintf(buf, "%s%s.%d.%lu.tmp", entry->base, suffix, (int) getpid(), entry->tmp_id);
+    else sprintf(buf, "%s%s", entry->base, suffix);
+}
+
+/**
+ * @brief Returns the modification time of a file in nanoseconds.
+ * @param st Status of the file.
+ * @return Modification time.
+ */
+static long long mtime_ns(const struct stat *st) {
+    return (long long) st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+}
+
+/**
+ * @brief Checks whether the stored body of an entry is the one its metadata describes.
+ * @details Compares the length, inode and modification time, which change if the body is written through a link.
+ * @param entry Entry.
+ * @param path Path of the stored body.
+ * @return true if the body matches, false otherwise.
+ */
+static bool body_valid(const t_entry *entry, const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && (unsigned long long) st.st_size == entry->length &&
+        (unsigned long long) st.st_ino == entry->inode && mtime_ns(&st) == entry->mtime;
+}
+
+/**
+ * @brief Replaces a string of an entry.
+ * @param dst Pointer to the string, which is freed.
+ * @param src New string, NULL to clear it.
+ * @param len Length of the new string.
+ * @return 0 on success, -1 on error.
+ */
+static int set_str(char **dst, const char *src, size_t len) {
+    free(*dst);
+    *dst = NULL;
+    if (src != NULL && (*dst = strndup(src, len)) == NULL) return t_err("strndup");
+    return 0;
+}
+
+/**
+ * @brief Reads the metadata of an entry.
+ * @param entry Entry to be updated.
+ * @return 0 if the metadata belongs to the url of the entry, -1 otherwise.
+ */
+static int read_meta(t_entry *entry) {
+    char path[strlen(entry->base) + PATH_EXTRA];
+    entry_path(entry, path, CACHE_META_SUFFIX, false);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return -1;
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t n;
+    int res = -1;
+    while ((n = getline(&line, &cap, fp)) != -1) {
+        if (n > 0 && line[n - 1] == '\n') line[--n] = '\0';
+        char *value = strchr(line, ' ');
+        if (value == NULL) continue;
+        *value++ = '\0';
+        if (strcmp(line, "url") == 0) res = (strcmp(value, entry->url) == 0) ? 0 : -1;
+        else if (strcmp(line, "etag") == 0) set_str(&entry->etag, value, strlen(value));
+        else if (strcmp(line, "last-modified") == 0) set_str(&entry->last_modified, value, strlen(value));
+        else if (strcmp(line, "cache-control") == 0) set_str(&entry->cache_control, value, strlen(value));
+        else if (strcmp(line, "expires") == 0) entry->expires = (time_t) strtoll(value, NULL, 10);
+        else if (strcmp(line, "length") == 0) entry->length = strtoull(value, NULL, 10);
+        else if (strcmp(line, "inode") == 0) entry->inode = strtoull(value, NULL, 10);
+        else if (strcmp(line, "mtime") == 0) entry->mtime = strtoll(value, NULL, 10);
+    }
+    free(line);
+    fclose(fp);
+    return res;
+}
+
+/**
+ * @brief Writes the metadata of an entry.
+ * @param entry Entry.
+ * @return 0 on success, -1 on error.
+ */
+static int write_meta(const t_entry *entry) {
+    char path[strlen(entry->base) + PATH_EXTRA];
+    char tmp[strlen(entry->base) + PATH_EXTRA];
+    entry_path(entry, path, CACHE_META_SUFFIX, false);
+    entry_path(entry, tmp, CACHE_META_SUFFIX, true);
+    FILE *fp = fopen(tmp, "w");
+    if (fp == NULL) return t_err("fopen");
+    fprintf(fp, "url %s\n", entry->url);
+    if (entry->etag != NULL) fprintf(fp, "etag %s\n", entry->etag);
+    if (entry->last_modified != NULL) fprintf(fp, "last-modified %s\n", entry->last_modified);
+    if (entry->cache_control != NULL) fprintf(fp, "cache-control %s\n", entry->cache_control);
+    fprintf(fp, "expires %lld\nlength %llu\n", (long long) entry->expires, entry->length);
+    fprintf(fp, "inode %llu\nmtime %lld\n", entry->inode, entry->mtime);
+    if (fclose(fp) == EOF || rename(tmp, path) == -1) {
+        unlink(tmp);
+        return t_err("write_meta");
+    }
+    return 0;
+}
+
+/**
+ * @brief Computes until when the stored body is fresh.
+ * @details Only max-age of the Cache-Control is used, no-cache and a missing max-age need revalidation every time.
+ * @param entry Entry to be updated.
+ */
+static void update_expiry(t_entry *entry) {
+    entry->expires = 0;
+    const char *cc = entry->cache_control;
+    if (cc == NULL) return;
+    long long max_age = -1;
+    while (*cc != '\0') {
+        cc += strspn(cc, " \t,");
+        size_t len = strcspn(cc, ",");
+        if (len >= 8 && strncasecmp(cc, "max-age=", 8) == 0 && max_age != -2) max_age = strtoll(cc + 8, NULL, 10);
+        else if (len >= 8 && strncasecmp(cc, "no-cache", 8) == 0) max_age = -2;
+        cc += len;
+    }
+    if (max_age > 0) entry->expires = time(NULL) + max_age;
+}
+
+/**
+ * @brief Copies a file to a file descriptor at its current offset.
+ * @details Uses sendfile(), which works for any output since Linux 2.6.33, and falls back to read() and write() for
+ * outputs that do not support it (e.g. files opened for appending).
+ * @param src Source file.
+ * @param dst Destination file descriptor.
+ * @return 0 on success, -1 on error.
+ */
+static int copy_fd(int src, int dst) {
+    ssize_t n;
+    bool copied = false;
+    while ((n = sendfile(dst, src, NULL, 1 << 30)) > 0) copied = true;
+    if (n == 0) return 0;
+    if (copied || (errno != EINVAL && errno != ENOSYS)) return t_err("sendfile");
+    char buf[COPY_SIZE];
+    while ((n = read(src, buf, sizeof(buf))) > 0) {
+        for (ssize_t done = 0; done < n;) {
+            ssize_t m = write(dst, buf + done, n - done);
+            if (m == -1 && errno == EINTR) continue;
+            if (m == -1) return t_err("write");
+            done += m;
+        }
+    }
+    return (n == 0) ? 0 : t_err("read");
+}
+
+int cache_open(t_entry *entry, const char *dir, const char *url) {
+    memset(entry, 0, sizeof(t_entry));
+    entry->tmp_fd = -1;
+    entry->tmp_id = entry_c++;
+    entry->url = strdup(url);
+    if (entry->url == NULL) return t_err("strdup");
+    unsigned long long hash = 14695981039346656037ULL;
+    for (const char *c = url; *c != '\0'; c++) hash = (hash ^ (unsigned char) *c) * 1099511628211ULL;
+    size_t len = strlen(dir) + 18;
+    entry->base = (char *) malloc(len);
+    if (entry->base == NULL) return t_err("malloc");
+    snprintf(entry->base, len, "%s/%016llx", dir, hash);
+    if (read_meta(entry) == 0) {
+        char path[strlen(entry->base) + PATH_EXTRA];
+        entry_path(entry, path, CACHE_BODY_SUFFIX, false);
+        entry->found = body_valid(entry, path);
+    }
+    if (!entry->found) {
+        set_str(&entry->etag, NULL, 0);
+        set_str(&entry->last_modified, NULL, 0);
+        set_str(&entry->cache_control, NULL, 0);
+    }
+    return 0;
+}
+
+bool cache_fresh(const t_entry *entry) {
+    return entry->found && time(NULL) < entry->expires;
+}
+
+int cache_fields(const t_entry *entry, char *buf, size_t size) {
+    const char *etag = (entry->found && entry->etag != NULL) ? entry->etag : NULL;
+    const char *date = (entry->found && entry->last_modified != NULL) ? entry->last_modified : NULL;
+    return snprintf(buf, size, "%s%s%s%s%s%s", etag ? "If-None-Match: " : "", etag ? etag : "", etag ? "\r\n" : "",
+        date ? "If-Modified-Since: " : "", date ? date : "", date ? "\r\n" : "");
+}
+
+int cache_update(t_entry *entry, const t_resp *resp, const char *block) {
+    const char *names[] = { "ETag", "Last-Modified", "Cache-Control" };
+    char **fields[] = { &entry->etag, &entry->last_modified, &entry->cache_control };
+    for (int i = 0; i < 3; i++) {
+        size_t len;
+        const char *value = http_header(resp, block, names[i], &len);
+        if ((value != NULL || resp->status == 200) && set_str(fields[i], value, len) == -1) return -1;
+    }
+    entry->store = resp->status == 200 && !http_header_has(resp, block, "Cache-Control", "no-store");
+    update_expiry(entry);
+    return 0;
+}
+
+int cache_begin(t_entry *entry) {
+    char tmp[strlen(entry->base) + PATH_EXTRA];
+    entry_path(entry, tmp, CACHE_BODY_SUFFIX, true);
+    entry->tmp_fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (entry->tmp_fd == -1) return t_err("open");
+    return 0;
+}
+
+int cache_write(t_entry *entry, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(entry->tmp_fd, buf, len);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) return t_err("write");
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int cache_commit(t_entry *entry, const char *path) {
+    char body[strlen(entry->base) + PATH_EXTRA];
+    char meta[strlen(entry->base) + PATH_EXTRA];
+    char tmp[strlen(entry->base) + PATH_EXTRA];
+    entry_path(entry, body, CACHE_BODY_SUFFIX, false);
+    entry_path(entry, meta, CACHE_META_SUFFIX, false);
+    entry_path(entry, tmp, CACHE_BODY_SUFFIX, true);
+    if (entry->tmp_fd != -1) {
+        close(entry->tmp_fd);
+        entry->tmp_fd = -1;
+    } else if (path == NULL) {
+        return -1;
+    } else {
+        unlink(tmp);
+        if (link(path, tmp) == -1) return t_err("link");
+    }
+    struct stat st;
+    if (stat(tmp, &st) == -1 || (unlink(meta) == -1 && errno != ENOENT) || rename(tmp, body) == -1) {
+        unlink(tmp);
+        return t_err("cache_commit");
+    }
+    entry->length = st.st_size;
+    entry->inode = st.st_ino;
+    entry->mtime = mtime_ns(&st);
+    entry->found = true;
+    return write_meta(entry);
+}
+
+int cache_touch(t_entry *entry) {
+    return write_meta(entry);
+}
+
+void cache_abort(t_entry *entry) {
+    if (entry->tmp_fd == -1) return;
+    close(entry->tmp_fd);
+    entry->tmp_fd = -1;
+    char tmp[strlen(entry->base) + PATH_EXTRA];
+    entry_path(entry, tmp, CACHE_BODY_SUFFIX, true);
+    unlink(tmp);
+}
+
+int cache_link(const t_entry *entry, const char *path) {
+    char body[strlen(entry->base) + PATH_EXTRA];
+    entry_path(entry, body, CACHE_BODY_SUFFIX, false);
+    if (!body_valid(entry, body)) return m_err("Cached body was changed");
+    if (unlink(path) == -1 && errno != ENOENT) return t_err("unlink");
+    if (link(body, path) == 0) return 0;
+    int src = open(body, O_RDONLY | O_CLOEXEC);
+    if (src == -1) return t_err("open");
+    int dst = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (dst == -1) {
+        close(src);
+        return t_err("open");
+    }
+    int res = 0;
+#ifdef FICLONE
+    if (ioctl(dst, FICLONE, src) == -1)
+#endif
+        res = copy_fd(src, dst);
+    close(src);
+    close(dst);
+    return res;
+}
+
+int cache_copy(const t_entry *entry, int fd) {
+    char body[strlen(entry->base) + PATH_EXTRA];
+    entry_path(entry, body, CACHE_BODY_SUFFIX, false);
+    if (!body_valid(entry, body)) return m_err("Cached body was changed");
+    int src = open(body, O_RDONLY | O_CLOEXEC);
+    if (src == -1) return t_err("open");
+    int res = copy_fd(src, fd);
+    close(src);
+    return res;
+}
+
+void cache_free(t_entry *entry) {
+    cache_abort(entry);
+    free(entry->url);
+    free(entry->base);
+    free(entry->etag);
+    free(entry->last_modified);
+    free(entry->cache_control);
+}
@@ -0,0 +1,142 @@
+/**
+ * Cache module definitions.
+ * @brief Covers a local on-disk cache of response bodies.
+ * @details Every cached url has two files in the cache directory, named after a hash of the url: the body and a small
+ * text file with the url, the validators (ETag, Last-Modified), the Cache-Control of the response and the length,
+ * inode and modification time of the body. Both are written under temporary names that are unique per entry and
+ * renamed, so a partial entry is never visible.<br>
+ * Stored entries are fresh for the max-age of their Cache-Control and are revalidated with a conditional request
+ * afterwards. A 304 response means that the stored body is still current. Bodies are hard-linked (or reflinked) into
+ * output files where possible, so serving them copies nothing.
+ * @file cache.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "http.h"
+#include <time.h>
+
+#define CACHE_BODY_SUFFIX ".body" /**< Suffix of the stored body of an entry. */
+#define CACHE_META_SUFFIX ".meta" /**< Suffix of the metadata of an entry. */
+
+/**
+ * @brief Cache entry of an url.
+ */
+typedef struct Entry {
+    char *url; /**< Url the entry is stored for. */
+    char *base; /**< Path of the entry in the cache directory, without suffix. */
+    bool found; /**< Whether a complete entry is stored. */
+    bool store; /**< Whether the current response may be stored. */
+    char *etag; /**< ETag of the body, NULL if there is none. */
+    char *last_modified; /**< Last-Modified of the body, NULL if there is none. */
+    char *cache_control; /**< Cache-Control of the body, NULL if there is none. */
+    time_t expires; /**< Time until which the stored body is used without revalidation. */
+    unsigned long long length; /**< Length of the stored body. */
+    unsigned long long inode; /**< Inode of the stored body. */
+    long long mtime; /**< Modification time of the stored body in nanoseconds. */
+    unsigned long tmp_id; /**< Number of the entry in this process, which makes its temporary names unique. */
+    int tmp_fd; /**< Temporary file the body of the current response is written to, -1 if not opened. */
+} t_entry;
+
+/**
+ * @brief Looks up the entry of an url.
+ * @details The entry is found if its metadata belongs to the url and the stored body has the recorded length, inode
+ * and modification time (so a body that was changed through a link is not used).<br>
+ * Must be released with cache_free().
+ * @param entry Entry to be initialized.
+ * @param dir Cache directory.
+ * @param url Url.
+ * @return 0 on success (also if nothing is stored), -1 on error.
+ */
+int cache_open(t_entry *entry, const char *dir, const char *url);
+
+/**
+ * @brief Checks whether the stored body can be used without revalidation.
+ * @param entry Entry.
+ * @return true if the entry is found and fresh, false otherwise.
+ */
+bool cache_fresh(const t_entry *entry);
+
+/**
+ * @brief Builds the header lines of a conditional request for the stored body.
+ * @details Formats If-None-Match and If-Modified-Since like snprintf().
+ * @param entry Entry.
+ * @param buf Buffer for the header lines, each terminated by CRLF.
+ * @param size Size of the buffer.
+ * @return Length of the header lines (without the terminating null byte).
+ */
+int cache_fields(const t_entry *entry, char *buf, size_t size);
+
+/**
+ * @brief Takes the validators and freshness of a response with status 200 or 304.
+ * @details A 304 response only replaces what it sends. Responses with Cache-Control no-store are not stored.
+ * @param entry Entry to be updated.
+ * @param resp Response parser.
+ * @param block Header block.
+ * @return 0 on success, -1 on error.
+ */
+int cache_update(t_entry *entry, const t_resp *resp, const char *block);
+
+/**
+ * @brief Opens a temporary file for the body of the current response.
+ * @param entry Entry to be updated.
+ * @return 0 on success, -1 on error.
+ */
+int cache_begin(t_entry *entry);
+
+/**
+ * @brief Writes body bytes of the current response to the temporary file.
+ * @param entry Entry.
+ * @param buf Body bytes.
+ * @param len Count of bytes.
+ * @return 0 on success, -1 on error.
+ */
+int cache_write(t_entry *entry, const char *buf, size_t len);
+
+/**
+ * @brief Stores the body of the current response with its metadata.
+ * @details The body is either the temporary file or an output file, which is hard-linked into the cache.
+ * @param entry Entry to be updated.
+ * @param path Output file with the body, NULL if the temporary file is used.
+ * @return 0 on success, -1 on error.
+ */
+int cache_commit(t_entry *entry, const char *path);
+
+/**
+ * @brief Stores the metadata of an entry again after it was revalidated.
+ * @param entry Entry.
+ * @return 0 on success, -1 on error.
+ */
+int cache_touch(t_entry *entry);
+
+/**
+ * @brief Discards the body of the current response.
+ * @param entry Entry to be updated.
+ */
+void cache_abort(t_entry *entry);
+
+/**
+ * @brief Places the stored body at a path.
+ * @details Replaces the file at the path with a hard link to the stored body. Falls back to a reflink and then a
+ * copy, e.g. if the path is on another file system. The client never writes into an output file with more than one
+ * link, so the stored body is not changed through the link.
+ * @param entry Entry.
+ * @param path Path of the output file.
+ * @return 0 on success, -1 on error or if the stored body no longer matches the metadata.
+ */
+int cache_link(const t_entry *entry, const char *path);
+
+/**
+ * @brief Copies the stored body to a file descriptor at its current offset.
+ * @param entry Entry.
+ * @param fd File descriptor.
+ * @return 0 on success, -1 on error or if the stored body no longer matches the metadata.
+ */
+int cache_copy(const t_entry *entry, int fd);
+
+/**
+ * @brief Releases an entry.
+ * @details Discards the body of an uncommitted response.
+ * @param entry Entry to be released.
+ */
+void cache_free(t_entry *entry);
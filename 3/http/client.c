@@ -1,26 +1,35 @@
 /**
  * Client module.
  * @brief Main entry point for the http client.
- * @details Implements a client for the HTTP protocol (version 1.1) for sending a GET request.<br>
- * Establishes a TCP / IP socket connection to a server to requests a resource.<br>
- * Output is written to a specified file or stdout.
+ * @details Implements a client for the HTTP protocol (version 1.1) for sending GET requests.<br>
+ * Establishes TCP / IP socket connections to servers to request resources. All requests are driven by one
+ * non-blocking event loop (see engine.h), connections are kept alive and reused for further requests to the same
+ * host.<br>
+ * Large resources can be downloaded in parts over several connections at once (ranged mode), and interrupted
+ * downloads to files can be resumed (resume mode, see engine.h). Responses can be kept in a local cache directory
+ * and are then revalidated instead of downloaded again. Compressed bodies can be requested, they are decoded while
+ * they arrive. The timing of every request can be reported on stderr. Files in a directory can be written with
+ * io_uring and O_DIRECT (direct mode, see engine.h).<br>
+ * Output is written to a specified file, a directory or stdout.<br>
+ * In batch mode, the url list is read while the downloads run, with only a window of urls in memory, and a manifest
+ * line is written for every url in the order of the list.
  * @file client.c
  * @author Tobias Gruber, 11912367
  * @date 25.12.2022
  **/
 
+#include "engine.h"
 #include "misc.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
-#include <sys/socket.h>
-#include <netdb.h>
+#include <fcntl.h>
 #include <errno.h>
+#include <sys/stat.h>
 
-#define HTTP_PREFIX "http://" /**< Http protocol prefix for urls. */
-#define DEFAULT_FILE "index.html" /**< Default file for http requests. */
-#define BUF_SIZE 1024 /**< Size of buffers for socket streams. */
+#define DEFAULT_HOST_LIMIT 4 /**< Default maximum count of connections per host. */
+#define DEFAULT_WINDOW 1024 /**< Default maximum count of urls in memory in batch mode. */
 
 /**
  * @brief Program options.
@@ -30,111 +39,94 @@ typedef struct Options {
     int pflag; /**< Count of passed -p flags (from the arguments). */
     int oflag; /**< Count of passed -o flags (from the arguments). */
     int dflag; /**< Count of passed -d flags (from the arguments). */
-    char *server_host; /**< Host name of the server. */
-    char *server_path; /**< Path to resource on the server. */
-    char *server_args; /**< Request arguments passed to the server. */
-    char *server_port; /**< Port name of the server. */
-    FILE *output; /**< File pointer for the output. */
+    int iflag; /**< Count of passed -i flags (from the arguments). */
+    int cflag; /**< Count of passed -c flags (from the arguments). */
+    int Pflag; /**< Count of passed -P flags (from the arguments). */
+    int jflag; /**< Count of passed -j flags (from the arguments). */
+    int rflag; /**< Count of passed -r flags (from the arguments). */
+    int Cflag; /**< Count of passed -C flags (from the arguments). */
+    int zflag; /**< Count of passed -z flags (from the arguments). */
+    int tflag; /**< Count of passed -t flags (from the arguments). */
+    int mflag; /**< Count of passed -m flags (from the arguments). */
+    int wflag; /**< Count of passed -w flags (from the arguments). */
+    int Dflag; /**< Count of passed -D flags (from the arguments). */
+    char *server_port; /**< Port name of the servers. */
+    char *output_path; /**< Path to the output file or directory. */
+    char *list_path; /**< Path to a file with one url per line. */
+    char *cache_dir; /**< Path to the cache directory. */
+    char *manifest_path; /**< Path to the manifest in batch mode. */
+    int host_limit; /**< Maximum count of connections per host. */
+    int pipe_depth; /**< Maximum count of pipelined requests per connection. */
+    int range_parts; /**< Maximum count of parts per resource. */
+    t_mformat timing; /**< Format of the timing report. */
+    int window; /**< Maximum count of urls in memory in batch mode. */
+    int output; /**< File descriptor of the output (if not written to a directory). */
 } t_opt;
 
+/**
+ * @brief State of batch mode.
+ * @details Urls are read from the list one at a time, complete urls are written to the manifest.
+ */
+typedef struct Feed {
+    FILE *list; /**< Url list. */
+    char *line; /**< Current line of the url list. */
+    size_t line_cap; /**< Capacity of the current line. */
+    int err; /**< -1 if reading the url list failed, 0 otherwise. */
+    FILE *manifest; /**< Manifest. */
+    int status; /**< Exit status of the first failed url, 0 if none failed. */
+} t_feed;
+
+char *prog_name;
+
 /**
  * @brief Prints the usage of the program to stderr and exists with an error.
  * @details Exits the program with EXIT_FAILURE.<br>
  * Used global variables: prog_name
  */
 static void usage(void) {
-    fprintf(stderr, "Usage: %s [-p PORT] [ -o FILE | -d DIR ] URL\n", prog_name);
+    fprintf(stderr, "Usage: %s [-p PORT] [ -o FILE | -d DIR [-D] ] [-c CONNS] [-P DEPTH] [-j PARTS] [-r] [-C CACHE] "
+        "[-z] [-t text|json] [-i LIST] [URL...]\n"
+        "       %s [-p PORT] -d DIR [-D] [-c CONNS] [-P DEPTH] [-j PARTS] [-r] [-C CACHE] [-z] [-t text|json] "
+        "-m MANIFEST [-w WINDOW] -i LIST\n", prog_name, prog_name);
     exit(EXIT_FAILURE);
 }
 
 /**
- * @brief Parses details from an url.
- * @details Validates and parses important components of an url, such as protocol, host, resource path and arguments.
- * @param opts Program options.
- * @param url_with_protocol Url including the protocol prefix.
- * @return 0 on success or if valid, -1 on error or if invalid.
- */
-static int parse_url_details(t_opt *opts, char *url_with_protocol) {
-    if (strncmp(url_with_protocol, HTTP_PREFIX, strlen(HTTP_PREFIX)) != 0) {
-        errno = EINVAL;
-        return m_err("Invalid protocol");
-    }
-    opts->server_host = url_with_protocol + strlen(HTTP_PREFIX);
-    if (
-        strlen(opts->server_host) == 0 ||
-        strncmp(opts->server_host, "/", 1) == 0 ||
-        strncmp(opts->server_host, "?", 1) == 0
-    ) {
-        errno = EINVAL;
-        return m_err("Invalid hostname");
-    }
-    int len_before = strlen(opts->server_host);
-    opts->server_host = strtok(opts->server_host, "/");
-    if (len_before == strlen(opts->server_host)) {
-        opts->server_host = strtok(opts->server_host, "?");
-        opts->server_args = strtok(NULL, "");
-    } else {
-        char *temp = strtok(NULL, "");
-        if (temp != NULL) {
-            if (strncmp(temp, "?", 1) == 0) {
-                opts->server_args = strtok(temp, "?");
-            } else {
-                opts->server_path = strtok(temp, "?");
-                opts->server_args = strtok(NULL, "");
-            }
-        }
-    }
-    return 0;
-}
-
-/**
- * @brief Opens an output stream based on passed arguments.
- * @details If specified in program options, that the output should be printed to either a directory or a file,
- * a corresponding output stream is opened.<br>
- * If the output should be printed to a directory, the file depends on the resource that is requested (falls back to
- * index.html).<br>
- * Opens the output file that must be closed later.
- * @param opts Program options.
- * @param output Path to output file.
+ * @brief Opens the output file.
+ * @details A regular file with more than one link may be a hard link to a body stored in the cache, so it is replaced
+ * by a new file instead of being written through the link. In resume mode, its journal is removed with it, since it
+ * no longer describes the file.
+ * @param opts Pointer to program options, updated with the output file.
  * @return 0 on success, -1 on error.
  */
-static int open_out_fp(t_opt *opts, char *output) {
-    if (opts->oflag || opts->dflag) {
-        if (opts->dflag) {
-            char *file_name = DEFAULT_FILE;
-            if (opts->server_path != NULL) {
-                file_name = strrchr(opts->server_path, '/');
-                if (file_name == NULL) file_name = opts->server_path;
-                else if (strlen(++file_name) == 0) file_name = DEFAULT_FILE;
-            }
-            char *temp = output;
-            output = (char *) malloc(sizeof(char) * (strlen(output) + strlen(file_name) + 2));
-            if (output == NULL) return t_err("realloc");
-            strcpy(output, temp);
-            strcat(output, "/");
-            strcat(output, file_name);
+static int open_output(t_opt *opts) {
+    struct stat st;
+    if (lstat(opts->output_path, &st) == 0 && S_ISREG(st.st_mode) && st.st_nlink > 1) {
+        if (unlink(opts->output_path) == -1) return t_err("unlink");
+        if (opts->rflag) {
+            char journal[strlen(opts->output_path) + sizeof(ENGINE_JOURNAL_SUFFIX)];
+            sprintf(journal, "%s%s", opts->output_path, ENGINE_JOURNAL_SUFFIX);
+            if (unlink(journal) == -1 && errno != ENOENT) return t_err("unlink");
         }
-        opts->output = fopen(output, "w");
-        if (opts->dflag) free(output);
-        if (opts->output == NULL) return t_err("fopen");
     }
+    opts->output = open(opts->output_path, O_WRONLY | O_CREAT | (opts->rflag ? 0 : O_TRUNC) | O_CLOEXEC, 0666);
+    if (opts->output == -1) return t_err("open");
     return 0;
 }
 
 /**
  * @brief Parses the program arguments.
  * @details Reads and validates program options and arguments.<br>
- * Parses informations of the passed url and opens an output stream if necessary.<br>
- * Might exit the program with EXIT_FAILURE if arguments invalid.<br>
- * Opens the output file that must be closed later.
+ * Opens the output file if necessary, which must be closed later. Creates the cache directory if it is missing.<br>
+ * Might exit the program with EXIT_FAILURE if arguments invalid.
  * @param opts Pointer to program options.
  * @param argc Argument counter.
  * @param argv Argument vector.
  * @return 0 on success, -1 on error.
  * */
 static int parse_args(t_opt *opts, int argc, char** argv) {
-    char opt, *output_path;
-    while ((opt = getopt(argc, argv, "p:o:d:")) != -1) {
+    int opt;
+    while ((opt = getopt(argc, argv, "p:o:d:i:c:P:j:rC:zt:m:w:D")) != -1) {
         switch (opt) {
             case 'p':
                 opts->pflag++;
@@ -148,140 +140,180 @@ static int parse_args(t_opt *opts, int argc, char** argv) {
                 break;
             case 'o':
                 opts->oflag++;
-                output_path = optarg;
+                opts->output_path = optarg;
                 break;
             case 'd':
                 opts->dflag++;
-                output_path = optarg;
+                opts->output_path = optarg;
+                break;
+            case 'i':
+                opts->iflag++;
+                opts->list_path = optarg;
+                break;
+            case 'c':
+                opts->cflag++;
+                if (parse_int(&opts->host_limit, optarg) == -1) return t_err("parse_int");
+                if (opts->host_limit == 0) {
+                    errno = EINVAL;
+                    return m_err("Connection limit must be positive");
+                }
+                break;
+            case 'P':
+                opts->Pflag++;
+                if (parse_int(&opts->pipe_depth, optarg) == -1) return t_err("parse_int");
+                if (opts->pipe_depth == 0 || opts->pipe_depth > ENGINE_PIPE_MAX) {
+                    errno = EINVAL;
+                    return m_err("Pipeline depth out of range");
+                }
+                break;
+            case 'j':
+                opts->jflag++;
+                if (parse_int(&opts->range_parts, optarg) == -1) return t_err("parse_int");
+                if (opts->range_parts == 0 || opts->range_parts > ENGINE_PARTS_MAX) {
+                    errno = EINVAL;
+                    return m_err("Part count out of range");
+                }
+                break;
+            case 'r':
+                opts->rflag++;
+                break;
+            case 'C':
+                opts->Cflag++;
+                opts->cache_dir = optarg;
+                break;
+            case 'z':
+                opts->zflag++;
+                break;
+            case 't':
+                opts->tflag++;
+                if (metrics_format(&opts->timing, optarg) == -1) return t_err("metrics_format");
+                break;
+            case 'D':
+                opts->Dflag++;
+                break;
+            case 'm':
+                opts->mflag++;
+                opts->manifest_path = optarg;
+                break;
+            case 'w':
+                opts->wflag++;
+                if (parse_int(&opts->window, optarg) == -1) return t_err("parse_int");
+                if (opts->window == 0) {
+                    errno = EINVAL;
+                    return m_err("Window must be positive");
+                }
                 break;
             case '?':
             default: usage();
         }
     }
     if (
-        optind != argc - 1 ||
+        (optind == argc && opts->iflag == 0) ||
         opts->pflag > 1 ||
         opts->oflag > 1 ||
         opts->dflag > 1 ||
+        opts->iflag > 1 ||
+        opts->cflag > 1 ||
+        opts->Pflag > 1 ||
+        opts->jflag > 1 ||
+        opts->rflag > 1 ||
+        opts->Cflag > 1 ||
+        opts->zflag > 1 ||
+        opts->tflag > 1 ||
+        opts->mflag > 1 ||
+        opts->wflag > 1 ||
+        opts->Dflag > 1 ||
+        (opts->Dflag == 1 && opts->dflag == 0) ||
+        (opts->mflag == 1 && (opts->dflag == 0 || opts->iflag == 0 || optind < argc)) ||
+        (opts->wflag == 1 && opts->mflag == 0) ||
+        (opts->rflag == 1 && opts->oflag == 0 && opts->dflag == 0) ||
         (opts->oflag == 1 && opts->dflag == 1)
     ) usage();
-    if (parse_url_details(opts, argv[optind]) == -1) return t_err("parse_url_details");
-    if (open_out_fp(opts, output_path) == -1) return t_err("open_out_fp");
+    if (opts->oflag && open_output(opts) == -1) return t_err("open_output");
+    if (opts->Cflag && mkdir(opts->cache_dir, 0777) == -1 && errno != EEXIST) return t_err("mkdir");
+    if (opts->cflag == 0 && opts->host_limit < opts->range_parts) opts->host_limit = opts->range_parts;
     return 0;
 }
 
 /**
- * @brief Connects the client with the http server.
- * @details Requests ip addresses of the server and connects via sockets.<br>
- * Opens the socket file sockfile, must be closed later.
- * @param sockfile Pointer that should be updated with the socket file.
- * @param opts Program options.
+ * @brief Reads the urls of a list file.
+ * @details Every non-empty line of the file is an url, "-" reads the list from stdin.<br>
+ * Allocates the array of urls and each url, which must be freed later.
+ * @param urls Pointer to be updated with the array of urls.
+ * @param url_c Pointer to be updated with the count of urls.
+ * @param path Path to the list file.
  * @return 0 on success, -1 on error.
  */
-static int connect_server(FILE **sockfile, t_opt *opts) {
-    struct addrinfo hints, *ai;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
-    if (getaddrinfo(opts->server_host, opts->server_port, &hints, &ai) != 0) {
-        errno = EINVAL;
-        return t_err("getaddrinfo");
+static int read_url_list(char ***urls, size_t *url_c, char *path) {
+    FILE *fp = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (fp == NULL) return t_err("fopen");
+    size_t cap = 0;
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t n;
+    int err = 0;
+    while (err == 0 && (n = getline(&line, &len, fp)) != -1) {
+        while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r')) line[--n] = '\0';
+        if (n == 0) continue;
+        if (*url_c == cap) {
+            cap = (cap == 0) ? 16 : cap * 2;
+            char **temp = (char **) realloc(*urls, sizeof(char *) * cap);
+            if (temp == NULL) {
+                err = t_err("realloc");
+                break;
+            }
+            *urls = temp;
+        }
+        (*urls)[*url_c] = strdup(line);
+        if ((*urls)[*url_c] == NULL) err = t_err("strdup");
+        else (*url_c)++;
     }
-    int sockfd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
-    if (connect(sockfd, ai->ai_addr, ai->ai_addrlen) == -1) {
-        freeaddrinfo(ai);
-        return t_err("connect");
-    };
-    freeaddrinfo(ai);
-    *sockfile = fdopen(sockfd, "r+");
-    if (*sockfile == NULL) return t_err("fdopen");
-    return 0;
+    free(line);
+    if (fp != stdin) fclose(fp);
+    return err;
 }
 
 /**
- * @brief Sends an http request.
- * @details Sends a GET request to the server. Details are specified in the program options.<br>
- * Socket stream gets flushed after request is sent.
- * @param sockfile Pointer of the socket file.
- * @param opts Program options.
- * @return 0 on success, -1 on error.
+ * @brief Returns the next url of the list in batch mode.
+ * @details Empty lines are skipped.
+ * @param arg State of batch mode.
+ * @return Url (valid until the next call), NULL at the end of the list or on error.
  */
-static int send_request(FILE *sockfile, t_opt *opts) {
-    char resource[(opts->server_path ? strlen(opts->server_path) : 0) + (opts->server_args ? strlen(opts->server_args) : 0) + 3];
-    strcpy(resource, "/");
-    if (opts->server_path) strcat(resource, opts->server_path);
-    if (opts->server_args) {
-        strcat(resource, "?");
-        strcat(resource, opts->server_args);
+static char *next_url(void *arg) {
+    t_feed *feed = (t_feed *) arg;
+    ssize_t n;
+    while ((n = getline(&feed->line, &feed->line_cap, feed->list)) != -1) {
+        while (n > 0 && (feed->line[n - 1] == '\n' || feed->line[n - 1] == '\r')) feed->line[--n] = '\0';
+        if (n > 0) return feed->line;
     }
-    if (fprintf(
-        sockfile,
-        "GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: tuwien-osue-http/1.0\r\nConnection: close\r\n\r\n",
-        resource,
-        opts->server_host
-    ) < 0) return t_err("fprintf");
-    fflush(sockfile);
-    return 0;
+    if (ferror(feed->list)) feed->err = t_err("getline");
+    return NULL;
 }
 
 /**
- * @brief Validates and prints the response of the http request.
- * @details Validates if the response's protocol, status and if it is well-formed.<br>
- * If there is a response body, it is printed to the output stream.<br>
- * Header infos are parsed by getline() and the body is parsed by fread() to process any data (incl. binary).
- * @param sockfile Pointer of the socket file.
- * @param opts Program options.
- * @return 0 on success and a negative exit status on failure.
+ * @brief Writes the manifest line of a complete url in batch mode.
+ * @details The line has the tab separated fields url, status of the response (0 if there was none), length of the
+ * output file, milliseconds from the first request to completion and the result (ok, conn, protocol or status).
+ * @param arg State of batch mode.
+ * @param url Url as it was read from the list.
+ * @param job Complete job of the url.
  */
-static int print_response(FILE *sockfile, t_opt opts) {
-    bool is_content = false;
-    size_t len = 0, linec = 0;
-    char *line = NULL;
-    while (getline(&line, &len, sockfile) != -1) {
-        if (linec++ == 0) {
-            char *protocol = strtok(line, " ");
-            char *status = strtok(NULL, " ");
-            char *status_text = strtok(NULL, "");
-            if (
-                protocol == NULL || status == NULL || status_text == NULL ||
-                strcmp(protocol, "HTTP/1.1") != 0 ||
-                parse_int(NULL, status) == -1
-            ) {
-                fprintf(stderr, "Protocol error!\n");
-                free(line);
-                return -2;
-            }
-            if (strcmp(status, "200") != 0) {
-                fprintf(stderr, "%s %s", status, status_text);
-                free(line);
-                return -3;
-            }
-        } else if (strcmp(line, "\r\n") == 0) {
-            is_content = true;
-            break;
-        }
-    }
-    free(line);
-    if (linec == 0) {
-        fprintf(stderr, "Protocol error!");
-        return -2;
-    }
-    if (is_content) {
-        char buf[BUF_SIZE];
-        while (!feof(sockfile)) {
-            size_t n = fread(buf, 1, BUF_SIZE, sockfile);
-            fwrite(buf, 1, n, opts.output);
-        }
-    }
-    return 0;
+static void report_url(void *arg, const char *url, const t_job *job) {
+    t_feed *feed = (t_feed *) arg;
+    static const char *results[] = {"ok", "conn", "protocol", "status"};
+    double ms = (job->started != 0) ? (job->finished - job->started) / 1000.0 : 0;
+    fprintf(feed->manifest, "%s\t%d\t%llu\t%.3f\t%s\n", url, job->status, job->size, ms, results[-job->res]);
+    if (feed->status == 0) feed->status = -job->res;
 }
 
 /**
- * @brief Requests a resource from a given server.
- * @details Based on the passed arguments it: Connects to a server, requests a resource and prints it to a output
- * stream.<br>
- * The connection is established using sockets and the http protocol is being adhered to.<br>
- * Might exit with status code 1, 2 or 3 if errors occur.<br>
+ * @brief Requests resources from given servers.
+ * @details Based on the passed arguments it: Adds a job for every url and runs the engine, which connects to servers,
+ * requests resources and prints them to output streams.<br>
+ * Urls are passed as arguments or in a list file. In batch mode, the list is streamed into the engine and the
+ * manifest is written to a file or to stdout ("-").<br>
+ * Failed requests do not stop the others, the program exits with the status code (1, 2 or 3) of the first failed
+ * url.<br>
  * Global variables: prog_name
  * @param argc Argument counter.
  * @param argv Argument vector.
@@ -289,25 +321,54 @@ static int print_response(FILE *sockfile, t_opt opts) {
  */
 int main(int argc, char** argv) {
     prog_name = argv[0];
-    t_opt opts = { 0, 0, 0, NULL, NULL, NULL, "80", stdout };
+    t_opt opts = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, "80", NULL, NULL, NULL, NULL, DEFAULT_HOST_LIMIT, 1, 1, METRICS_OFF,
+        DEFAULT_WINDOW, STDOUT_FILENO
+    };
     if (parse_args(&opts, argc, argv) < 0) e_err("parse_args");
-    FILE *sockfile = NULL;
-    if (connect_server(&sockfile, &opts) == -1) {
-        if (opts.output != stdout) fclose(opts.output);
-        e_err("connect_server");
+    if (opts.tflag) setvbuf(stderr, NULL, _IOLBF, BUFSIZ);
+    char **urls = NULL;
+    size_t url_c = 0;
+    t_engine e;
+    int err = 0;
+    t_feed feed = {NULL, NULL, 0, 0, NULL, 0};
+    t_batch batch = {next_url, report_url, &feed, opts.window};
+    if (opts.mflag) {
+        feed.list = (strcmp(opts.list_path, "-") == 0) ? stdin : fopen(opts.list_path, "r");
+        if (feed.list == NULL) e_err("fopen");
+        feed.manifest = (strcmp(opts.manifest_path, "-") == 0) ? stdout : fopen(opts.manifest_path, "w");
+        if (feed.manifest == NULL) e_err("fopen");
+    }
+    t_config cfg = {
+        opts.server_port, opts.dflag ? opts.output_path : NULL, opts.oflag ? opts.output_path : NULL, opts.output,
+        opts.host_limit, opts.pipe_depth, opts.range_parts, opts.rflag == 1, opts.cache_dir,
+        opts.zflag == 1, opts.timing, opts.Dflag == 1, opts.mflag ? &batch : NULL
+    };
+    if (engine_init(&e, &cfg) == -1) err = t_err("engine_init");
+    if (err == 0 && opts.iflag && !opts.mflag && read_url_list(&urls, &url_c, opts.list_path) == -1) {
+        err = t_err("read_url_list");
+    }
+    if (err == 0 && opts.rflag && opts.oflag && argc - optind + url_c != 1) {
+        errno = EINVAL;
+        err = m_err("Resuming a file needs exactly one url");
     }
-    if (send_request(sockfile, &opts) == -1) {
-        fclose(sockfile);
-        if (opts.output != stdout) fclose(opts.output);
-        e_err("send_request");
+    for (int i = optind; err == 0 && i < argc + (int) url_c; i++) {
+        if (engine_add(&e, (i < argc) ? argv[i] : urls[i - argc]) == -1) err = t_err("engine_add");
     }
-    int res = print_response(sockfile, opts);
-    if (res < 0) {
-        fclose(sockfile);
-        if (opts.output != stdout) fclose(opts.output);
-        exit(abs(res));
+    if (err == 0 && engine_run(&e) == -1) err = t_err("engine_run");
+    if (err == 0 && feed.err == -1) err = m_err("Reading the url list failed");
+    int status = feed.status;
+    for (size_t i = 0; err == 0 && !opts.mflag && i < e.job_c && status == EXIT_SUCCESS; i++) status = -e.jobs[i].res;
+    engine_free(&e);
+    if (opts.mflag) {
+        free(feed.line);
+        if (feed.list != stdin) fclose(feed.list);
+        if (fflush(feed.manifest) == EOF || ferror(feed.manifest)) err = t_err("fflush");
+        if (feed.manifest != stdout) fclose(feed.manifest);
     }
-    fclose(sockfile);
-    if (opts.output != stdout) fclose(opts.output);
-    return EXIT_SUCCESS;
+    for (size_t i = 0; i < url_c; i++) free(urls[i]);
+    free(urls);
+    if (opts.output != STDOUT_FILENO) close(opts.output);
+    if (err == -1) e_err("main");
+    return status;
 }
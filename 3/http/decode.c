@@ -0,0 +1,83 @@
+/**
+ * Decode module.
+ * @brief Implementation of the decode module definitions.
+ * @file decode.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "decode.h"
+#include "misc.h"
+#include <string.h>
+
+#define GZIP_WBITS (MAX_WBITS + 16) /**< Window bits of zlib for the gzip format. */
+
+int decode_begin(t_decoder *dec, bool deflate) {
+    memset(dec, 0, sizeof(t_decoder));
+    if (inflateInit2(&dec->zs, deflate ? MAX_WBITS : GZIP_WBITS) != Z_OK) return t_err("inflateInit2");
+    dec->active = true;
+    dec->deflate = deflate;
+    return 0;
+}
+
+/**
+ * @brief Checks whether two bytes are a zlib header.
+ * @details The compression method must be deflate with a window of at most 32 KiB, and the check bits must make both
+ * bytes a multiple of 31 (RFC 1950).
+ * @param head First two bytes of the data.
+ * @return true if the bytes are a zlib header, false otherwise.
+ */
+static bool zlib_header(const unsigned char head[2]) {
+    return (head[0] & 0x0f) == Z_DEFLATED && (head[0] >> 4) <= 7 && (head[0] * 256 + head[1]) % 31 == 0;
+}
+
+/**
+ * @brief Inflates compressed bytes and passes the decoded bytes on.
+ * @param dec Active decoder.
+ * @param buf Compressed bytes.
+ * @param len Count of bytes.
+ * @param emit Receiver of the decoded bytes.
+ * @param arg Argument of the receiver.
+ * @return 0 on success, -1 if the bytes are invalid or the receiver failed.
+ */
+static int inflate_bytes(t_decoder *dec, const unsigned char *buf, size_t len, t_emit emit, void *arg) {
+    z_stream *zs = &dec->zs;
+    unsigned char out[DECODE_BUF_SIZE];
+    zs->next_in = (Bytef *) buf;
+    zs->avail_in = len;
+    while (zs->avail_in > 0) {
+        if (dec->ended && dec->deflate) break;
+        if (dec->ended && inflateReset(zs) != Z_OK) return t_err("inflateReset");
+        dec->ended = false;
+        do {
+            zs->next_out = out;
+            zs->avail_out = sizeof(out);
+            int res = inflate(zs, Z_NO_FLUSH);
+            if (res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR) return m_err("Invalid compressed body");
+            size_t n = sizeof(out) - zs->avail_out;
+            if (n > 0 && emit(arg, (const char *) out, n) == -1) return -1;
+            if (res == Z_STREAM_END) dec->ended = true;
+            if (res == Z_STREAM_END || res == Z_BUF_ERROR) break;
+        } while (zs->avail_in > 0 || zs->avail_out == 0);
+    }
+    return 0;
+}
+
+int decode_feed(t_decoder *dec, const char *buf, size_t len, t_emit emit, void *arg) {
+    if (len > 0) dec->started = true;
+    if (dec->deflate && dec->head_len < 2) {
+        for (; len > 0 && dec->head_len < 2; len--) dec->head[dec->head_len++] = (unsigned char) *buf++;
+        if (dec->head_len < 2) return 0;
+        dec->raw = !zlib_header(dec->head);
+        if (inflateReset2(&dec->zs, dec->raw ? -MAX_WBITS : MAX_WBITS) != Z_OK) return t_err("inflateReset2");
+        if (inflate_bytes(dec, dec->head, 2, emit, arg) == -1) return -1;
+    }
+    return inflate_bytes(dec, (const unsigned char *) buf, len, emit, arg);
+}
+
+int decode_end(t_decoder *dec) {
+    if (!dec->active) return 0;
+    inflateEnd(&dec->zs);
+    dec->active = false;
+    return (dec->ended || !dec->started) ? 0 : m_err("Compressed body is incomplete");
+}
@@ -0,0 +1,69 @@
+/**
+ * Decode module definitions.
+ * @brief Covers streaming decompression of gzip and deflate bodies.
+ * @details Compressed bytes are inflated with zlib as they arrive and passed on in pieces of at most DECODE_BUF_SIZE
+ * bytes, so a body is never held completely. Concatenated gzip members are decoded one after another. Deflate bodies
+ * should be in the zlib format, but raw deflate data (sent by some servers) is accepted as well: the format is decided
+ * by the first two bytes, which are a valid zlib header or else the start of raw data.
+ * @file decode.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <zlib.h>
+
+#define DECODE_BUF_SIZE 65536 /**< Size of the buffer for decoded bytes. */
+
+/**
+ * @brief Receives decoded bytes.
+ * @param arg Argument passed to decode_feed().
+ * @param buf Decoded bytes.
+ * @param len Count of bytes.
+ * @return 0 on success, -1 on error.
+ */
+typedef int (*t_emit)(void *arg, const char *buf, size_t len);
+
+/**
+ * @brief Decoder of a compressed body.
+ */
+typedef struct Decoder {
+    z_stream zs; /**< Stream state of zlib. */
+    bool active; /**< Whether a body is being decoded. */
+    bool deflate; /**< Whether the body has deflate coding (instead of gzip). */
+    bool raw; /**< Whether the deflate data turned out to be raw (without zlib header). */
+    unsigned char head[2]; /**< First bytes of deflate data, which decide its format. */
+    size_t head_len; /**< Count of first bytes of deflate data received (the format is decided at 2). */
+    bool started; /**< Whether compressed bytes were fed already. */
+    bool ended; /**< Whether the compressed stream (or the current gzip member) is complete. */
+} t_decoder;
+
+/**
+ * @brief Starts decoding a body.
+ * @details Must be ended with decode_end().
+ * @param dec Decoder (not active).
+ * @param deflate Whether the body has deflate coding, gzip otherwise.
+ * @return 0 on success, -1 on error.
+ */
+int decode_begin(t_decoder *dec, bool deflate);
+
+/**
+ * @brief Decodes compressed bytes of a body.
+ * @details Bytes after the end of a deflate stream are ignored.
+ * @param dec Active decoder.
+ * @param buf Compressed bytes.
+ * @param len Count of bytes.
+ * @param emit Receiver of the decoded bytes.
+ * @param arg Argument of the receiver.
+ * @return 0 on success, -1 if the bytes are invalid or the receiver failed.
+ */
+int decode_feed(t_decoder *dec, const char *buf, size_t len, t_emit emit, void *arg);
+
+/**
+ * @brief Ends decoding a body.
+ * @details Does nothing if the decoder is not active.
+ * @param dec Decoder.
+ * @return 0 on success (also if the body was empty), -1 if the compressed stream is incomplete.
+ */
+int decode_end(t_decoder *dec);
@@ -0,0 +1,1807 @@
+/**
+ * Engine module.
+ * @brief Implementation of the engine module definitions.
+ * @file engine.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "engine.h"
+#include "misc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+
+#define DEFAULT_FILE "index.html" /**< Default file for http requests. */
+#define EVENT_MAX 64 /**< Maximum count of events per wait. */
+
+/**
+ * @brief Range of bytes of a resource.
+ */
+typedef struct Range {
+    unsigned long long off; /**< Offset of the first byte. */
+    unsigned long long end; /**< Offset after the last byte. */
+} t_range;
+
+/**
+ * @brief Pending connect attempt of a connection.
+ */
+typedef struct Attempt {
+    int fd; /**< Socket file descriptor. */
+    int addr; /**< Index of the address in the addresses of the connection. */
+    long long start; /**< Time the connect started (see now_us()). */
+} t_attempt;
+
+/**
+ * @brief Connection to a server.
+ * @details A connection serves the jobs of its pipeline in order and takes the next jobs of its host when responses
+ * are complete. Only connections that already served a response pipeline more than one request.
+ */
+typedef struct Conn {
+    t_engine *e; /**< Engine of the connection. */
+    struct Conn *prev; /**< Previous open connection. */
+    struct Conn *next; /**< Next open connection. */
+    int fd; /**< Socket file descriptor, -1 if none. */
+    size_t host; /**< Index of the host. */
+    long pipe[ENGINE_PIPE_MAX]; /**< Indices of the jobs whose requests are sent or queued, the first is current. */
+    int pipe_c; /**< Count of jobs in the pipeline. */
+    t_addr addrs[RESOLVER_ADDR_MAX]; /**< Addresses of the host in the order they are tried. */
+    int addr_c; /**< Count of addresses. */
+    int addr_pos; /**< Index of the next address to be tried. */
+    t_attempt attempts[ENGINE_RACE_MAX]; /**< Pending connect attempts while connecting. */
+    int attempt_c; /**< Count of pending connect attempts. */
+    long long race_at; /**< Time (see now_us()) at which the next address is tried while connecting. */
+    uint32_t events; /**< Events the connection waits for. */
+    bool connecting; /**< Whether the connection is not established yet. */
+    bool reused; /**< Whether the connection already served a response. */
+    bool got_bytes; /**< Whether bytes of the current response arrived. */
+    bool write_failed; /**< Whether writing the current body failed. */
+    char *req; /**< Requests of the pipeline that are not completely sent. */
+    size_t req_len; /**< Length of the requests. */
+    size_t req_cap; /**< Capacity of the requests. */
+    size_t req_sent; /**< Count of sent bytes of the requests. */
+    t_resp resp; /**< Parser of the current response. */
+    t_sink sink; /**< Receiver of the current response. */
+    t_decoder dec; /**< Decoder of the current body, if it is compressed. */
+    t_timing timing; /**< Number of the connection and when it was opened, resolved and established. */
+    char *in; /**< Receive buffer (aligned to ENGINE_BUF_ALIGN). */
+    size_t in_len; /**< Count of received bytes at the start of the buffer that are not consumed by the parser. */
+} t_conn;
+
+/**
+ * @brief Writes a buffer completely to a file descriptor.
+ * @param fd File descriptor.
+ * @param buf Buffer to be written.
+ * @param len Length of the buffer.
+ * @return 0 on success, -1 on error.
+ */
+static int write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) return t_err("write");
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes a buffer completely to a file at an offset.
+ * @param fd File descriptor.
+ * @param buf Buffer to be written.
+ * @param len Length of the buffer.
+ * @param off Offset in the file.
+ * @return 0 on success, -1 on error.
+ */
+static int pwrite_all(int fd, const char *buf, size_t len, unsigned long long off) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, buf, len, off);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) return t_err("pwrite");
+        buf += n;
+        len -= n;
+        off += n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns a job that is still stored.
+ * @param e Engine.
+ * @param idx Index of the job (at least e->job_base).
+ * @return Job.
+ */
+static t_job *job_at(const t_engine *e, size_t idx) {
+    return &e->jobs[idx - e->job_base];
+}
+
+/**
+ * @brief Returns the status code a job expects.
+ * @param job Job.
+ * @return 206 for parts, 200 otherwise.
+ */
+static int expected_status(const t_job *job) {
+    return (job->parent != -1) ? 206 : 200;
+}
+
+/**
+ * @brief Returns the output file of a part.
+ * @param e Engine.
+ * @param job Part.
+ * @return File descriptor of the output file of the split job.
+ */
+static int part_fd(t_engine *e, const t_job *job) {
+    return (e->cfg.out_dir != NULL) ? job_at(e, job->parent)->out_fd : e->cfg.out_fd;
+}
+
+/**
+ * @brief Builds the path of the output file of a job.
+ * @details In the output directory, the name of the file depends on the resource that is requested (falls back to
+ * index.html). Otherwise it is the path of the shared output.<br>
+ * Allocates the path, which must be freed later.
+ * @param e Engine.
+ * @param job Job.
+ * @param suffix Suffix appended to the path.
+ * @return Path on success, NULL on error or if the shared output has no path.
+ */
+static char *job_path(t_engine *e, const t_job *job, const char *suffix) {
+    const char *dir = "";
+    const char *file_name = e->cfg.out_path;
+    if (e->cfg.out_dir != NULL) {
+        dir = e->cfg.out_dir;
+        file_name = DEFAULT_FILE;
+        if (job->url.server_path != NULL) {
+            file_name = strrchr(job->url.server_path, '/');
+            if (file_name == NULL) file_name = job->url.server_path;
+            else if (strlen(++file_name) == 0) file_name = DEFAULT_FILE;
+        }
+    }
+    if (file_name == NULL) return NULL;
+    size_t len = strlen(dir) + strlen(file_name) + strlen(suffix) + 2;
+    char *path = (char *) malloc(len);
+    if (path == NULL) {
+        t_err("malloc");
+        return NULL;
+    }
+    snprintf(path, len, "%s%s%s%s", dir, (*dir != '\0') ? "/" : "", file_name, suffix);
+    return path;
+}
+
+/**
+ * @brief Opens the output file of a job in the output directory.
+ * @details An existing regular file is replaced by a new one if it is truncated, since it may be a hard link to a body
+ * stored in the cache (of this or an earlier run). For the same reason, a file with more than one link is not kept in
+ * resume mode: it is replaced, and its journal is removed, since it no longer describes the file.<br>
+ * In direct mode, the body of a regular file is staged for the writer, and the file is opened with O_DIRECT unless
+ * the file system rejects it.
+ * @param e Engine.
+ * @param job Job to be updated with the output file.
+ * @param trunc Whether the file is truncated.
+ * @return 0 on success, -1 on error.
+ */
+static int open_out_fd(t_engine *e, t_job *job, bool trunc) {
+    char *path = job_path(e, job, "");
+    if (path == NULL) return -1;
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISREG(st.st_mode) && (trunc || st.st_nlink > 1)) {
+        if (unlink(path) == -1) {
+            free(path);
+            return t_err("unlink");
+        }
+        if (!trunc) {
+            char *journal = job_path(e, job, ENGINE_JOURNAL_SUFFIX);
+            if (journal != NULL && unlink(journal) == -1 && errno != ENOENT) t_err("unlink");
+            free(journal);
+            trunc = true;
+        }
+    }
+    int flags = O_WRONLY | O_CREAT | (trunc ? O_TRUNC : 0) | O_CLOEXEC;
+    bool direct = e->writer.fd != -1;
+    job->out_fd = open(path, flags | (direct ? O_DIRECT : 0), 0666);
+    if (job->out_fd == -1 && direct && errno == EINVAL) {
+        direct = false;
+        job->out_fd = open(path, flags, 0666);
+    }
+    free(path);
+    if (job->out_fd == -1) return t_err("open");
+    job->out_regular = fstat(job->out_fd, &st) == 0 && S_ISREG(st.st_mode);
+    job->staged = e->writer.fd != -1 && job->out_regular;
+    job->direct = direct && job->out_regular;
+    if (direct && !job->out_regular && fcntl(job->out_fd, F_SETFL, flags & ~(O_CREAT | O_TRUNC)) == -1) {
+        return t_err("fcntl");
+    }
+    return 0;
+}
+
+/**
+ * @brief Opens the output file in the directory for the body of the current response of a connection.
+ * @details If the body is staged and its length is known, the space for it is allocated up front, so the file does
+ * not fragment while its blocks arrive.
+ * @param e Engine.
+ * @param conn Connection.
+ * @param job Current job of the connection.
+ * @return 0 on success, -1 on error.
+ */
+static int open_body_fd(t_engine *e, t_conn *conn, t_job *job) {
+    if (open_out_fd(e, job, true) == -1) return -1;
+    unsigned long long len = conn->resp.content_len;
+    bool known = conn->resp.has_length && !conn->dec.active && len > 0;
+    if (job->staged && known && fallocate(job->out_fd, FALLOC_FL_KEEP_SIZE, 0, len) == -1 && errno != EOPNOTSUPP) {
+        t_err("fallocate");
+    }
+    return 0;
+}
+
+/**
+ * @brief Submits the staged body bytes of a job to the writer.
+ * @details Waits for the previous write of the job first, so the writes of a job complete in order. Files opened with
+ * O_DIRECT need whole blocks, so the last block of a body is padded with zeros, which are cut off once the file is
+ * complete.
+ * @param e Engine.
+ * @param idx Index of the job.
+ * @return 0 on success, -1 on error.
+ */
+static int submit_stage(t_engine *e, long idx) {
+    while (job_at(e, idx)->writing > 0) {
+        if (writer_reap(&e->writer, true) == -1) return t_err("writer_reap");
+    }
+    t_job *job = job_at(e, idx);
+    int fd = (job->parent != -1) ? part_fd(e, job) : job->out_fd;
+    bool direct = (job->parent != -1) ? job_at(e, job->parent)->direct : job->direct;
+    size_t len = job->stage_len;
+    if (direct && len % WRITER_ALIGN != 0) {
+        memset(job->stage + len, 0, WRITER_ALIGN - len % WRITER_ALIGN);
+        len += WRITER_ALIGN - len % WRITER_ALIGN;
+    }
+    char *buf = job->stage;
+    unsigned long long off = job->pos - job->stage_len;
+    job->stage = NULL;
+    job->stage_len = 0;
+    job->writing++;
+    if (writer_submit(&e->writer, fd, buf, len, off, job->pos, idx) == -1) {
+        job_at(e, idx)->writing--;
+        return t_err("writer_submit");
+    }
+    return 0;
+}
+
+/**
+ * @brief Stages body bytes of a job for the writer.
+ * @details Full buffers are submitted right away.
+ * @param e Engine.
+ * @param idx Index of the job.
+ * @param buf Body bytes.
+ * @param len Count of bytes.
+ * @return 0 on success, -1 on error.
+ */
+static int stage_body(t_engine *e, long idx, const char *buf, size_t len) {
+    while (len > 0) {
+        t_job *job = job_at(e, idx);
+        if (job->stage == NULL && (job->stage = writer_alloc(&e->writer)) == NULL) return -1;
+        size_t n = WRITER_BUF_SIZE - job->stage_len;
+        if (n > len) n = len;
+        memcpy(job->stage + job->stage_len, buf, n);
+        job->stage_len += n;
+        job->pos += n;
+        buf += n;
+        len -= n;
+        if (job->stage_len == WRITER_BUF_SIZE && submit_stage(e, idx) == -1) return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Records the progress of a part in the journal of its job.
+ * @details Written bytes are recorded in steps of ENGINE_JOURNAL_STEP, so the journal stays small. The bytes are
+ * written to the output file before they are recorded (staged bytes once their write is complete), so an interrupted
+ * download never records missing bytes.
+ * @param e Engine.
+ * @param part Part.
+ * @param force Whether all written bytes are recorded.
+ */
+static void journal_part(t_engine *e, t_job *part, bool force) {
+    t_job *job = job_at(e, part->parent);
+    unsigned long long pos = part->staged ? part->written : part->pos;
+    if (job->journal == -1 || pos == part->mark || (!force && pos - part->mark < ENGINE_JOURNAL_STEP)) return;
+    if (dprintf(job->journal, "%llu %llu\n", part->mark - job->pos, pos - job->pos) < 0) t_err("dprintf");
+    part->mark = pos;
+}
+
+/**
+ * @brief Opens an anonymous temporary file.
+ * @details The file is created in TMPDIR (or /tmp) and unlinked right away, so it is removed once it is closed.
+ * @return File descriptor on success, -1 on error.
+ */
+static int open_spill(void) {
+    const char *dir = getenv("TMPDIR");
+    if (dir == NULL || *dir == '\0') dir = "/tmp";
+    char path[strlen(dir) + sizeof(ENGINE_SPILL_NAME) + 1];
+    sprintf(path, "%s/%s", dir, ENGINE_SPILL_NAME);
+    int fd = mkostemp(path, O_CLOEXEC);
+    if (fd == -1) return t_err("mkostemp");
+    unlink(path);
+    return fd;
+}
+
+/**
+ * @brief Holds back a part of a body.
+ * @details Parts are held in memory while all held bodies fit into ENGINE_HOLD_MAX bytes. Once a part does not fit,
+ * it and the rest of the body are appended to a temporary file of the job.
+ * @param e Engine.
+ * @param job Job to be updated.
+ * @param buf Part of the body.
+ * @param len Length of the part.
+ * @return 0 on success, -1 on error.
+ */
+static int hold(t_engine *e, t_job *job, const char *buf, size_t len) {
+    if (job->spill == -1 && e->held_total + len > ENGINE_HOLD_MAX && (job->spill = open_spill()) == -1) {
+        return t_err("open_spill");
+    }
+    if (job->spill != -1) return write_all(job->spill, buf, len);
+    if (job->held_len + len > job->held_cap) {
+        size_t cap = (job->held_cap == 0) ? ENGINE_BUF_SIZE : job->held_cap;
+        while (cap < job->held_len + len) cap *= 2;
+        char *temp = (char *) realloc(job->held, cap);
+        if (temp == NULL) return t_err("realloc");
+        job->held = temp;
+        job->held_cap = cap;
+    }
+    memcpy(job->held + job->held_len, buf, len);
+    job->held_len += len;
+    e->held_total += len;
+    return 0;
+}
+
+/**
+ * @brief Writes the held body of a job to the shared output and releases it.
+ * @details The part in memory is written first, then the temporary file with the rest.
+ * @param e Engine.
+ * @param job Job to be updated.
+ * @return 0 on success, -1 on error.
+ */
+static int write_held(t_engine *e, t_job *job) {
+    int res = (job->held_len > 0) ? write_all(e->cfg.out_fd, job->held, job->held_len) : 0;
+    e->held_total -= job->held_len;
+    free(job->held);
+    job->held = NULL;
+    job->held_len = job->held_cap = 0;
+    if (job->spill == -1) return res;
+    char buf[ENGINE_BUF_SIZE];
+    ssize_t n = (lseek(job->spill, 0, SEEK_SET) == -1) ? -1 : 0;
+    while (res == 0 && n != -1 && (n = read(job->spill, buf, sizeof(buf))) != 0) {
+        if (n == -1 && errno == EINTR) n = 0;
+        else if (n != -1) res = write_all(e->cfg.out_fd, buf, n);
+    }
+    close(job->spill);
+    job->spill = -1;
+    return (res == 0 && n == -1) ? t_err("read") : res;
+}
+
+/**
+ * @brief Writes body bytes of the current job of a connection.
+ * @details Bodies of responses with another status than expected are discarded. Parts are written at their offset,
+ * bodies for the directory are staged for the writer in direct mode, bodies for the shared output are held back if an
+ * earlier job is not completely written yet (and copied to the cache if they are stored).
+ * @param arg Connection.
+ * @param buf Body bytes.
+ * @param len Count of bytes.
+ * @return 0 on success, -1 on error.
+ */
+static int write_body(void *arg, const char *buf, size_t len) {
+    t_conn *conn = (t_conn *) arg;
+    t_engine *e = conn->e;
+    t_job *job = job_at(e, conn->pipe[0]);
+    if (conn->resp.status != expected_status(job)) return 0;
+    if (job->cache != NULL && job->cache->tmp_fd != -1 && cache_write(job->cache, buf, len) == -1) {
+        cache_abort(job->cache);
+    }
+    int res;
+    if (job->parent != -1 && job->staged) {
+        res = stage_body(e, conn->pipe[0], buf, len);
+    } else if (job->parent != -1) {
+        res = pwrite_all(part_fd(e, job), buf, len, job->pos);
+        if (res == 0) job->pos += len;
+        journal_part(e, job, false);
+    } else if (e->cfg.out_dir != NULL) {
+        res = (job->out_fd == -1 && open_body_fd(e, conn, job) == -1) ? -1 :
+            job->staged ? stage_body(e, conn->pipe[0], buf, len) : write_all(job->out_fd, buf, len);
+    } else if ((size_t) conn->pipe[0] == e->next_out) {
+        res = write_all(e->cfg.out_fd, buf, len);
+    } else {
+        res = hold(e, job, buf, len);
+    }
+    if (res == -1) conn->write_failed = true;
+    return res;
+}
+
+/**
+ * @brief Receives body bytes of the current response of a connection.
+ * @details Compressed bodies are decoded and their decoded bytes written with write_body(), other bodies are written
+ * as they are.
+ * @param arg Connection.
+ * @param buf Body bytes.
+ * @param len Count of bytes.
+ * @return 0 on success, -1 on error.
+ */
+static int receive_body(void *arg, const char *buf, size_t len) {
+    t_conn *conn = (t_conn *) arg;
+    job_at(conn->e, conn->pipe[0])->timing.bytes += len;
+    if (!conn->dec.active) return write_body(conn, buf, len);
+    return decode_feed(&conn->dec, buf, len, write_body, conn);
+}
+
+/**
+ * @brief Checks the headers of the current response of a connection.
+ * @details Reports the status to stderr if it is not the expected one. HEAD responses only record whether the server
+ * accepts byte ranges and the validator of the resource. Responses to parts must cover exactly the requested range,
+ * a 200 response means that the validator no longer matches. With a cache, the validators of 200 and 304 responses
+ * are taken and a stored body for the shared output is copied to a temporary file. Decoding starts for a gzip or
+ * deflate body of a whole resource if compressed bodies were requested.
+ * @param arg Connection.
+ * @param resp Response parser.
+ * @param block Header block.
+ * @return 0 on success, -1 if the range of a part does not match or on error.
+ */
+static int report_headers(void *arg, const t_resp *resp, const char *block) {
+    t_conn *conn = (t_conn *) arg;
+    t_job *job = job_at(conn->e, conn->pipe[0]);
+    if (conn->e->cfg.timing != METRICS_OFF) job->timing.headers = now_us();
+    if (job->probe) {
+        job->ranges = resp->status == 200 && http_header_has(resp, block, "Accept-Ranges", "bytes");
+        size_t len;
+        const char *value = http_header(resp, block, "ETag", &len);
+        if (value == NULL || (len >= 2 && strncmp(value, "W/", 2) == 0)) {
+            value = http_header(resp, block, "Last-Modified", &len);
+        }
+        free(job->validator);
+        job->validator = NULL;
+        if (value != NULL && (job->validator = strndup(value, len)) == NULL) return t_err("strndup");
+        if (job->cache != NULL && resp->status == 200 && cache_update(job->cache, resp, block) == -1) return -1;
+        return 0;
+    }
+    if (job->parent != -1 && resp->status == 200) {
+        fprintf(stderr, "Resource changed during the download\n");
+        return 0;
+    }
+    if (job->cache != NULL && (resp->status == 200 || (resp->status == 304 && job->cache->found))) {
+        if (cache_update(job->cache, resp, block) == -1) return -1;
+        if (resp->status == 304) return 0;
+        bool tee = job->cache->store && conn->e->cfg.out_dir == NULL;
+        if (tee && cache_begin(job->cache) == -1) job->cache->store = false;
+    }
+    if (resp->status != expected_status(job)) {
+        fprintf(stderr, "%d %s\n", resp->status, resp->reason);
+        return 0;
+    }
+    bool coded = resp->encoding == ENC_GZIP || resp->encoding == ENC_DEFLATE;
+    if (coded && conn->e->cfg.compress && job->parent == -1) {
+        return decode_begin(&conn->dec, resp->encoding == ENC_DEFLATE);
+    }
+    unsigned long long first, last, total;
+    if (job->parent != -1) {
+        unsigned long long base = job_at(conn->e, job->parent)->pos;
+        if (http_content_range(resp, block, &first, &last, &total) == -1) return -1;
+        if (first != job->pos - base || last + 1 != job->end - base) return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes held bodies to the shared output.
+ * @details Advances past all completed jobs and writes what the first incomplete job received so far, its remaining
+ * body is then written directly. Bodies served from the cache are copied when their turn comes. A job whose held
+ * body cannot be written fails (an incomplete one once it is complete).
+ * @param e Engine.
+ */
+static void advance_output(t_engine *e) {
+    while (e->next_out < e->job_c) {
+        t_job *job = job_at(e, e->next_out);
+        if (write_held(e, job) == -1) {
+            t_err("write_held");
+            job->write_error = true;
+            if (job->done && job->res == 0) job->res = -E_CONN;
+        }
+        if (!job->done) break;
+        if (job->from_cache && cache_copy(job->cache, e->cfg.out_fd) == -1) job->res = -E_CONN;
+        e->next_out++;
+    }
+}
+
+/**
+ * @brief Stores the body of a completed job in its cache entry.
+ * @details Files in the output directory are hard-linked into the cache, bodies for the shared output were copied to
+ * a temporary file while they were written (split jobs for the shared output are not stored).
+ * @param e Engine.
+ * @param job Job.
+ */
+static void store_cached(t_engine *e, t_job *job) {
+    if (!job->cache->store) return;
+    char *path = NULL;
+    if (e->cfg.out_dir == NULL && job->cache->tmp_fd == -1) return;
+    if (e->cfg.out_dir != NULL) {
+        if (!job->out_regular || (path = job_path(e, job, "")) == NULL) return;
+    }
+    if (cache_commit(job->cache, path) == -1) t_err("cache_commit");
+    free(path);
+}
+
+/**
+ * @brief Records the length of the output file of a job in the output directory.
+ * @details An open output file is measured directly, otherwise the file at the path of the job (a body served from
+ * the cache is linked there without being opened).
+ * @param e Engine.
+ * @param job Job that is no part.
+ */
+static void measure_job(t_engine *e, t_job *job) {
+    struct stat st;
+    if (job->out_fd != -1) {
+        if (fstat(job->out_fd, &st) == 0) job->size = st.st_size;
+        return;
+    }
+    char *path = job_path(e, job, "");
+    if (path != NULL && stat(path, &st) == 0) job->size = st.st_size;
+    free(path);
+}
+
+/**
+ * @brief Finishes the writes of a job in direct mode.
+ * @details Submits the staged bytes and waits until all writes of the job are complete. A file opened with O_DIRECT
+ * is then cut to the length of its body, which removes the padding of the last block.
+ * @param e Engine.
+ * @param idx Index of the job.
+ * @return 0 on success, -1 if a write failed or on error.
+ */
+static int finish_writes(t_engine *e, long idx) {
+    if (job_at(e, idx)->stage != NULL && submit_stage(e, idx) == -1) return t_err("submit_stage");
+    while (job_at(e, idx)->writing > 0) {
+        if (writer_reap(&e->writer, true) == -1) return t_err("writer_reap");
+    }
+    t_job *job = job_at(e, idx);
+    if (job->direct && ftruncate(job->out_fd, (job->part_c > 0) ? job->end : job->pos) == -1) {
+        return t_err("ftruncate");
+    }
+    return job->write_error ? -1 : 0;
+}
+
+/**
+ * @brief Completes a job.
+ * @details A split job is complete with its last part and fails with the first failed part. Its journal is removed
+ * once it is complete without failure. A successful body is stored in the cache. The shared output continues after a
+ * split job once it is complete.
+ * @param e Engine.
+ * @param idx Index of the job.
+ * @param res 0 on success, negative exit status on failure.
+ */
+static void complete_job(t_engine *e, long idx, int res) {
+    if ((job_at(e, idx)->staged || job_at(e, idx)->direct) && finish_writes(e, idx) == -1 && res == 0) res = -E_CONN;
+    t_job *job = job_at(e, idx);
+    if (job->write_error && res == 0) res = -E_CONN;
+    job->res = res;
+    job->done = true;
+    job->finished = now_us();
+    e->done_c++;
+    bool measure = e->cfg.batch != NULL && e->cfg.out_dir != NULL && job->parent == -1;
+    if (measure && (job->out_fd != -1 || res == 0)) measure_job(e, job);
+    if (job->out_fd != -1) {
+        close(job->out_fd);
+        job->out_fd = -1;
+    }
+    if (job->cache != NULL && res == 0) store_cached(e, job);
+    if (job->cache != NULL) cache_abort(job->cache);
+    if (job->parent != -1) {
+        journal_part(e, job, true);
+        t_job *parent = job_at(e, job->parent);
+        if (parent->res == 0) parent->res = res;
+        if (++parent->part_done == parent->part_c) complete_job(e, job->parent, parent->res);
+        return;
+    }
+    if (job->journal != -1) {
+        close(job->journal);
+        job->journal = -1;
+    }
+    if (job->journal_path != NULL && res == 0 && unlink(job->journal_path) == -1) t_err("unlink");
+    if (job->end > 0 && e->cfg.out_dir == NULL && lseek(e->cfg.out_fd, job->end, SEEK_SET) == -1) t_err("lseek");
+    advance_output(e);
+}
+
+/**
+ * @brief Takes the first job of the queue of a host.
+ * @param e Engine.
+ * @param host Host.
+ * @return Index of the job, -1 if the queue is empty.
+ */
+static long pop_job(t_engine *e, t_host *host) {
+    long idx = host->head;
+    if (idx == -1) return -1;
+    host->head = job_at(e, idx)->next;
+    if (host->head == -1) host->tail = -1;
+    job_at(e, idx)->next = -1;
+    return idx;
+}
+
+/**
+ * @brief Makes schedule() visit a host again after a job was queued on it.
+ * @details schedule() skips hosts without queued jobs and connections for good, unless they are woken here.
+ * @param e Engine.
+ * @param h Index of the host.
+ */
+static void wake_host(t_engine *e, size_t h) {
+    if (h < e->host_pos) e->host_pos = h;
+}
+
+/**
+ * @brief Queues a job again at the front of the queue of its host.
+ * @param e Engine.
+ * @param host Host.
+ * @param idx Index of the job.
+ */
+static void push_job(t_engine *e, t_host *host, long idx) {
+    job_at(e, idx)->next = host->head;
+    host->head = idx;
+    if (host->tail == -1) host->tail = idx;
+    wake_host(e, host - e->hosts);
+}
+
+/**
+ * @brief Fails all queued jobs of a host.
+ * @param e Engine.
+ * @param host Host.
+ * @param res Negative exit status.
+ */
+static void fail_host(t_engine *e, t_host *host, int res) {
+    long idx;
+    while ((idx = pop_job(e, host)) != -1) complete_job(e, idx, res);
+}
+
+/**
+ * @brief Closes a connection and releases it.
+ * @param e Engine.
+ * @param conn Connection to be closed.
+ */
+static void close_conn(t_engine *e, t_conn *conn) {
+    if (conn->fd != -1) close(conn->fd);
+    decode_end(&conn->dec);
+    for (int i = 0; i < conn->attempt_c; i++) close(conn->attempts[i].fd);
+    if (conn->prev != NULL) conn->prev->next = conn->next;
+    else e->conns = conn->next;
+    if (conn->next != NULL) conn->next->prev = conn->prev;
+    e->hosts[conn->host].conn_c--;
+    e->conn_c--;
+    free(conn->req);
+    free(conn->in);
+    free(conn);
+}
+
+/**
+ * @brief Updates the events a connection waits for.
+ * @details Does nothing if the connection already waits for exactly these events.
+ * @param e Engine.
+ * @param conn Connection.
+ * @param op EPOLL_CTL_ADD or EPOLL_CTL_MOD.
+ * @param events Events to wait for.
+ * @return 0 on success, -1 on error.
+ */
+static int watch(t_engine *e, t_conn *conn, int op, uint32_t events) {
+    if (op == EPOLL_CTL_MOD && conn->events == events) return 0;
+    conn->events = events;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = conn;
+    if (epoll_ctl(e->epfd, op, conn->fd, &ev) == -1) return t_err("epoll_ctl");
+    return 0;
+}
+
+/**
+ * @brief Handles a connection that ended before the responses of its pipeline were complete.
+ * @details If a reused connection was closed by the server before any byte of the current response arrived, the
+ * current job is queued again to be retried on another connection. This happens when an idle connection times out on
+ * the server and always makes progress, since a new connection that fails like this is not retried.<br>
+ * The jobs behind the current one are always queued again in their order, since none of their response arrived. If
+ * the pipeline held more than one job, the host falls back to one request per response.
+ * @param e Engine.
+ * @param conn Connection to be closed.
+ * @param res Negative exit status of the current job if it is not retried.
+ */
+static void lose_conn(t_engine *e, t_conn *conn, int res) {
+    t_host *host = &e->hosts[conn->host];
+    if (conn->pipe_c > 1) host->no_pipeline = true;
+    for (int i = conn->pipe_c - 1; i > 0; i--) push_job(e, host, conn->pipe[i]);
+    if (conn->reused && !conn->got_bytes) {
+        push_job(e, host, conn->pipe[0]);
+    } else {
+        if (res == -E_PROTOCOL) fprintf(stderr, "Protocol error!\n");
+        else t_err("connection");
+        complete_job(e, conn->pipe[0], res);
+    }
+    conn->pipe_c = 0;
+    close_conn(e, conn);
+}
+
+/**
+ * @brief Sends the rest of the requests of a connection.
+ * @details Waits for the socket to become writable if it would block. The connection waits for responses while
+ * requests are sent.
+ * @param e Engine.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int send_requests(t_engine *e, t_conn *conn) {
+    while (conn->req_sent < conn->req_len) {
+        ssize_t n = send(conn->fd, conn->req + conn->req_sent, conn->req_len - conn->req_sent, MSG_NOSIGNAL);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n == -1) {
+            lose_conn(e, conn, -E_CONN);
+            return -1;
+        }
+        conn->req_sent += n;
+    }
+    if (conn->req_sent == conn->req_len) {
+        conn->req_sent = conn->req_len = 0;
+        long long now = (e->cfg.timing != METRICS_OFF) ? now_us() : 0;
+        for (int i = 0; now != 0 && i < conn->pipe_c; i++) {
+            t_timing *t = &job_at(e, conn->pipe[i])->timing;
+            if (t->sent == 0) t->sent = now;
+        }
+    }
+    if (watch(e, conn, EPOLL_CTL_MOD, EPOLLIN | ((conn->req_len > 0) ? EPOLLOUT : 0)) == -1) {
+        lose_conn(e, conn, -E_CONN);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Adds the request of a job to the pipeline of a connection.
+ * @details Jobs in ranged or resume mode request the headers with HEAD first, parts request their range of the
+ * resource if it still has the validator of the HEAD response. Jobs with a stored body in the cache send a conditional
+ * request.<br>
+ * Unsent requests are kept, already sent ones are dropped from the buffer. The timing of the first request of a new
+ * connection starts when the connection was opened.
+ * @param e Engine.
+ * @param conn Connection.
+ * @param idx Index of the job.
+ * @return 0 on success, -1 on error.
+ */
+static int queue_request(t_engine *e, t_conn *conn, long idx) {
+    t_job *job = job_at(e, idx);
+    if (e->cfg.timing != METRICS_OFF) {
+        job->timing = conn->timing;
+        job->timing.reused = conn->reused;
+        if (conn->reused || conn->pipe_c > 0) {
+            job->timing.start = job->timing.resolved = job->timing.connected = now_us();
+        }
+    }
+    t_job *parent = (job->parent != -1) ? job_at(e, job->parent) : job;
+    if (parent->started == 0) parent->started = now_us();
+    bool cond = job == parent && job->cache != NULL && job->cache->found;
+    bool compress = job == parent && !job->probe && e->cfg.compress;
+    size_t size = 64 + ((parent->validator != NULL) ? strlen(parent->validator) : 0) + (compress ? 32 : 0);
+    if (cond) size += cache_fields(job->cache, NULL, 0);
+    char fields[size];
+    fields[0] = '\0';
+    int n = 0;
+    if (job != parent) {
+        unsigned long long first = job->pos - parent->pos;
+        n = snprintf(fields, size, "Range: bytes=%llu-%llu\r\n", first, first + (job->end - job->pos) - 1);
+        if (parent->validator != NULL) snprintf(fields + n, size - n, "If-Range: %s\r\n", parent->validator);
+        job = parent;
+    } else if (cond) {
+        n = cache_fields(job->cache, fields, size);
+    }
+    if (compress) snprintf(fields + n, size - n, "Accept-Encoding: gzip, deflate\r\n");
+    char *req;
+    size_t len;
+    if (build_request(&req, &len, &job->url, job->probe ? "HEAD" : "GET", fields) == -1) return t_err("build_request");
+    if (conn->req_sent > 0) {
+        memmove(conn->req, conn->req + conn->req_sent, conn->req_len - conn->req_sent);
+        conn->req_len -= conn->req_sent;
+        conn->req_sent = 0;
+    }
+    if (conn->req_len + len > conn->req_cap) {
+        char *temp = (char *) realloc(conn->req, conn->req_len + len);
+        if (temp == NULL) {
+            free(req);
+            return t_err("realloc");
+        }
+        conn->req = temp;
+        conn->req_cap = conn->req_len + len;
+    }
+    memcpy(conn->req + conn->req_len, req, len);
+    conn->req_len += len;
+    free(req);
+    conn->pipe[conn->pipe_c++] = idx;
+    return 0;
+}
+
+/**
+ * @brief Fills the pipeline of a connection with queued jobs of its host and sends their requests.
+ * @details A new connection gets one job. Connections that already served a response get up to the pipeline depth
+ * of the engine, unless their host fell back to one request per response.
+ * @param e Engine.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int fill_pipeline(t_engine *e, t_conn *conn) {
+    t_host *host = &e->hosts[conn->host];
+    int depth = (conn->reused && !host->no_pipeline) ? e->cfg.pipe_depth : 1;
+    while (conn->pipe_c < depth && host->head != -1) {
+        long idx = pop_job(e, host);
+        if (queue_request(e, conn, idx) == -1) {
+            t_err("queue_request");
+            complete_job(e, idx, -E_CONN);
+        }
+    }
+    if (conn->pipe_c == 0) {
+        close_conn(e, conn);
+        return -1;
+    }
+    return send_requests(e, conn);
+}
+
+/**
+ * @brief Starts a connect attempt to the next address of a server.
+ * @details Tries the addresses in order until a connect is in progress. Addresses that fail immediately are recorded
+ * as failed. The next address is due ENGINE_RACE_DELAY milliseconds later.
+ * @param e Engine.
+ * @param conn Connection.
+ * @param now Current time (see now_us()).
+ * @return 0 on success, -1 if no address is left.
+ */
+static int connect_next(t_engine *e, t_conn *conn, long long now) {
+    t_host *host = &e->hosts[conn->host];
+    for (; conn->addr_pos < conn->addr_c; conn->addr_pos++) {
+        t_addr *addr = &conn->addrs[conn->addr_pos];
+        int fd = socket(addr->family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd == -1) {
+            if (errno != EAFNOSUPPORT) t_err("socket");
+            resolver_report(&host->dns, addr, -1);
+            continue;
+        }
+        if (connect(fd, (struct sockaddr *) &addr->sa, addr->len) == 0 || errno == EINPROGRESS) {
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLOUT;
+            ev.data.ptr = conn;
+            if (epoll_ctl(e->epfd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+                t_attempt *attempt = &conn->attempts[conn->attempt_c++];
+                attempt->fd = fd;
+                attempt->addr = conn->addr_pos++;
+                attempt->start = now;
+                conn->race_at = now + ENGINE_RACE_DELAY * 1000LL;
+                return 0;
+            }
+            t_err("epoll_ctl");
+        } else {
+            resolver_report(&host->dns, addr, -1);
+        }
+        close(fd);
+    }
+    return -1;
+}
+
+/**
+ * @brief Checks whether a connection may start another connect attempt.
+ * @param conn Connection.
+ * @return true if it is connecting and has addresses and room for attempts left, false otherwise.
+ */
+static bool can_race(const t_conn *conn) {
+    return conn->connecting && conn->attempt_c < ENGINE_RACE_MAX && conn->addr_pos < conn->addr_c;
+}
+
+/**
+ * @brief Fails a connection that could not be established, with its job and all queued jobs of its host.
+ * @param e Engine.
+ * @param conn Connection to be closed.
+ */
+static void fail_conn(t_engine *e, t_conn *conn) {
+    t_err("connect");
+    for (int i = 0; i < conn->pipe_c; i++) complete_job(e, conn->pipe[i], -E_CONN);
+    conn->pipe_c = 0;
+    fail_host(e, &e->hosts[conn->host], -E_CONN);
+    close_conn(e, conn);
+}
+
+/**
+ * @brief Opens a new connection to a host for its first queued job.
+ * @details Resolves the addresses of the host unless they are cached. If they cannot be resolved, all queued jobs of
+ * the host fail.
+ * @param e Engine.
+ * @param h Index of the host.
+ */
+static void open_conn(t_engine *e, size_t h) {
+    t_host *host = &e->hosts[h];
+    long long now = now_us();
+    if (resolver_lookup(&host->dns, host->name, e->cfg.port, now) == -1) {
+        fail_host(e, host, -E_CONN);
+        return;
+    }
+    long long resolved = (e->cfg.timing != METRICS_OFF) ? now_us() : 0;
+    t_conn *conn = (t_conn *) calloc(1, sizeof(t_conn));
+    if (conn == NULL || posix_memalign((void **) &conn->in, ENGINE_BUF_ALIGN, ENGINE_BUF_SIZE) != 0) {
+        free(conn);
+        t_err("posix_memalign");
+        fail_host(e, host, -E_CONN);
+        return;
+    }
+    conn->e = e;
+    conn->fd = -1;
+    http_init(&conn->resp);
+    conn->sink.headers = report_headers;
+    conn->sink.body = receive_body;
+    conn->sink.arg = conn;
+    conn->host = h;
+    conn->timing.conn = ++e->conn_seq;
+    conn->timing.start = now;
+    conn->timing.resolved = resolved;
+    conn->addr_c = resolver_order(&host->dns, conn->addrs);
+    conn->connecting = true;
+    conn->pipe[conn->pipe_c++] = pop_job(e, host);
+    conn->next = e->conns;
+    if (e->conns != NULL) e->conns->prev = conn;
+    e->conns = conn;
+    host->conn_c++;
+    e->conn_c++;
+    if (connect_next(e, conn, now) == -1) fail_conn(e, conn);
+}
+
+/**
+ * @brief Opens connections for queued jobs.
+ * @details Opens as many connections as the limits per host and in total allow. Hosts are visited in the order they
+ * first appeared, hosts without queued jobs and connections are skipped until a job is queued on them again (see
+ * wake_host()).
+ * @param e Engine.
+ */
+static void schedule(t_engine *e) {
+    for (size_t h = e->host_pos; h < e->host_c && e->conn_c < ENGINE_CONN_MAX; h++) {
+        t_host *host = &e->hosts[h];
+        if (h == e->host_pos && host->head == -1 && host->conn_c == 0) {
+            e->host_pos++;
+            continue;
+        }
+        while (host->head != -1 && host->conn_c < e->cfg.host_limit && e->conn_c < ENGINE_CONN_MAX) open_conn(e, h);
+    }
+}
+
+/**
+ * @brief Makes room for more jobs.
+ * @param e Engine.
+ * @param n Count of jobs to be added.
+ * @return 0 on success, -1 on error.
+ */
+static int reserve_jobs(t_engine *e, size_t n) {
+    size_t need = e->job_c - e->job_base + n;
+    if (need <= e->job_cap) return 0;
+    size_t cap = (e->job_cap == 0) ? 16 : e->job_cap * 2;
+    while (cap < need) cap *= 2;
+    t_job *temp = (t_job *) realloc(e->jobs, sizeof(t_job) * cap);
+    if (temp == NULL) return t_err("realloc");
+    e->jobs = temp;
+    e->job_cap = cap;
+    return 0;
+}
+
+/**
+ * @brief Prepares the output file of a job to be written by parts.
+ * @details Parts are written with pwrite(), so the output must be a regular file that is not opened for appending. A
+ * job for the shared output must be the first incomplete one, so the offset of its body is known. The file is extended
+ * to the end of the body (in resume mode, the bytes already written are kept), its space is allocated up front in
+ * direct mode.
+ * @param e Engine.
+ * @param job Job to be updated with the offsets of its body.
+ * @param len Length of the body.
+ * @return 0 on success, -1 if the job cannot be split.
+ */
+static int prepare_split(t_engine *e, t_job *job, unsigned long long len) {
+    int fd = e->cfg.out_fd;
+    off_t base = 0;
+    if (e->cfg.out_dir != NULL) {
+        if (job->out_fd == -1 && open_out_fd(e, job, !e->cfg.resume) == -1) return -1;
+        if (!job->out_regular) return -1;
+        fd = job->out_fd;
+    } else {
+        if (!e->out_regular || job != job_at(e, e->next_out) || (fcntl(fd, F_GETFL) & O_APPEND)) return -1;
+        base = lseek(fd, 0, SEEK_CUR);
+        if (base == -1) return -1;
+    }
+    if (job->staged && fallocate(fd, 0, base, len) == -1 && errno != EOPNOTSUPP) t_err("fallocate");
+    if (ftruncate(fd, base + len) == -1) return -1;
+    job->pos = base;
+    job->end = base + len;
+    return 0;
+}
+
+/**
+ * @brief Compares two ranges by their first byte (for qsort()).
+ * @param a First range.
+ * @param b Second range.
+ * @return Negative, zero or positive like strcmp().
+ */
+static int cmp_range(const void *a, const void *b) {
+    unsigned long long x = ((const t_range *) a)->off;
+    unsigned long long y = ((const t_range *) b)->off;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Reads the written ranges from a journal.
+ * @details The journal starts with the length and validator of the resource, followed by one written range per line.
+ * Lines that cannot be parsed (e.g. cut off by an interruption) are ignored.<br>
+ * Allocates the ranges, which must be freed later.
+ * @param path Path of the journal.
+ * @param len Length of the resource.
+ * @param validator Validator of the resource.
+ * @param done Pointer to be updated with the written ranges.
+ * @param done_c Pointer to be updated with the count of written ranges.
+ * @return 0 on success, -1 if the journal is missing or belongs to another length or validator.
+ */
+static int read_journal(const char *path, unsigned long long len, const char *validator, t_range **done,
+    size_t *done_c) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return -1;
+    char *line = NULL;
+    size_t line_cap = 0;
+    size_t cap = 0;
+    int line_c = 0;
+    int res = 0;
+    ssize_t n;
+    while (res == 0 && (n = getline(&line, &line_cap, fp)) != -1) {
+        if (n > 0 && line[n - 1] == '\n') line[--n] = '\0';
+        unsigned long long num;
+        t_range range;
+        if (line_c == 0) {
+            res = (sscanf(line, "length %llu", &num) == 1 && num == len) ? 0 : -1;
+        } else if (line_c == 1) {
+            res = (strncmp(line, "validator ", 10) == 0 && strcmp(line + 10, validator) == 0) ? 0 : -1;
+        } else if (sscanf(line, "%llu %llu", &range.off, &range.end) == 2 && range.off < range.end &&
+            range.end <= len) {
+            if (*done_c == cap) {
+                cap = (cap == 0) ? 16 : cap * 2;
+                t_range *temp = (t_range *) realloc(*done, sizeof(t_range) * cap);
+                if (temp == NULL) {
+                    res = t_err("realloc");
+                    break;
+                }
+                *done = temp;
+            }
+            (*done)[(*done_c)++] = range;
+        }
+        line_c++;
+    }
+    free(line);
+    fclose(fp);
+    return (line_c >= 2) ? res : -1;
+}
+
+/**
+ * @brief Opens the journal of a job in resume mode and finds the ranges that are missing in the output file.
+ * @details A journal of another length or validator is started again, then the whole resource is missing.<br>
+ * Allocates the missing ranges, which must be freed later.
+ * @param e Engine.
+ * @param job Job to be updated with the journal.
+ * @param len Length of the resource.
+ * @param gaps Pointer to be updated with the missing ranges.
+ * @param gap_c Pointer to be updated with the count of missing ranges.
+ * @return 0 on success, -1 on error.
+ */
+static int open_journal(t_engine *e, t_job *job, unsigned long long len, t_range **gaps, size_t *gap_c) {
+    job->journal_path = job_path(e, job, ENGINE_JOURNAL_SUFFIX);
+    if (job->journal_path == NULL) return -1;
+    t_range *done = NULL;
+    size_t done_c = 0;
+    bool valid = read_journal(job->journal_path, len, job->validator, &done, &done_c) == 0;
+    job->journal = open(job->journal_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (valid ? 0 : O_TRUNC), 0666);
+    bool header = job->journal != -1 && (valid || dprintf(job->journal, "length %llu\nvalidator %s\n", len,
+        job->validator) >= 0);
+    if (!header) {
+        free(done);
+        return t_err("open_journal");
+    }
+    if (!valid) done_c = 0;
+    if (done_c > 1) qsort(done, done_c, sizeof(t_range), cmp_range);
+    *gaps = (t_range *) malloc(sizeof(t_range) * (done_c + 1));
+    if (*gaps == NULL) {
+        free(done);
+        return t_err("malloc");
+    }
+    *gap_c = 0;
+    unsigned long long pos = 0;
+    for (size_t i = 0; i <= done_c; i++) {
+        unsigned long long next = (i < done_c) ? done[i].off : len;
+        if (next > pos) (*gaps)[(*gap_c)++] = (t_range) { pos, next };
+        if (i < done_c && done[i].end > pos) pos = done[i].end;
+    }
+    free(done);
+    return 0;
+}
+
+/**
+ * @brief Queues a job again to request its resource as a whole.
+ * @details In resume mode the output file was not truncated when it was opened, so it is truncated now. Its journal
+ * is removed, since it no longer describes the file.
+ * @param e Engine.
+ * @param idx Index of the job.
+ */
+static void unsplit_job(t_engine *e, long idx) {
+    t_job *job = job_at(e, idx);
+    if (job->journal != -1) {
+        close(job->journal);
+        job->journal = -1;
+    }
+    if (e->cfg.resume) {
+        char *path = (job->journal_path != NULL) ? job->journal_path : job_path(e, job, ENGINE_JOURNAL_SUFFIX);
+        if (path != NULL && unlink(path) == -1 && errno != ENOENT) t_err("unlink");
+        free(path);
+        job->journal_path = NULL;
+        bool dir = e->cfg.out_dir != NULL;
+        int fd = dir ? job->out_fd : e->cfg.out_fd;
+        if (fd != -1 && (dir ? job->out_regular : e->out_regular) && ftruncate(fd, 0) == -1) t_err("ftruncate");
+    }
+    job->pos = job->end = 0;
+    push_job(e, &e->hosts[job->host], idx);
+}
+
+/**
+ * @brief Returns the count of parts for a range of a resource.
+ * @param e Engine.
+ * @param range Range.
+ * @return Count of parts, at least 1.
+ */
+static size_t part_count(t_engine *e, const t_range *range) {
+    unsigned long long n = (range->end - range->off) / ENGINE_PART_MIN;
+    if (n > (unsigned long long) e->cfg.range_parts) n = e->cfg.range_parts;
+    return (n == 0) ? 1 : n;
+}
+
+/**
+ * @brief Splits a job into parts after its HEAD response.
+ * @details In resume mode, the parts cover the ranges that are missing according to the journal, otherwise the whole
+ * resource. The parts are queued at the front of the queue of the host, so the connections to the host take them
+ * next.<br>
+ * The resource is requested as a whole instead if the server does not accept byte ranges, the length is unknown, the
+ * output cannot be written at offsets or (without resume mode) the resource is too small for two parts.
+ * @param e Engine.
+ * @param idx Index of the job.
+ * @param resp HEAD response.
+ */
+static void split_job(t_engine *e, long idx, const t_resp *resp) {
+    t_job *job = job_at(e, idx);
+    unsigned long long len = resp->content_len;
+    bool resume = e->cfg.resume && job->validator != NULL;
+    t_range whole = { 0, len };
+    t_range *gaps = &whole;
+    size_t gap_c = 1;
+    job->probe = false;
+    if (!job->ranges || !resp->has_length || len == 0 || (!resume && part_count(e, &whole) < 2) ||
+        prepare_split(e, job, len) == -1 || (resume && open_journal(e, job, len, &gaps, &gap_c) == -1)) {
+        unsplit_job(e, idx);
+        return;
+    }
+    size_t part_c = 0;
+    for (size_t i = 0; i < gap_c; i++) part_c += part_count(e, &gaps[i]);
+    if (reserve_jobs(e, part_c) == -1) {
+        if (gaps != &whole) free(gaps);
+        unsplit_job(e, idx);
+        return;
+    }
+    job = job_at(e, idx);
+    size_t first = e->job_c;
+    bool staged = e->cfg.out_dir != NULL && job->staged;
+    for (size_t i = 0; i < gap_c; i++) {
+        size_t n = part_count(e, &gaps[i]);
+        unsigned long long size = (gaps[i].end - gaps[i].off) / n;
+        if (staged) size -= size % WRITER_ALIGN;
+        for (size_t k = 0; k < n; k++) {
+            t_job *part = job_at(e, e->job_c++);
+            memset(part, 0, sizeof(t_job));
+            part->next = -1;
+            part->out_fd = -1;
+            part->journal = -1;
+            part->spill = -1;
+            part->host = job->host;
+            part->parent = idx;
+            part->pos = part->mark = part->written = job->pos + gaps[i].off + k * size;
+            part->end = (k == n - 1) ? job->pos + gaps[i].end : part->pos + size;
+            part->staged = staged;
+            bool aligned = part->pos % WRITER_ALIGN == 0 && (part->end % WRITER_ALIGN == 0 || part->end == job->end);
+            if (job->direct && !aligned) job->direct = false;
+        }
+    }
+    int flags = staged ? fcntl(job->out_fd, F_GETFL) : 0;
+    if ((flags & O_DIRECT) && !job->direct && fcntl(job->out_fd, F_SETFL, flags & ~O_DIRECT) == -1) t_err("fcntl");
+    if (gaps != &whole) free(gaps);
+    job->part_c = part_c;
+    for (size_t i = e->job_c; i > first; i--) push_job(e, &e->hosts[job->host], i - 1);
+    if (part_c == 0) complete_job(e, idx, 0);
+}
+
+/**
+ * @brief Completes a job with the stored body of its cache entry.
+ * @details The body is linked into the output directory right away or copied to the shared output when the job's
+ * turn comes.
+ * @param e Engine.
+ * @param idx Index of the job.
+ */
+static void serve_cached(t_engine *e, long idx) {
+    t_job *job = job_at(e, idx);
+    int res = 0;
+    if (e->cfg.out_dir != NULL) {
+        if (job->out_fd != -1) {
+            close(job->out_fd);
+            job->out_fd = -1;
+        }
+        char *path = job_path(e, job, "");
+        if (path == NULL || cache_link(job->cache, path) == -1) {
+            t_err("cache_link");
+            res = -E_CONN;
+        }
+        free(path);
+    } else {
+        job->from_cache = true;
+    }
+    complete_job(e, idx, res);
+}
+
+/**
+ * @brief Formats the url of a job including the port.
+ * @details Formats like snprintf().
+ * @param e Engine.
+ * @param job Job.
+ * @param buf Buffer for the url.
+ * @param size Size of the buffer.
+ * @return Length of the url (without the terminating null byte).
+ */
+static int format_url(const t_engine *e, const t_job *job, char *buf, size_t size) {
+    const t_url *url = &job->url;
+    const char *path = url->server_path ? url->server_path : "";
+    const char *sep = url->server_args ? "?" : "";
+    const char *args = url->server_args ? url->server_args : "";
+    return snprintf(buf, size, HTTP_PREFIX "%s:%s/%s%s%s", url->server_host, e->cfg.port, path, sep, args);
+}
+
+/**
+ * @brief Reports the timing of the current response of a connection on stderr.
+ * @details Parts are reported with the url of the job they are a part of.
+ * @param e Engine.
+ * @param conn Connection.
+ * @param idx Index of the current job.
+ */
+static void report_timing(t_engine *e, const t_conn *conn, long idx) {
+    t_job *job = job_at(e, idx);
+    const t_job *whole = (job->parent != -1) ? job_at(e, job->parent) : job;
+    char url[format_url(e, whole, NULL, 0) + 1];
+    format_url(e, whole, url, sizeof(url));
+    job->timing.done = now_us();
+    job->timing.status = conn->resp.status;
+    metrics_print(stderr, e->cfg.timing, job->probe ? "HEAD" : "GET", url, &job->timing);
+}
+
+/**
+ * @brief Completes the current job of a connection after its response is complete.
+ * @details A HEAD response splits its job into parts or queues it again to be requested as a whole. A 304 response
+ * serves the job from the cache, the body of other successful responses is stored in the cache.<br>
+ * The next job of the pipeline becomes the current one. If the server does not keep the connection alive, the
+ * remaining jobs of the pipeline are queued again and the connection is closed.
+ * @param e Engine.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int finish_response(t_engine *e, t_conn *conn) {
+    long idx = conn->pipe[0];
+    t_job *job = job_at(e, idx);
+    if (e->cfg.timing != METRICS_OFF) report_timing(e, conn, idx);
+    if (job->parent == -1) job->status = conn->resp.status;
+    else if (conn->resp.status != expected_status(job)) job_at(e, job->parent)->status = conn->resp.status;
+    if (job->probe) {
+        split_job(e, idx, &conn->resp);
+    } else if (conn->resp.status == 304 && job->cache != NULL && job->cache->found) {
+        if (cache_touch(job->cache) == -1) t_err("cache_touch");
+        serve_cached(e, idx);
+    } else {
+        int res = (conn->resp.status == expected_status(job)) ? 0 : -E_STATUS;
+        if (decode_end(&conn->dec) == -1 && res == 0) res = -E_PROTOCOL;
+        bool open = e->cfg.out_dir != NULL && job->parent == -1 && job->out_fd == -1;
+        if (res == 0 && open && open_out_fd(e, job, true) == -1) res = -E_CONN;
+        complete_job(e, idx, res);
+    }
+    memmove(conn->pipe, conn->pipe + 1, sizeof(long) * --conn->pipe_c);
+    bool keep_alive = conn->resp.keep_alive;
+    conn->reused = true;
+    conn->got_bytes = conn->write_failed = false;
+    http_init(&conn->resp);
+    if (!keep_alive) {
+        t_host *host = &e->hosts[conn->host];
+        for (int i = conn->pipe_c - 1; i >= 0; i--) push_job(e, host, conn->pipe[i]);
+        conn->pipe_c = 0;
+        close_conn(e, conn);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks the pending connect attempts of a connection.
+ * @details The first attempt that connected becomes the socket of the connection and the others are closed. Every
+ * finished attempt is recorded with the resolver. A failed attempt immediately starts one to the next address.<br>
+ * All attempts report events for the same connection, so the events of one wait are merged per connection before
+ * they are handled.
+ * @param e Engine.
+ * @param conn Connection.
+ * @return 0 on success (also if attempts are still pending), -1 if no attempt is left and the connection was closed.
+ */
+static int finish_connect(t_engine *e, t_conn *conn) {
+    t_host *host = &e->hosts[conn->host];
+    struct pollfd fds[ENGINE_RACE_MAX];
+    for (int i = 0; i < conn->attempt_c; i++) {
+        fds[i].fd = conn->attempts[i].fd;
+        fds[i].events = POLLOUT;
+        fds[i].revents = 0;
+    }
+    if (poll(fds, conn->attempt_c, 0) == -1) return 0;
+    long long now = now_us();
+    int n = conn->attempt_c;
+    bool failed = false;
+    conn->attempt_c = 0;
+    for (int i = 0; i < n; i++) {
+        t_attempt attempt = conn->attempts[i];
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (fds[i].revents != 0 && getsockopt(attempt.fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1) err = errno;
+        if (fds[i].revents == 0 || (err == 0 && conn->fd != -1)) {
+            conn->attempts[conn->attempt_c++] = attempt;
+        } else if (err == 0) {
+            resolver_report(&host->dns, &conn->addrs[attempt.addr], now - attempt.start);
+            conn->fd = attempt.fd;
+            conn->timing.connected = now;
+        } else {
+            resolver_report(&host->dns, &conn->addrs[attempt.addr], -1);
+            close(attempt.fd);
+            failed = true;
+        }
+    }
+    if (conn->fd != -1) {
+        for (int i = 0; i < conn->attempt_c; i++) close(conn->attempts[i].fd);
+        conn->attempt_c = 0;
+        conn->events = EPOLLOUT;
+        conn->connecting = false;
+        return 0;
+    }
+    if (failed && can_race(conn) && connect_next(e, conn, now) == 0) return 0;
+    if (conn->attempt_c > 0) return 0;
+    fail_conn(e, conn);
+    return -1;
+}
+
+/**
+ * @brief Handles a writable connection.
+ * @details Completes connecting (see finish_connect()) and sends the requests.
+ * @param e Engine.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int on_writable(t_engine *e, t_conn *conn) {
+    if (conn->connecting) {
+        if (finish_connect(e, conn) == -1) return -1;
+        if (conn->connecting) return 0;
+        long idx = conn->pipe[0];
+        conn->pipe_c = 0;
+        if (queue_request(e, conn, idx) == -1) {
+            t_err("queue_request");
+            complete_job(e, idx, -E_CONN);
+            close_conn(e, conn);
+            return -1;
+        }
+    }
+    return send_requests(e, conn);
+}
+
+/**
+ * @brief Returns the output file a body can be spliced to.
+ * @details Splicing is possible if the rest of the body of a response with the expected status needs no parsing and
+ * its output is a regular file: the file of a part, the file of the job in the directory once it is opened, or the
+ * shared output if no earlier job is incomplete and the body is not copied to the cache. Staged bodies (direct mode)
+ * are never spliced.
+ * @param e Engine.
+ * @param conn Connection.
+ * @return File descriptor of the output file, -1 if the body must be received.
+ */
+static int splice_target(t_engine *e, t_conn *conn) {
+    if (e->splice_pipe[0] == -1 || conn->pipe_c == 0) return -1;
+    t_job *job = job_at(e, conn->pipe[0]);
+    if (conn->resp.status != expected_status(job) || http_body_left(&conn->resp) == 0) return -1;
+    if (job->parent != -1) return job->staged ? -1 : part_fd(e, job);
+    if (conn->dec.active || (job->cache != NULL && job->cache->tmp_fd != -1)) return -1;
+    if (e->cfg.out_dir != NULL) return (job->out_fd != -1 && job->out_regular && !job->staged) ? job->out_fd : -1;
+    return (e->out_regular && (size_t) conn->pipe[0] == e->next_out) ? e->cfg.out_fd : -1;
+}
+
+/**
+ * @brief Moves body bytes from the socket of a connection to an output file.
+ * @details Splices at most the rest of the body into the pipe of the engine and from there into the file, so the
+ * bytes never pass through user space. Parts are spliced at their offset. The pipe is empty again when the function
+ * returns.<br>
+ * If the file does not support splicing (e.g. it was opened for appending), the bytes in the pipe are copied through
+ * the receive buffer and splicing is disabled.
+ * @param e Engine.
+ * @param conn Connection.
+ * @param out Output file.
+ * @return Count of moved bytes, 0 at the end of the connection, -1 on error (write errors set write_failed).
+ */
+static ssize_t splice_body(t_engine *e, t_conn *conn, int out) {
+    unsigned long long left = http_body_left(&conn->resp);
+    size_t len = (left < e->splice_size) ? (size_t) left : e->splice_size;
+    ssize_t n = splice(conn->fd, NULL, e->splice_pipe[1], NULL, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n <= 0) return n;
+    t_job *job = job_at(e, conn->pipe[0]);
+    loff_t off = job->pos;
+    loff_t *off_out = (job->parent != -1) ? &off : NULL;
+    ssize_t moved = 0;
+    while (moved < n) {
+        ssize_t m = splice(e->splice_pipe[0], NULL, out, off_out, n - moved, SPLICE_F_MOVE);
+        if (m == -1 && errno == EINTR) continue;
+        if (m <= 0) break;
+        moved += m;
+    }
+    if (moved == n) {
+        if (off_out != NULL) {
+            job->pos += n;
+            journal_part(e, job, false);
+        }
+        return n;
+    }
+    bool copy = errno == EINVAL;
+    if (!copy) t_err("splice");
+    while (moved < n) {
+        ssize_t r = read(e->splice_pipe[0], conn->in, (n - moved < ENGINE_BUF_SIZE) ? n - moved : ENGINE_BUF_SIZE);
+        if (r <= 0) break;
+        if (copy && (off_out ? pwrite_all(out, conn->in, r, off) : write_all(out, conn->in, r)) == -1) copy = false;
+        moved += r;
+        off += r;
+    }
+    close(e->splice_pipe[0]);
+    close(e->splice_pipe[1]);
+    e->splice_pipe[0] = e->splice_pipe[1] = -1;
+    if (copy && moved == n) {
+        if (off_out != NULL) {
+            job->pos += n;
+            journal_part(e, job, false);
+        }
+        return n;
+    }
+    conn->write_failed = true;
+    return -1;
+}
+
+/**
+ * @brief Parses received bytes of a connection.
+ * @details Passes the bytes to the response parsers of the pipeline in order. Bytes of an incomplete header block or
+ * line are moved to the start of the receive buffer, to be parsed again with the next received bytes.
+ * @param e Engine.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int parse_received(t_engine *e, t_conn *conn) {
+    size_t pos = 0;
+    while (pos < conn->in_len) {
+        if (conn->pipe_c == 0) {
+            close_conn(e, conn);
+            return -1;
+        }
+        if (!conn->got_bytes && e->cfg.timing != METRICS_OFF) job_at(e, conn->pipe[0])->timing.first_byte = now_us();
+        conn->got_bytes = true;
+        if (conn->resp.state == R_STATUS) conn->resp.no_body = job_at(e, conn->pipe[0])->probe;
+        long used = http_feed(&conn->resp, conn->in + pos, conn->in_len - pos, &conn->sink);
+        if (used == -1) {
+            if (conn->write_failed) {
+                t_err("write_body");
+                lose_conn(e, conn, -E_CONN);
+            } else {
+                lose_conn(e, conn, -E_PROTOCOL);
+            }
+            return -1;
+        }
+        pos += used;
+        if (conn->resp.state != R_DONE) break;
+        if (finish_response(e, conn) == -1) return -1;
+    }
+    conn->in_len -= pos;
+    if (conn->in_len > 0 && pos > 0) memmove(conn->in, conn->in + pos, conn->in_len);
+    return 0;
+}
+
+/**
+ * @brief Handles a readable connection.
+ * @details Splices body bytes to the output file if possible, otherwise receives and parses them.<br>
+ * The pipeline is filled up once all received bytes are handled, so the requests for all completed responses are
+ * sent together.
+ * @param e Engine.
+ * @param conn Connection.
+ */
+static void on_readable(t_engine *e, t_conn *conn) {
+    int out = splice_target(e, conn);
+    ssize_t n = (out != -1) ? splice_body(e, conn, out) :
+        recv(conn->fd, conn->in + conn->in_len, ENGINE_BUF_SIZE - conn->in_len, 0);
+    if (n == -1 && out != -1 && errno == EINVAL && !conn->write_failed) {
+        close(e->splice_pipe[0]);
+        close(e->splice_pipe[1]);
+        e->splice_pipe[0] = e->splice_pipe[1] = -1;
+        return;
+    }
+    if (n == -1 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) && !conn->write_failed) return;
+    if (n == -1) {
+        lose_conn(e, conn, (conn->got_bytes && !conn->write_failed) ? -E_PROTOCOL : -E_CONN);
+        return;
+    }
+    if (n == 0) {
+        if (conn->got_bytes && http_eof(&conn->resp) == 0) {
+            conn->resp.keep_alive = false;
+            finish_response(e, conn);
+        } else {
+            lose_conn(e, conn, -E_PROTOCOL);
+        }
+        return;
+    }
+    if (out != -1) {
+        conn->got_bytes = true;
+        job_at(e, conn->pipe[0])->timing.bytes += n;
+        http_skip(&conn->resp, n);
+        if (conn->resp.state == R_DONE && finish_response(e, conn) == -1) return;
+    } else {
+        conn->in_len += n;
+        if (parse_received(e, conn) == -1) return;
+    }
+    if (conn->resp.state == R_STATUS && !conn->got_bytes) fill_pipeline(e, conn);
+}
+
+/**
+ * @brief Receives the completion of a write of a staged body.
+ * @details Parts record their progress once their bytes are written.
+ * @param arg Engine.
+ * @param owner Index of the job.
+ * @param err 0 on success, error number on failure.
+ * @param end Output offset after the written bytes.
+ */
+static void complete_write(void *arg, long owner, int err, unsigned long long end) {
+    t_engine *e = (t_engine *) arg;
+    t_job *job = job_at(e, owner);
+    job->writing--;
+    if (err != 0) {
+        errno = err;
+        t_err("write");
+        job->write_error = true;
+        return;
+    }
+    job->written = end;
+    if (job->parent != -1) journal_part(e, job, false);
+}
+
+int engine_init(t_engine *e, const t_config *cfg) {
+    memset(e, 0, sizeof(t_engine));
+    e->cfg = *cfg;
+    struct stat st;
+    e->out_regular = fstat(e->cfg.out_fd, &st) == 0 && S_ISREG(st.st_mode);
+    e->splice_pipe[0] = e->splice_pipe[1] = -1;
+    e->writer.fd = -1;
+    e->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (e->epfd == -1) return t_err("epoll_create1");
+    if (e->cfg.direct && e->cfg.out_dir != NULL && writer_init(&e->writer, complete_write, e) == -1) {
+        t_err("writer_init");
+        writer_free(&e->writer);
+    }
+    if (pipe2(e->splice_pipe, O_CLOEXEC) == 0) {
+        fcntl(e->splice_pipe[1], F_SETPIPE_SZ, ENGINE_SPLICE_SIZE);
+        int size = fcntl(e->splice_pipe[1], F_GETPIPE_SZ);
+        e->splice_size = (size > 0) ? size : 65536;
+    } else {
+        e->splice_pipe[0] = e->splice_pipe[1] = -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Looks up the cache entry of a job.
+ * @details Entries are keyed by the url including the port.
+ * @param e Engine.
+ * @param job Job to be updated with the cache entry.
+ * @return 0 on success, -1 on error.
+ */
+static int open_cache(t_engine *e, t_job *job) {
+    char key[format_url(e, job, NULL, 0) + 1];
+    format_url(e, job, key, sizeof(key));
+    job->cache = (t_entry *) malloc(sizeof(t_entry));
+    if (job->cache == NULL) return t_err("malloc");
+    return cache_open(job->cache, e->cfg.cache_dir, key);
+}
+
+int engine_add(t_engine *e, char *url) {
+    if (reserve_jobs(e, 1) == -1) return t_err("reserve_jobs");
+    long idx = e->job_c;
+    t_job *job = job_at(e, idx);
+    memset(job, 0, sizeof(t_job));
+    job->next = -1;
+    job->out_fd = -1;
+    job->parent = -1;
+    job->journal = -1;
+    job->spill = -1;
+    job->probe = e->cfg.range_parts > 1 || e->cfg.resume;
+    if (e->cfg.batch != NULL && (job->source = strdup(url)) == NULL) return t_err("strdup");
+    if (parse_url_details(&job->url, url) == -1) {
+        t_err("parse_url_details");
+        e->job_c++;
+        complete_job(e, idx, -E_CONN);
+        return 0;
+    }
+    if (e->cfg.cache_dir != NULL && open_cache(e, job) == -1) return t_err("open_cache");
+    if (job->cache != NULL && job->cache->found) job->probe = false;
+    if (job->cache != NULL && cache_fresh(job->cache)) {
+        e->job_c++;
+        serve_cached(e, idx);
+        return 0;
+    }
+    size_t h;
+    for (h = 0; h < e->host_c && strcmp(e->hosts[h].name, job->url.server_host) != 0; h++);
+    if (h == e->host_c) {
+        if (e->host_c == e->host_cap) {
+            size_t cap = (e->host_cap == 0) ? 16 : e->host_cap * 2;
+            t_host *temp = (t_host *) realloc(e->hosts, sizeof(t_host) * cap);
+            if (temp == NULL) return t_err("realloc");
+            e->hosts = temp;
+            e->host_cap = cap;
+        }
+        t_host *host = &e->hosts[h];
+        memset(host, 0, sizeof(t_host));
+        host->head = host->tail = -1;
+        host->name = strdup(job->url.server_host);
+        if (host->name == NULL) return t_err("strdup");
+        e->host_c++;
+    }
+    t_host *host = &e->hosts[h];
+    job->host = h;
+    if (host->tail == -1) host->head = idx;
+    else job_at(e, host->tail)->next = idx;
+    host->tail = idx;
+    wake_host(e, h);
+    e->job_c++;
+    return 0;
+}
+
+/**
+ * @brief Computes how long to wait for events until the next connect attempt is due.
+ * @param e Engine.
+ * @return Timeout in milliseconds, -1 if no attempt is due.
+ */
+static int race_timeout(t_engine *e) {
+    long long next = -1;
+    for (t_conn *conn = e->conns; conn != NULL; conn = conn->next) {
+        if (can_race(conn) && (next == -1 || conn->race_at < next)) next = conn->race_at;
+    }
+    if (next == -1) return -1;
+    long long now = now_us();
+    return (next <= now) ? 0 : (int) ((next - now + 999) / 1000);
+}
+
+/**
+ * @brief Starts the next connect attempts of connections whose attempts are pending for too long.
+ * @param e Engine.
+ */
+static void race(t_engine *e) {
+    long long now = now_us();
+    t_conn *next;
+    for (t_conn *conn = e->conns; conn != NULL; conn = next) {
+        next = conn->next;
+        if (can_race(conn) && conn->race_at <= now && connect_next(e, conn, now) == -1 && conn->attempt_c == 0) {
+            fail_conn(e, conn);
+        }
+    }
+}
+
+/**
+ * @brief Releases the resources of a job.
+ * @param job Job.
+ */
+static void release_job(t_job *job) {
+    free(job->url.buf);
+    free(job->source);
+    free(job->held);
+    if (job->spill != -1) close(job->spill);
+    free(job->validator);
+    free(job->journal_path);
+    free(job->stage);
+    if (job->out_fd != -1) close(job->out_fd);
+    if (job->journal != -1) close(job->journal);
+    if (job->cache != NULL) cache_free(job->cache);
+    free(job->cache);
+}
+
+/**
+ * @brief Releases the jobs that are passed to the receiver of the batch and written to the shared output.
+ * @details Jobs are only moved once at least half of the stored jobs can be released, so every job is moved a
+ * constant count of times on average.
+ * @param e Engine.
+ */
+static void compact_jobs(t_engine *e) {
+    size_t end = (e->batch_pos < e->next_out) ? e->batch_pos : e->next_out;
+    size_t n = end - e->job_base;
+    if (n < 16 || n * 2 < e->job_c - e->job_base) return;
+    for (size_t i = e->job_base; i < end; i++) release_job(job_at(e, i));
+    memmove(e->jobs, job_at(e, end), sizeof(t_job) * (e->job_c - end));
+    e->job_base = end;
+}
+
+/**
+ * @brief Passes complete jobs to the receiver of the batch and adds urls of its source until the window is full.
+ * @details Jobs are passed in the order they were added, parts are skipped (they are complete with their job).
+ * @param e Engine in batch mode.
+ * @return 0 on success, -1 on error.
+ */
+static int feed_batch(t_engine *e) {
+    const t_batch *batch = e->cfg.batch;
+    while (true) {
+        for (; e->batch_pos < e->job_c; e->batch_pos++) {
+            t_job *job = job_at(e, e->batch_pos);
+            if (job->parent != -1) continue;
+            if (!job->done) break;
+            batch->done(batch->arg, job->source, job);
+            e->batch_open--;
+        }
+        compact_jobs(e);
+        if (e->batch_end || e->batch_open >= batch->window) return 0;
+        char *url = batch->next(batch->arg);
+        if (url == NULL) {
+            e->batch_end = true;
+            return 0;
+        }
+        e->batch_open++;
+        if (engine_add(e, url) == -1) return t_err("engine_add");
+    }
+}
+
+int engine_run(t_engine *e) {
+    struct epoll_event events[EVENT_MAX];
+    if (e->cfg.batch != NULL && feed_batch(e) == -1) return t_err("feed_batch");
+    schedule(e);
+    while (e->done_c < e->job_c) {
+        int n = epoll_wait(e->epfd, events, EVENT_MAX, race_timeout(e));
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) return t_err("epoll_wait");
+        for (int i = 0; i < n; i++) {
+            t_conn *conn = (t_conn *) events[i].data.ptr;
+            if (conn == NULL) continue;
+            for (int j = i + 1; j < n; j++) {
+                if (events[j].data.ptr != conn) continue;
+                events[i].events |= events[j].events;
+                events[j].data.ptr = NULL;
+            }
+            if ((conn->connecting || (events[i].events & EPOLLOUT)) && on_writable(e, conn) == -1) continue;
+            if (!conn->connecting && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) on_readable(e, conn);
+        }
+        race(e);
+        if (e->writer.fd != -1 && writer_reap(&e->writer, false) == -1) t_err("writer_reap");
+        if (e->cfg.batch != NULL && feed_batch(e) == -1) return t_err("feed_batch");
+        schedule(e);
+    }
+    return 0;
+}
+
+void engine_free(t_engine *e) {
+    while (e->conns != NULL) close_conn(e, e->conns);
+    writer_free(&e->writer);
+    for (size_t i = e->job_base; i < e->job_c; i++) release_job(job_at(e, i));
+    free(e->jobs);
+    for (size_t h = 0; h < e->host_c; h++) free(e->hosts[h].name);
+    free(e->hosts);
+    if (e->epfd != -1) close(e->epfd);
+    if (e->splice_pipe[0] != -1) {
+        close(e->splice_pipe[0]);
+        close(e->splice_pipe[1]);
+    }
+}
@@ -0,0 +1,223 @@
+/**
+ * Engine module definitions.
+ * @brief Covers concurrent downloads driven by a single event loop.
+ * @details All sockets are non-blocking and watched with epoll, so requests to many hosts are in flight at the same
+ * time. Every host has a queue of jobs and at most a given count of connections, which are kept alive and take the
+ * next job of the queue when their response is complete.<br>
+ * Connections that already served a response may pipeline several requests, whose responses are parsed in order. If
+ * a server closes such a connection before all responses arrived, the remaining jobs are queued again and the host
+ * falls back to one request per response.<br>
+ * Bodies are either written to one file per job in a directory or to one shared output stream. Bodies for the shared
+ * output are written in the order the jobs were added, bodies of later jobs are held back until all earlier jobs are
+ * complete: in memory up to ENGINE_HOLD_MAX bytes in total, beyond that in temporary files.<br>
+ * Bodies with a known length that go to a regular file are moved from the socket to the file with splice() through a
+ * pipe, without copying them to user space. Other bodies are received into large page-aligned buffers.<br>
+ * In ranged mode, every resource is first requested with HEAD. If the server accepts byte ranges and the resource is
+ * large enough, the job is split into parts that are requested with Range headers over separate connections and
+ * written at their offsets into the output file. Otherwise the resource is requested as a whole.<br>
+ * In resume mode, output files are not truncated. Jobs that can be split keep a journal next to their output file with
+ * the length and validator (ETag or Last-Modified) of the resource and the ranges that are written. A later run with a
+ * matching HEAD response only requests the missing ranges, guarded by If-Range. The journal is removed once the
+ * download is complete.<br>
+ * With a cache directory, bodies of complete responses are stored in the cache (see cache.h). Fresh entries are served
+ * without a request, others are revalidated with a conditional request and served from the cache on 304.<br>
+ * Optionally, whole resources are requested with gzip or deflate content coding. Such bodies pass the decoder (see
+ * decode.h) between the response parser, which already removes the chunk framing, and the output, so the decoded
+ * bytes are written, held and cached like any other body. Parts and HEAD requests never ask for a content coding.<br>
+ * Optionally, the timing of every complete response is reported on stderr (see metrics.h).<br>
+ * Addresses of hosts are cached (see resolver.h). A new connection races connects to them: if the first attempt is not
+ * established within ENGINE_RACE_DELAY milliseconds (or fails), the next address is tried in parallel, and the first
+ * attempt that connects is used while the others are closed.<br>
+ * In direct mode, bodies for files in the directory are collected in aligned buffers and written with io_uring (see
+ * writer.h) while further bytes are received, instead of being spliced or written synchronously. The files are
+ * opened with O_DIRECT where the file system supports it, which keeps large downloads out of the page cache. Space is
+ * allocated up front if the length of a body is known. Parts then start at block boundaries, the last block of a file
+ * is padded and cut off again when the file is complete.<br>
+ * In batch mode, the engine pulls its urls from a source while fewer than a window of them are incomplete and passes
+ * every url to a receiver once it and all earlier urls are complete. Reported jobs are released, so memory stays
+ * bounded by the window however many urls the source supplies.
+ * @file engine.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "cache.h"
+#include "resolver.h"
+#include "decode.h"
+#include "metrics.h"
+#include "writer.h"
+
+#define ENGINE_CONN_MAX 256 /**< Maximum count of open connections. */
+#define ENGINE_BUF_SIZE 131072 /**< Size of the receive buffer of a connection. */
+#define ENGINE_BUF_ALIGN 4096 /**< Alignment of the receive buffer of a connection. */
+#define ENGINE_SPLICE_SIZE 1048576 /**< Requested size of the pipe for splicing bodies. */
+#define ENGINE_PIPE_MAX 32 /**< Maximum count of pipelined requests per connection. */
+#define ENGINE_PARTS_MAX 64 /**< Maximum count of parts per resource in ranged mode. */
+#define ENGINE_PART_MIN 1048576 /**< Minimum size of a part in ranged mode. */
+#define ENGINE_JOURNAL_SUFFIX ".journal" /**< Suffix of the journal next to an output file in resume mode. */
+#define ENGINE_JOURNAL_STEP 4194304 /**< Count of written bytes of a part after which its progress is recorded. */
+#define ENGINE_RACE_MAX 4 /**< Maximum count of parallel connect attempts per connection. */
+#define ENGINE_RACE_DELAY 250 /**< Milliseconds after which the next address is tried while a connect is pending. */
+#define ENGINE_HOLD_MAX 67108864 /**< Count of held body bytes in memory above which bodies are held in files. */
+#define ENGINE_SPILL_NAME "http-held.XXXXXX" /**< Name template of the temporary files of held bodies. */
+#define E_CONN 1 /**< Exit status if a server could not be reached. */
+#define E_PROTOCOL 2 /**< Exit status on protocol errors. */
+#define E_STATUS 3 /**< Exit status if a response status is not 200. */
+
+/**
+ * @brief Download of one resource.
+ */
+typedef struct Job {
+    t_url url; /**< Url of the resource. */
+    char *source; /**< Url as it was returned by the source of the batch, NULL if not in batch mode. */
+    size_t host; /**< Index of the host of the resource. */
+    long next; /**< Index of the next job in the queue of the host, -1 if it is the last. */
+    int out_fd; /**< Output file in the directory, -1 if not opened yet. */
+    bool out_regular; /**< Whether the output file in the directory is a regular file. */
+    char *held; /**< Body that is held back until all earlier jobs are written to the shared output. */
+    size_t held_len; /**< Length of the held body. */
+    size_t held_cap; /**< Capacity of the held body. */
+    int spill; /**< Temporary file with the rest of the held body, -1 if the body is held in memory only. */
+    int res; /**< 0 on success, negative exit status on failure. */
+    bool done; /**< Whether the job is complete. */
+    bool probe; /**< Whether the job still has to request the headers with HEAD (ranged mode). */
+    bool ranges; /**< Whether the HEAD response accepted byte ranges. */
+    long parent; /**< Index of the job this job is a part of, -1 if it is no part. */
+    unsigned long long pos; /**< Next output offset of a part or staged body, first output offset of a split job. */
+    unsigned long long end; /**< Output offset after the last byte of a part or a split job. */
+    int part_c; /**< Count of parts of a split job, 0 if it is not split. */
+    int part_done; /**< Count of completed parts of a split job. */
+    unsigned long long mark; /**< Output offset up to which a part is recorded in the journal. */
+    char *validator; /**< ETag or Last-Modified of the HEAD response, NULL if there is none. */
+    char *journal_path; /**< Path of the journal of a split job, NULL if there is none. */
+    int journal; /**< Journal of a split job, -1 if not opened. */
+    t_entry *cache; /**< Cache entry of the url, NULL if there is no cache directory. */
+    bool from_cache; /**< Whether the body is copied from the cache to the shared output. */
+    t_timing timing; /**< Timing of the current request (only timestamps if it is reported). */
+    int status; /**< Status of the last response for the job or an unexpected one for a part, 0 if there was none. */
+    long long started; /**< Time (see now_us()) the first request of the job was queued, 0 if there was none. */
+    long long finished; /**< Time (see now_us()) the job was completed. */
+    unsigned long long size; /**< Length of the output file of a complete job (batch mode with directory only). */
+    bool staged; /**< Whether the body is written with the writer (direct mode). */
+    bool direct; /**< Whether the output file in the directory is opened with O_DIRECT. */
+    char *stage; /**< Aligned buffer with body bytes that are not submitted to the writer, NULL if there is none. */
+    size_t stage_len; /**< Count of bytes in the buffer. */
+    int writing; /**< Count of writes of the body in flight (at most one, so they complete in order). */
+    unsigned long long written; /**< Output offset up to which the writes of a part are complete. */
+    bool write_error; /**< Whether a write of the body failed. */
+} t_job;
+
+/**
+ * @brief Source of urls and receiver of complete jobs in batch mode.
+ */
+typedef struct Batch {
+    /**
+     * @brief Returns the next url.
+     * @param arg Argument of the batch.
+     * @return Url (valid until the next call), NULL if there is none left or on error.
+     */
+    char *(*next)(void *arg);
+    /**
+     * @brief Receives a complete job, in the order the urls were returned (parts are not passed).
+     * @details The job is released afterwards.
+     * @param arg Argument of the batch.
+     * @param url Url of the job as it was returned by the source.
+     * @param job Complete job.
+     */
+    void (*done)(void *arg, const char *url, const t_job *job);
+    void *arg; /**< Argument of the callbacks. */
+    size_t window; /**< Maximum count of urls that are returned but not yet passed to the receiver. */
+} t_batch;
+
+/**
+ * @brief Server with its queue of jobs.
+ */
+typedef struct Host {
+    char *name; /**< Host name of the server. */
+    t_resolved dns; /**< Cached addresses of the server. */
+    long head; /**< Index of the first queued job, -1 if the queue is empty. */
+    long tail; /**< Index of the last queued job, -1 if the queue is empty. */
+    int conn_c; /**< Count of open connections. */
+    bool no_pipeline; /**< Whether the host fell back to one request per response. */
+} t_host;
+
+/**
+ * @brief Configuration of an engine.
+ */
+typedef struct Config {
+    char *port; /**< Port name of the servers. */
+    char *out_dir; /**< Directory for one output file per job, NULL if the shared output is used. */
+    char *out_path; /**< Path of the shared output file, NULL if it is stdout. */
+    int out_fd; /**< Shared output stream. */
+    int host_limit; /**< Maximum count of connections per host. */
+    int pipe_depth; /**< Maximum count of pipelined requests per connection (at most ENGINE_PIPE_MAX). */
+    int range_parts; /**< Maximum count of parts per resource (at most ENGINE_PARTS_MAX), 1 if ranged mode is off. */
+    bool resume; /**< Whether output files are resumed (the shared output must then get at most one job). */
+    char *cache_dir; /**< Cache directory, NULL if responses are not cached. */
+    bool compress; /**< Whether compressed bodies are requested and decoded. */
+    t_mformat timing; /**< Format of the timing report on stderr, METRICS_OFF if there is none. */
+    bool direct; /**< Whether files in the directory are written with io_uring (direct mode). */
+    const t_batch *batch; /**< Source and receiver of urls in batch mode, NULL if all jobs are added beforehand. */
+} t_config;
+
+/**
+ * @brief Event loop with all jobs, hosts and connections.
+ */
+typedef struct Engine {
+    t_config cfg; /**< Configuration. */
+    bool out_regular; /**< Whether the shared output stream is a regular file. */
+    t_writer writer; /**< Writer for files in the directory, its fd is -1 if direct mode is off or not possible. */
+    int splice_pipe[2]; /**< Pipe for splicing bodies, -1 if splicing is not possible. */
+    size_t splice_size; /**< Size of the pipe for splicing bodies. */
+    int epfd; /**< Epoll instance. */
+    t_job *jobs; /**< Stored jobs in the order they were added, starting with the job at index job_base. */
+    size_t job_base; /**< Index of the first stored job (earlier jobs are released in batch mode). */
+    size_t job_c; /**< Count of jobs added so far (the index of the next job). */
+    size_t job_cap; /**< Capacity of the stored jobs. */
+    t_host *hosts; /**< All hosts in the order they first appeared. */
+    size_t host_c; /**< Count of hosts. */
+    size_t host_cap; /**< Capacity of the hosts. */
+    size_t host_pos; /**< Index of the first host that may have queued jobs. */
+    struct Conn *conns; /**< Open connections. */
+    size_t conn_c; /**< Count of open connections. */
+    unsigned long conn_seq; /**< Count of connections opened so far. */
+    size_t done_c; /**< Count of completed jobs. */
+    size_t next_out; /**< Index of the first job that is not completely written to the shared output. */
+    size_t held_total; /**< Count of body bytes held in memory for the shared output. */
+    size_t batch_pos; /**< Index of the first job that is not passed to the receiver of the batch. */
+    size_t batch_open; /**< Count of urls of the batch that are not passed to the receiver. */
+    bool batch_end; /**< Whether the source of the batch has no urls left. */
+} t_engine;
+
+/**
+ * @brief Initializes an engine.
+ * @details Must be released with engine_free().
+ * @param e Engine to be initialized.
+ * @param cfg Configuration, copied into the engine.
+ * @return 0 on success, -1 on error.
+ */
+int engine_init(t_engine *e, const t_config *cfg);
+
+/**
+ * @brief Adds a job for an url.
+ * @details Jobs with an invalid url are completed immediately with exit status 1.
+ * @param e Engine.
+ * @param url Url of the resource.
+ * @return 0 on success, -1 on error.
+ */
+int engine_add(t_engine *e, char *url);
+
+/**
+ * @brief Runs the event loop until all jobs are complete.
+ * @details Failed jobs do not stop the loop, their exit status is stored in the job. In batch mode, the loop also
+ * runs until the source has no urls left and all jobs are passed to the receiver.
+ * @param e Engine.
+ * @return 0 on success, -1 on error.
+ */
+int engine_run(t_engine *e);
+
+/**
+ * @brief Releases an engine and all its jobs, hosts and connections.
+ * @param e Engine to be released.
+ */
+void engine_free(t_engine *e);
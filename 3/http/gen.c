@@ -0,0 +1,54 @@
+/**
+ * Generator module.
+ * @brief Implementation of the generator module definitions.
+ * @file gen.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "gen.h"
+#include <stdint.h>
+#include <string.h>
+
+static char table[GEN_PERIOD]; /**< One period of the generated content. */
+static bool ready = false; /**< Whether the table is filled. */
+
+/**
+ * @brief Fills the table with one period of the content.
+ * @details Xorshift generator with a fixed seed, so the content is the same in every process.
+ */
+static void init_table(void) {
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < GEN_PERIOD; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        table[i] = (char) (state >> 56);
+    }
+    ready = true;
+}
+
+void gen_fill(char *buf, unsigned long long off, size_t len) {
+    if (!ready) init_table();
+    size_t pos = off % GEN_PERIOD;
+    while (len > 0) {
+        size_t n = (len < GEN_PERIOD - pos) ? len : GEN_PERIOD - pos;
+        memcpy(buf, table + pos, n);
+        buf += n;
+        len -= n;
+        pos = 0;
+    }
+}
+
+bool gen_check(const char *buf, unsigned long long off, size_t len) {
+    if (!ready) init_table();
+    size_t pos = off % GEN_PERIOD;
+    while (len > 0) {
+        size_t n = (len < GEN_PERIOD - pos) ? len : GEN_PERIOD - pos;
+        if (memcmp(buf, table + pos, n) != 0) return false;
+        buf += n;
+        len -= n;
+        pos = 0;
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+/**
+ * Generator module definitions.
+ * @brief Covers the generated content of the test server.
+ * @details Every generated resource has the same content up to its length: a fixed pseudo random sequence of bytes
+ * with a period of GEN_PERIOD. The period is prime, so it never lines up with buffer or range sizes and misplaced
+ * bytes are detected when the content is checked.
+ * @file gen.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define GEN_PERIOD 65521 /**< Period of the generated content. */
+
+/**
+ * @brief Fills a buffer with generated content.
+ * @param buf Buffer to be filled.
+ * @param off Offset of the first byte in the resource.
+ * @param len Count of bytes.
+ */
+void gen_fill(char *buf, unsigned long long off, size_t len);
+
+/**
+ * @brief Checks bytes against the generated content.
+ * @param buf Bytes to be checked.
+ * @param off Offset of the first byte in the resource.
+ * @param len Count of bytes.
+ * @return true if the bytes are generated content, false otherwise.
+ */
+bool gen_check(const char *buf, unsigned long long off, size_t len);
@@ -0,0 +1,537 @@
+/**
+ * Http module.
+ * @brief Implementation of the http module definitions.
+ * @file http.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "http.h"
+#include "misc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+int parse_url_details(t_url *url, char *url_with_protocol) {
+    memset(url, 0, sizeof(t_url));
+    if (strncmp(url_with_protocol, HTTP_PREFIX, strlen(HTTP_PREFIX)) != 0) {
+        errno = EINVAL;
+        return m_err("Invalid protocol");
+    }
+    url->buf = strdup(url_with_protocol);
+    if (url->buf == NULL) return t_err("strdup");
+    url->server_host = url->buf + strlen(HTTP_PREFIX);
+    if (
+        strlen(url->server_host) == 0 ||
+        strncmp(url->server_host, "/", 1) == 0 ||
+        strncmp(url->server_host, "?", 1) == 0
+    ) {
+        errno = EINVAL;
+        return m_err("Invalid hostname");
+    }
+    int len_before = strlen(url->server_host);
+    url->server_host = strtok(url->server_host, "/");
+    if (len_before == strlen(url->server_host)) {
+        url->server_host = strtok(url->server_host, "?");
+        url->server_args = strtok(NULL, "");
+    } else {
+        char *temp = strtok(NULL, "");
+        if (temp != NULL) {
+            if (strncmp(temp, "?", 1) == 0) {
+                url->server_args = strtok(temp, "?");
+            } else {
+                url->server_path = strtok(temp, "?");
+                url->server_args = strtok(NULL, "");
+            }
+        }
+    }
+    return 0;
+}
+
+int build_request(char **dst, size_t *len, t_url *url, const char *method, const char *fields) {
+    const char *fmt =
+        "%s /%s%s%s HTTP/1.1\r\nHost: %s\r\nUser-Agent: tuwien-osue-http/1.0\r\nConnection: keep-alive\r\n%s\r\n";
+    char *path = url->server_path ? url->server_path : "";
+    char *sep = url->server_args ? "?" : "";
+    char *args = url->server_args ? url->server_args : "";
+    if (fields == NULL) fields = "";
+    int n = snprintf(NULL, 0, fmt, method, path, sep, args, url->server_host, fields);
+    if (n < 0) return t_err("snprintf");
+    *dst = (char *) malloc(n + 1);
+    if (*dst == NULL) return t_err("malloc");
+    snprintf(*dst, n + 1, fmt, method, path, sep, args, url->server_host, fields);
+    *len = n;
+    return 0;
+}
+
+void http_init(t_resp *resp) {
+    memset(resp, 0, sizeof(t_resp));
+    resp->state = R_STATUS;
+    resp->keep_alive = true;
+}
+
+/**
+ * @brief Finds the next line end.
+ * @details Compares 16 bytes at once with SSE2 (part of every x86-64 cpu), the rest is left to memchr(). A line end
+ * is the LF, a preceding CR is stripped by the caller.
+ * @param buf Bytes to be scanned.
+ * @param len Count of bytes.
+ * @return Pointer to the LF, NULL if there is none.
+ */
+static const char *find_eol(const char *buf, size_t len) {
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; i + 16 <= len; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (buf + i)), lf));
+        if (mask != 0) return buf + i + __builtin_ctz(mask);
+    }
+#endif
+    return (const char *) memchr(buf + i, '\n', len - i);
+}
+
+/**
+ * @brief Compares a span case-insensitively with a string.
+ * @param buf Bytes the span refers to.
+ * @param span Span.
+ * @param str String.
+ * @return true if both are equal, false otherwise.
+ */
+static bool span_is(const char *buf, t_span span, const char *str) {
+    return strlen(str) == span.len && strncasecmp(buf + span.off, str, span.len) == 0;
+}
+
+/**
+ * @brief Removes spaces and tabs around a span.
+ * @param buf Bytes the span refers to.
+ * @param span Span to be updated.
+ */
+static void trim_span(const char *buf, t_span *span) {
+    while (span->len > 0 && (buf[span->off] == ' ' || buf[span->off] == '\t')) {
+        span->off++;
+        span->len--;
+    }
+    while (span->len > 0 && (buf[span->off + span->len - 1] == ' ' || buf[span->off + span->len - 1] == '\t')) {
+        span->len--;
+    }
+}
+
+/**
+ * @brief Checks whether a comma-separated list contains a token.
+ * @details Tokens are compared case-insensitively, whitespace around them is ignored.
+ * @param buf Bytes the span refers to.
+ * @param list Span of the list.
+ * @param token Token.
+ * @param last Whether the token must be the last one of the list.
+ * @return true if the list contains the token, false otherwise.
+ */
+static bool has_token(const char *buf, t_span list, const char *token, bool last) {
+    size_t end = list.off + list.len;
+    bool found = false;
+    for (size_t pos = list.off; pos <= end;) {
+        size_t next = pos;
+        while (next < end && buf[next] != ',') next++;
+        t_span item = { pos, next - pos };
+        trim_span(buf, &item);
+        found = span_is(buf, item, token);
+        if (found && !last) return true;
+        pos = next + 1;
+    }
+    return found;
+}
+
+/**
+ * @brief Chooses how the body of a response is read, after all headers are parsed.
+ * @details Responses to HEAD requests and with status 204 or 304 have no body. Chunked transfer encoding takes
+ * precedence over Content-Length, bodies without either end when the connection is closed.<br>
+ * Interim responses (status 1xx) are skipped.
+ * @param resp Response parser to be updated.
+ */
+static void start_body(t_resp *resp) {
+    if (resp->status >= 100 && resp->status < 200) {
+        bool no_body = resp->no_body;
+        http_init(resp);
+        resp->no_body = no_body;
+    } else if (resp->no_body || resp->status == 204 || resp->status == 304) {
+        resp->state = R_DONE;
+    } else if (resp->chunked) {
+        resp->state = R_CHUNK_SIZE;
+    } else if (resp->has_length) {
+        resp->remaining = resp->content_len;
+        resp->state = (resp->remaining == 0) ? R_DONE : R_BODY;
+    } else {
+        resp->keep_alive = false;
+        resp->state = R_UNTIL_EOF;
+    }
+}
+
+/**
+ * @brief Parses the status line of a response.
+ * @details The line must start with the protocol HTTP/1.1 and a three digit status code.
+ * @param resp Response parser to be updated.
+ * @param line Status line without CRLF.
+ * @param len Length of the line.
+ * @return 0 on success, -1 if the line is invalid.
+ */
+static int parse_status(t_resp *resp, const char *line, size_t len) {
+    const char *protocol = "HTTP/1.1 ";
+    size_t plen = strlen(protocol);
+    if (len < plen + 3 || memcmp(line, protocol, plen) != 0) return -1;
+    int code = 0;
+    for (size_t i = plen; i < plen + 3; i++) {
+        if (line[i] < '0' || line[i] > '9') return -1;
+        code = code * 10 + line[i] - '0';
+    }
+    if (len > plen + 3 && line[plen + 3] != ' ') return -1;
+    resp->status = code;
+    size_t reason_len = (len > plen + 4) ? len - plen - 4 : 0;
+    if (reason_len >= HTTP_REASON_MAX) reason_len = HTTP_REASON_MAX - 1;
+    memcpy(resp->reason, line + plen + 4, reason_len);
+    resp->reason[reason_len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Parses a header line into the spans of its name and value.
+ * @param h Header to be updated.
+ * @param block Header block.
+ * @param off Offset of the line in the header block.
+ * @param len Length of the line without CRLF.
+ * @return 0 on success, -1 if the line is invalid.
+ */
+static int parse_field(t_header *h, const char *block, size_t off, size_t len) {
+    const char *colon = (const char *) memchr(block + off, ':', len);
+    if (colon == NULL || colon == block + off) return -1;
+    h->name.off = off;
+    h->name.len = colon - (block + off);
+    h->value.off = h->name.off + h->name.len + 1;
+    h->value.len = len - h->name.len - 1;
+    trim_span(block, &h->value);
+    return 0;
+}
+
+/**
+ * @brief Parses the value of a Content-Length header.
+ * @details Repeated headers must have the same value.
+ * @param block Header block.
+ * @param value Span of the value.
+ * @param has_length Whether an earlier header was parsed, updated to true.
+ * @param len Content-Length to be updated.
+ * @return 0 on success, -1 if the value is invalid.
+ */
+static int parse_length(const char *block, t_span value, bool *has_length, unsigned long long *len) {
+    unsigned long long num = 0;
+    if (value.len == 0) return -1;
+    for (size_t i = 0; i < value.len; i++) {
+        char c = block[value.off + i];
+        if (c < '0' || c > '9' || num > (~0ULL - 9) / 10) return -1;
+        num = num * 10 + c - '0';
+    }
+    if (*has_length && *len != num) return -1;
+    *len = num;
+    *has_length = true;
+    return 0;
+}
+
+/**
+ * @brief Parses a header line of a response.
+ * @details Records the name and value spans of the header. The framing headers Content-Length, Transfer-Encoding,
+ * Connection and Content-Encoding are evaluated right away.
+ * @param resp Response parser to be updated.
+ * @param block Header block.
+ * @param off Offset of the line in the header block.
+ * @param len Length of the line without CRLF.
+ * @return 0 on success, -1 if the line is invalid.
+ */
+static int parse_header(t_resp *resp, const char *block, size_t off, size_t len) {
+    t_header h;
+    if (parse_field(&h, block, off, len) == -1) return -1;
+    if (resp->header_c < HTTP_HEADER_MAX) resp->headers[resp->header_c++] = h;
+    if (span_is(block, h.name, "Content-Length")) {
+        if (parse_length(block, h.value, &resp->has_length, &resp->content_len) == -1) return -1;
+    } else if (span_is(block, h.name, "Transfer-Encoding")) {
+        resp->chunked = has_token(block, h.value, "chunked", true);
+    } else if (span_is(block, h.name, "Connection")) {
+        if (has_token(block, h.value, "close", false)) resp->keep_alive = false;
+    } else if (span_is(block, h.name, "Content-Encoding")) {
+        if (span_is(block, h.value, "gzip") || span_is(block, h.value, "x-gzip")) resp->encoding = ENC_GZIP;
+        else if (span_is(block, h.value, "deflate")) resp->encoding = ENC_DEFLATE;
+        else if (!span_is(block, h.value, "identity")) resp->encoding = ENC_OTHER;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a chunk size, chunk end or trailer line of a response.
+ * @param resp Response parser to be updated.
+ * @param line Line without CRLF.
+ * @param len Length of the line.
+ * @return 0 on success, -1 if the line is invalid.
+ */
+static int parse_chunk_line(t_resp *resp, const char *line, size_t len) {
+    if (resp->state == R_CHUNK_SIZE) {
+        unsigned long long size = 0;
+        size_t i = 0;
+        for (; i < len && isxdigit((unsigned char) line[i]); i++) {
+            if (size >> 60) return -1;
+            size = size * 16 + (isdigit((unsigned char) line[i]) ? line[i] - '0' : (tolower(line[i]) - 'a' + 10));
+        }
+        if (i == 0 || (i < len && line[i] != ';' && line[i] != ' ' && line[i] != '\t')) return -1;
+        resp->remaining = size;
+        resp->state = (size == 0) ? R_TRAILER : R_CHUNK_DATA;
+    } else if (resp->state == R_CHUNK_END) {
+        if (len != 0) return -1;
+        resp->state = R_CHUNK_SIZE;
+    } else if (len == 0) {
+        resp->state = R_DONE;
+    }
+    return 0;
+}
+
+long http_feed(t_resp *resp, const char *buf, size_t len, const t_sink *sink) {
+    size_t pos = 0;
+    while (pos < len && resp->state != R_DONE) {
+        if (resp->state == R_BODY || resp->state == R_CHUNK_DATA || resp->state == R_UNTIL_EOF) {
+            size_t n = len - pos;
+            if (resp->state != R_UNTIL_EOF && resp->remaining < n) n = resp->remaining;
+            if (sink->body(sink->arg, buf + pos, n) == -1) return -1;
+            pos += n;
+            http_skip(resp, n);
+            continue;
+        }
+        const char *lf = find_eol(buf + pos + resp->scan, len - pos - resp->scan);
+        if (lf == NULL) {
+            resp->scan = len - pos;
+            if (resp->scan >= HTTP_BLOCK_MAX) return -1;
+            break;
+        }
+        size_t end = lf - buf;
+        if (end - pos >= HTTP_BLOCK_MAX) return -1;
+        bool head = resp->state == R_STATUS || resp->state == R_HEADERS;
+        size_t start = head ? pos + resp->line : pos;
+        size_t n = end - start;
+        if (n > 0 && buf[end - 1] == '\r') n--;
+        resp->scan = end + 1 - pos;
+        if (!head) {
+            if (parse_chunk_line(resp, buf + start, n) == -1) return -1;
+            pos = end + 1;
+            resp->scan = 0;
+        } else if (resp->state == R_STATUS) {
+            if (parse_status(resp, buf + start, n) == -1) return -1;
+            resp->state = R_HEADERS;
+            resp->line = resp->scan;
+        } else if (n > 0) {
+            if (parse_header(resp, buf + pos, start - pos, n) == -1) return -1;
+            resp->line = resp->scan;
+        } else {
+            resp->scan = resp->line = 0;
+            start_body(resp);
+            if (resp->state != R_STATUS && sink->headers != NULL && sink->headers(sink->arg, resp, buf + pos) == -1) {
+                return -1;
+            }
+            pos = end + 1;
+        }
+    }
+    return pos;
+}
+
+/**
+ * @brief Finds a header by its name.
+ * @param headers Recorded headers.
+ * @param header_c Count of recorded headers.
+ * @param block Header block.
+ * @param name Name of the header, compared case-insensitively.
+ * @param len Pointer to be updated with the length of the value.
+ * @return Pointer to the value in the header block, NULL if there is no such header.
+ */
+static const char *find_header(const t_header *headers, size_t header_c, const char *block, const char *name,
+    size_t *len) {
+    for (size_t i = 0; i < header_c; i++) {
+        if (span_is(block, headers[i].name, name)) {
+            *len = headers[i].value.len;
+            return block + headers[i].value.off;
+        }
+    }
+    return NULL;
+}
+
+const char *http_header(const t_resp *resp, const char *block, const char *name, size_t *len) {
+    return find_header(resp->headers, resp->header_c, block, name, len);
+}
+
+bool http_header_has(const t_resp *resp, const char *block, const char *name, const char *token) {
+    for (size_t i = 0; i < resp->header_c; i++) {
+        if (span_is(block, resp->headers[i].name, name) && has_token(block, resp->headers[i].value, token, false)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Parses a decimal number at the start of a span.
+ * @param buf Bytes the span refers to.
+ * @param span Span to be updated to the bytes after the number.
+ * @param num Pointer to be updated with the number.
+ * @return 0 on success, -1 if there is no number or it overflows.
+ */
+static int parse_num(const char *buf, t_span *span, unsigned long long *num) {
+    size_t i = 0;
+    *num = 0;
+    for (; i < span->len && buf[span->off + i] >= '0' && buf[span->off + i] <= '9'; i++) {
+        if (*num > (~0ULL - 9) / 10) return -1;
+        *num = *num * 10 + buf[span->off + i] - '0';
+    }
+    span->off += i;
+    span->len -= i;
+    return (i > 0) ? 0 : -1;
+}
+
+int http_content_range(const t_resp *resp, const char *block, unsigned long long *first, unsigned long long *last,
+    unsigned long long *total) {
+    size_t len;
+    const char *value = http_header(resp, block, "Content-Range", &len);
+    const char *unit = "bytes ";
+    if (value == NULL || len < strlen(unit) || strncasecmp(value, unit, strlen(unit)) != 0) return -1;
+    t_span span = { value - block + strlen(unit), len - strlen(unit) };
+    if (parse_num(block, &span, first) == -1 || span.len == 0 || block[span.off] != '-') return -1;
+    span.off++;
+    span.len--;
+    if (parse_num(block, &span, last) == -1 || span.len == 0 || block[span.off] != '/' || *last < *first) return -1;
+    span.off++;
+    span.len--;
+    if (span.len == 1 && block[span.off] == '*') {
+        *total = (unsigned long long) -1;
+        return 0;
+    }
+    if (parse_num(block, &span, total) == -1 || span.len != 0 || *last >= *total) return -1;
+    return 0;
+}
+
+unsigned long long http_body_left(const t_resp *resp) {
+    if (resp->state == R_BODY || resp->state == R_CHUNK_DATA) return resp->remaining;
+    if (resp->state == R_UNTIL_EOF) return (unsigned long long) -1;
+    return 0;
+}
+
+void http_skip(t_resp *resp, size_t len) {
+    if (resp->state == R_UNTIL_EOF) return;
+    resp->remaining -= len;
+    if (resp->remaining == 0) resp->state = (resp->state == R_BODY) ? R_DONE : R_CHUNK_END;
+}
+
+int http_eof(t_resp *resp) {
+    if (resp->state == R_UNTIL_EOF) resp->state = R_DONE;
+    return (resp->state == R_DONE) ? 0 : -1;
+}
+
+/**
+ * @brief Parses the request line of a request.
+ * @details The line must consist of a method, a target and the protocol HTTP/1.x, separated by single spaces.
+ * @param req Request to be updated.
+ * @param block Header block.
+ * @param off Offset of the line in the header block.
+ * @param len Length of the line without CRLF.
+ * @return 0 on success, -1 if the line is invalid.
+ */
+static int parse_request_line(t_request *req, const char *block, size_t off, size_t len) {
+    const char *line = block + off;
+    const char *sp1 = (const char *) memchr(line, ' ', len);
+    if (sp1 == NULL || sp1 == line) return -1;
+    const char *target = sp1 + 1;
+    const char *sp2 = (const char *) memchr(target, ' ', len - (target - line));
+    if (sp2 == NULL || sp2 == target) return -1;
+    const char *version = sp2 + 1;
+    const char *protocol = "HTTP/1.";
+    size_t vlen = len - (version - line);
+    if (vlen != strlen(protocol) + 1 || memcmp(version, protocol, strlen(protocol)) != 0) return -1;
+    if (!isdigit((unsigned char) version[vlen - 1])) return -1;
+    t_span method = { off, sp1 - line };
+    req->method = span_is(block, method, "GET") ? M_GET : span_is(block, method, "HEAD") ? M_HEAD : M_OTHER;
+    req->target.off = target - block;
+    req->target.len = sp2 - target;
+    req->minor = version[vlen - 1] - '0';
+    req->keep_alive = req->minor >= 1;
+    return 0;
+}
+
+long http_parse_request(t_request *req, const char *buf, size_t len) {
+    memset(req, 0, sizeof(t_request));
+    bool has_length = false;
+    bool started = false;
+    size_t pos = 0;
+    while (true) {
+        const char *lf = find_eol(buf + pos, len - pos);
+        if (lf == NULL) return (len >= HTTP_BLOCK_MAX) ? -1 : 0;
+        size_t end = lf - buf;
+        if (end >= HTTP_BLOCK_MAX) return -1;
+        size_t n = end - pos;
+        if (n > 0 && buf[end - 1] == '\r') n--;
+        if (!started && n == 0) {
+            pos = end + 1;
+            continue;
+        }
+        if (!started) {
+            if (parse_request_line(req, buf, pos, n) == -1) return -1;
+            started = true;
+        } else if (n == 0) {
+            return end + 1;
+        } else {
+            t_header h;
+            if (parse_field(&h, buf, pos, n) == -1) return -1;
+            if (req->header_c < HTTP_HEADER_MAX) req->headers[req->header_c++] = h;
+            if (span_is(buf, h.name, "Content-Length")) {
+                if (parse_length(buf, h.value, &has_length, &req->content_len) == -1) return -1;
+            } else if (span_is(buf, h.name, "Transfer-Encoding")) {
+                req->chunked = true;
+            } else if (span_is(buf, h.name, "Connection")) {
+                if (has_token(buf, h.value, "close", false)) req->keep_alive = false;
+                else if (has_token(buf, h.value, "keep-alive", false)) req->keep_alive = true;
+            }
+        }
+        pos = end + 1;
+    }
+}
+
+const char *http_request_header(const t_request *req, const char *block, const char *name, size_t *len) {
+    return find_header(req->headers, req->header_c, block, name, len);
+}
+
+int http_range(const t_request *req, const char *block, unsigned long long size, const char *validator,
+    unsigned long long *first, unsigned long long *last) {
+    size_t len;
+    const char *value = http_request_header(req, block, "Range", &len);
+    const char *unit = "bytes=";
+    if (value == NULL || len < strlen(unit) || strncasecmp(value, unit, strlen(unit)) != 0) return -1;
+    if (memchr(value, ',', len) != NULL) return -1;
+    size_t guard_len;
+    const char *guard = http_request_header(req, block, "If-Range", &guard_len);
+    if (guard != NULL && (guard_len != strlen(validator) || memcmp(guard, validator, guard_len) != 0)) return -1;
+    t_span span = { value - block + strlen(unit), len - strlen(unit) };
+    trim_span(block, &span);
+    if (span.len > 0 && block[span.off] == '-') {
+        span.off++;
+        span.len--;
+        unsigned long long n;
+        if (parse_num(block, &span, &n) == -1 || span.len != 0) return -1;
+        if (n == 0 || size == 0) return 0;
+        *first = (n < size) ? size - n : 0;
+        *last = size - 1;
+        return 1;
+    }
+    if (parse_num(block, &span, first) == -1 || span.len == 0 || block[span.off] != '-') return -1;
+    span.off++;
+    span.len--;
+    *last = (unsigned long long) -1;
+    if (span.len > 0 && (parse_num(block, &span, last) == -1 || span.len != 0)) return -1;
+    if (*last < *first) return -1;
+    if (*first >= size) return 0;
+    if (*last >= size) *last = size - 1;
+    return 1;
+}
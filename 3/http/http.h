@@ -0,0 +1,286 @@
+/**
+ * Http module definitions.
+ * @brief Covers urls, requests and incremental parsing of responses.
+ * @details Nothing in this module reads from or writes to sockets. Requests are built into buffers and responses are
+ * parsed from whatever bytes have arrived, so the caller can drive any number of transfers from one event loop.<br>
+ * The serving side parses requests the same way: header lines are recorded as spans of the received header block.
+ * @file http.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define HTTP_PREFIX "http://" /**< Http protocol prefix for urls. */
+#define HTTP_BLOCK_MAX 65536 /**< Maximum length of a header block or a chunk size or trailer line. */
+#define HTTP_HEADER_MAX 64 /**< Maximum count of headers whose spans are recorded. */
+#define HTTP_REASON_MAX 64 /**< Maximum length of a stored reason phrase. */
+
+/**
+ * @brief Components of an url.
+ * @details All components point into the buffer of the url.
+ */
+typedef struct Url {
+    char *buf; /**< Copy of the url, split up into the components. */
+    char *server_host; /**< Host name of the server. */
+    char *server_path; /**< Path to resource on the server. */
+    char *server_args; /**< Request arguments passed to the server. */
+} t_url;
+
+/**
+ * @brief States of a response parser.
+ */
+typedef enum ResponseState {
+    R_STATUS, /**< Reading the status line. */
+    R_HEADERS, /**< Reading header lines. */
+    R_BODY, /**< Reading a body of known length. */
+    R_CHUNK_SIZE, /**< Reading the size line of a chunk. */
+    R_CHUNK_DATA, /**< Reading the data of a chunk. */
+    R_CHUNK_END, /**< Reading the CRLF after the data of a chunk. */
+    R_TRAILER, /**< Reading trailer lines after the last chunk. */
+    R_UNTIL_EOF, /**< Reading a body that ends when the connection is closed. */
+    R_DONE /**< The response is complete. */
+} t_rstate;
+
+/**
+ * @brief Content codings of a body.
+ */
+typedef enum Encoding {
+    ENC_IDENTITY, /**< No content coding. */
+    ENC_GZIP, /**< Gzip content coding. */
+    ENC_DEFLATE, /**< Deflate (zlib) content coding. */
+    ENC_OTHER /**< Any other content coding. */
+} t_encoding;
+
+/**
+ * @brief Methods of a request.
+ */
+typedef enum Method {
+    M_GET, /**< GET request. */
+    M_HEAD, /**< HEAD request. */
+    M_OTHER /**< Any other method. */
+} t_method;
+
+/**
+ * @brief Part of a header block.
+ * @details Offsets are relative to the start of the header block, so spans stay valid if the block is moved.
+ */
+typedef struct Span {
+    size_t off; /**< Offset of the first byte. */
+    size_t len; /**< Count of bytes. */
+} t_span;
+
+/**
+ * @brief Header of a response.
+ */
+typedef struct Header {
+    t_span name; /**< Name of the header. */
+    t_span value; /**< Value of the header, without surrounding whitespace. */
+} t_header;
+
+/**
+ * @brief Incremental parser of a response.
+ * @details Keeps everything that is needed to continue parsing when more bytes arrive. Nothing is copied out of the
+ * received bytes except the reason phrase, headers are recorded as spans of the header block.
+ */
+typedef struct Response {
+    t_rstate state; /**< Current state. */
+    int status; /**< Status code, 0 until the status line is parsed. */
+    char reason[HTTP_REASON_MAX]; /**< Reason phrase of the status line. */
+    bool keep_alive; /**< Whether the connection can be reused after the response. */
+    bool chunked; /**< Whether the body has chunked transfer encoding. */
+    bool has_length; /**< Whether the body has a Content-Length. */
+    bool no_body; /**< Whether the response has no body regardless of its headers (answer to a HEAD request). */
+    t_encoding encoding; /**< Content coding of the body. */
+    unsigned long long content_len; /**< Content-Length of the body. */
+    unsigned long long remaining; /**< Remaining bytes of the body or the current chunk. */
+    size_t scan; /**< Count of unconsumed bytes that were already scanned for a line end. */
+    size_t line; /**< Offset of the current line in the header block. */
+    t_header headers[HTTP_HEADER_MAX]; /**< Headers of the response (the first HTTP_HEADER_MAX). */
+    size_t header_c; /**< Count of recorded headers. */
+} t_resp;
+
+/**
+ * @brief Parsed request.
+ * @details Spans refer to the header block of the request. Nothing is copied out of it.
+ */
+typedef struct Request {
+    t_method method; /**< Request method. */
+    t_span target; /**< Request target, e.g. "/index.html?a=b". */
+    int minor; /**< Minor version of the protocol (HTTP/1.x). */
+    bool keep_alive; /**< Whether the connection can be reused after the response. */
+    bool chunked; /**< Whether the body has chunked transfer encoding. */
+    unsigned long long content_len; /**< Content-Length of the body, 0 if there is none. */
+    t_header headers[HTTP_HEADER_MAX]; /**< Headers of the request (the first HTTP_HEADER_MAX). */
+    size_t header_c; /**< Count of recorded headers. */
+} t_request;
+
+/**
+ * @brief Receiver of a parsed response.
+ */
+typedef struct Sink {
+    /**
+     * @brief Receives the headers of a response, once the header block is complete. May be NULL.
+     * @details Interim responses (status 1xx) are not passed.
+     * @param arg Argument of the sink.
+     * @param resp Response parser with the status, framing headers and header spans.
+     * @param block Header block the spans refer to, only valid during the call.
+     * @return 0 on success, -1 on error.
+     */
+    int (*headers)(void *arg, const t_resp *resp, const char *block);
+    /**
+     * @brief Receives body bytes (already without chunk framing).
+     * @param arg Argument of the sink.
+     * @param buf Body bytes.
+     * @param len Count of bytes.
+     * @return 0 on success, -1 on error.
+     */
+    int (*body)(void *arg, const char *buf, size_t len);
+    void *arg; /**< Argument of the sink. */
+} t_sink;
+
+/**
+ * @brief Parses details from an url.
+ * @details Validates and parses important components of an url, such as protocol, host, resource path and arguments.
+ * <br>
+ * Allocates the buffer of the url, which must be freed later (also on error).
+ * @param url Url to be updated with the components.
+ * @param url_with_protocol Url including the protocol prefix.
+ * @return 0 on success or if valid, -1 on error or if invalid.
+ */
+int parse_url_details(t_url *url, char *url_with_protocol);
+
+/**
+ * @brief Builds an http request.
+ * @details Builds a request that asks to keep the connection alive. Details are specified in the url.<br>
+ * Allocates the request, which must be freed later.
+ * @param dst Pointer to be updated with the request.
+ * @param len Pointer to be updated with the length of the request.
+ * @param url Url of the resource.
+ * @param method Request method, e.g. "GET" or "HEAD".
+ * @param fields Additional header lines, each terminated by CRLF, NULL if there are none.
+ * @return 0 on success, -1 on error.
+ */
+int build_request(char **dst, size_t *len, t_url *url, const char *method, const char *fields);
+
+/**
+ * @brief Initializes a response parser.
+ * @details The parser expects a body as announced by the headers. Set no_body afterwards if the request was HEAD.
+ * @param resp Response parser to be initialized.
+ */
+void http_init(t_resp *resp);
+
+/**
+ * @brief Parses received bytes of a response.
+ * @details Validates the response's protocol, status and if it is well-formed. The body is framed by its
+ * Content-Length or chunked transfer encoding and passed to the sink without the chunk framing.<br>
+ * Incomplete header blocks and lines are not consumed: they must be passed again at the start of the next call,
+ * followed by the bytes that arrived since. Already scanned bytes are not scanned again.<br>
+ * Stops at the end of the response, so bytes of a following response are not consumed.
+ * @param resp Response parser.
+ * @param buf Received bytes.
+ * @param len Count of received bytes.
+ * @param sink Receiver of the headers and the body.
+ * @return Count of consumed bytes on success, -1 on protocol errors or if the sink fails.
+ */
+long http_feed(t_resp *resp, const char *buf, size_t len, const t_sink *sink);
+
+/**
+ * @brief Finds a header of a response.
+ * @details Names are compared case-insensitively. Only valid while the header block is available.
+ * @param resp Response parser.
+ * @param block Header block.
+ * @param name Name of the header.
+ * @param len Pointer to be updated with the length of the value.
+ * @return Pointer to the value in the header block, NULL if there is no such header.
+ */
+const char *http_header(const t_resp *resp, const char *block, const char *name, size_t *len);
+
+/**
+ * @brief Checks whether a header of a response contains a token.
+ * @details The value is treated as comma-separated list, tokens are compared case-insensitively.
+ * @param resp Response parser.
+ * @param block Header block.
+ * @param name Name of the header.
+ * @param token Token.
+ * @return true if the header exists and contains the token, false otherwise.
+ */
+bool http_header_has(const t_resp *resp, const char *block, const char *name, const char *token);
+
+/**
+ * @brief Parses the Content-Range header of a response.
+ * @details Only byte ranges with a known first and last byte are accepted, the complete length may be unknown ("*").
+ * @param resp Response parser.
+ * @param block Header block.
+ * @param first Pointer to be updated with the offset of the first byte.
+ * @param last Pointer to be updated with the offset of the last byte.
+ * @param total Pointer to be updated with the complete length, (unsigned long long) -1 if it is unknown.
+ * @return 0 on success, -1 if the header is missing or invalid.
+ */
+int http_content_range(const t_resp *resp, const char *block, unsigned long long *first, unsigned long long *last,
+    unsigned long long *total);
+
+/**
+ * @brief Returns how many body bytes can be moved past the parser.
+ * @details Body bytes of a known length (the rest of a Content-Length body or of a chunk) and bodies that end with the
+ * connection need no parsing, so they can be moved to the output without passing through http_feed().
+ * @param resp Response parser.
+ * @return Count of bytes, (unsigned long long) -1 if the body ends with the connection, 0 if the next bytes must be
+ * parsed.
+ */
+unsigned long long http_body_left(const t_resp *resp);
+
+/**
+ * @brief Accounts for body bytes that were moved past the parser.
+ * @param resp Response parser.
+ * @param len Count of bytes, at most http_body_left().
+ */
+void http_skip(t_resp *resp, size_t len);
+
+/**
+ * @brief Handles the end of the connection of a response.
+ * @details Completes a body that is read until the connection is closed.
+ * @param resp Response parser.
+ * @return 0 if the response is complete, -1 if it was cut off.
+ */
+int http_eof(t_resp *resp);
+
+/**
+ * @brief Parses the header block of a request.
+ * @details Validates the request line and the header lines. Empty lines before the request line are skipped. The
+ * framing headers Content-Length, Transfer-Encoding and Connection are evaluated right away.<br>
+ * Unlike responses, requests are parsed in one go: the header block is parsed again once more bytes have arrived.
+ * @param req Request to be updated.
+ * @param buf Received bytes, starting with the request.
+ * @param len Count of received bytes.
+ * @return Length of the header block (incl. the empty line) if it is complete, 0 if it is incomplete, -1 if it is
+ * invalid or longer than HTTP_BLOCK_MAX.
+ */
+long http_parse_request(t_request *req, const char *buf, size_t len);
+
+/**
+ * @brief Finds a header of a request.
+ * @details Names are compared case-insensitively.
+ * @param req Request.
+ * @param block Header block.
+ * @param name Name of the header.
+ * @param len Pointer to be updated with the length of the value.
+ * @return Pointer to the value in the header block, NULL if there is no such header.
+ */
+const char *http_request_header(const t_request *req, const char *block, const char *name, size_t *len);
+
+/**
+ * @brief Parses the Range header of a request.
+ * @details Only a single byte range is supported ("bytes=a-b", "bytes=a-" or "bytes=-n"), the last byte is limited
+ * to the resource. A range guarded by If-Range only applies if the header matches the validator of the resource.
+ * @param req Request.
+ * @param block Header block.
+ * @param size Length of the resource.
+ * @param validator Strong validator (ETag) of the resource.
+ * @param first Pointer to be updated with the offset of the first byte.
+ * @param last Pointer to be updated with the offset of the last byte.
+ * @return 1 if the range is satisfiable, 0 if it is not (status 416), -1 if the whole resource is to be sent.
+ */
+int http_range(const t_request *req, const char *block, unsigned long long size, const char *validator,
+    unsigned long long *first, unsigned long long *last);
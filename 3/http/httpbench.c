@@ -0,0 +1,557 @@
+/**
+ * Httpbench module.
+ * @brief Main entry point for the http client benchmark.
+ * @details Starts the test server (see testserver.c) on a free loopback port and downloads generated resources with
+ * the client in several modes:<br>
+ * single: one client process per request,<br>
+ * keepalive: all requests over one kept-alive connection,<br>
+ * pipelined: all requests over one connection with pipelining,<br>
+ * concurrent: all requests over several connections at once,<br>
+ * ranged: one large resource in parts over several connections,<br>
+ * batch: a url list in batch mode with a small window, whose hosts run out of jobs and get new ones later.<br>
+ * For each mode, the wall time and the CPU time of the client processes are reported, along with requests and
+ * megabytes per second. Every downloaded body is checked against the generated content. Latency, bandwidth and
+ * chunked transfer encoding of the server are set with -d, -r and -k.<br>
+ * With -F, the resources are written to files and served by the static-file server (see server.c) instead.<br>
+ * Results are printed as CSV to <strong>stdout</strong>, so they can be compared across builds.
+ * @file httpbench.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "gen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#define DEFAULT_CLIENT "./client" /**< Default path to the client program. */
+#define DEFAULT_SERVER "./testserver" /**< Default path to the test server program. */
+#define DEFAULT_COUNT 200 /**< Default count of requests per mode. */
+#define DEFAULT_SIZE 16384 /**< Default length of the requested resources. */
+#define DEFAULT_BIG (64LL << 20) /**< Default length of the resource of the ranged mode. */
+#define CONCURRENCY "16" /**< Count of connections of the concurrent mode. */
+#define PIPE_DEPTH "16" /**< Pipeline depth of the pipelined mode. */
+#define RANGE_PARTS "8" /**< Count of parts of the ranged mode. */
+#define BATCH_WINDOW "2" /**< Window of the batch mode. */
+#define BATCH_DELAY 20 /**< Delay in milliseconds of the slow requests of the batch mode. */
+#define BATCH_TIMEOUT 60 /**< Seconds after which the client of the batch mode is killed. */
+#define ARG_MAX_C 16 /**< Maximum count of arguments of a client run. */
+#define M_N 6 /**< Number of modes. */
+#define P_N 2 /**< Number of pipe ends. */
+
+/**
+ * @brief Program options.
+ * @details The program configurations that are specified by the arguments.
+ */
+typedef struct Options {
+    char *client; /**< Path to the client program. */
+    char *server; /**< Path to the test server program. */
+    long long count; /**< Count of requests per mode (except ranged). */
+    long long size; /**< Length of the requested resources. */
+    long long big; /**< Length of the resource of the ranged mode. */
+    char *delay; /**< Delay of each response in milliseconds (passed to the server), NULL for none. */
+    char *rate; /**< Bytes per second of each response (passed to the server), NULL for unlimited. */
+    char *chunk; /**< Chunk size of bodies (passed to the server), NULL for Content-Length. */
+    char *mode; /**< Name of the only mode to be benchmarked, NULL for all. */
+    char *files; /**< Path to the static-file server, NULL if the test server is used. */
+} t_opt;
+
+/**
+ * @brief Measurements of a mode.
+ */
+typedef struct Result {
+    double wall_ms; /**< Elapsed wall clock time of the client runs. */
+    double cpu_ms; /**< User and system CPU time of the client processes. */
+    long long requests; /**< Count of requests. */
+    long long bytes; /**< Count of body bytes. */
+} t_result;
+
+/**
+ * @brief Shared state of the benchmark.
+ */
+typedef struct Bench {
+    const t_opt *opts; /**< Program options. */
+    char port[8]; /**< Port of the test server. */
+    char dir[32]; /**< Temporary directory. */
+    char www[64]; /**< Document root of the static-file server. */
+    char out[64]; /**< Path to the output file of the client. */
+    char list[64]; /**< Path to the url list of the client. */
+    unsigned timeout; /**< Seconds after which the client is killed, 0 for none. */
+} t_bench;
+
+/**
+ * @brief Benchmark mode.
+ */
+typedef struct Mode {
+    char *name; /**< Name of the mode, as passed to -m. */
+    int (*run)(t_bench *bench, t_result *res); /**< Runs the mode and checks its output. */
+} t_mode;
+
+static char *prog_name; /**< The program's name. */
+
+/**
+ * @brief Prints the usage of the program and exits.
+ * @details Prints to <strong>stderr</strong> and exits with <strong>EXIT_FAILURE</strong>.<br>
+ * Used global variables: prog_name
+ */
+static void usage(void) {
+    fprintf(stderr, "Usage: %s [-c CLIENT] [-s SERVER] [-n COUNT] [-b SIZE] [-B BIG] [-d DELAY_MS] [-r RATE] "
+        "[-k CHUNK] [-m MODE] [-F FILE_SERVER]\n", prog_name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Traces an error.
+ * @details Prints to stderr that a function was failing.<br>
+ * Used global variables: prog_name
+ * @param fun_name Name of the failed function.
+ * @return -1
+ */
+static int t_err(char *fun_name) {
+    fprintf(stderr, "[%s] %s failed: %s\n", prog_name, fun_name, strerror(errno));
+    return -1;
+}
+
+/**
+ * @brief Parses a positive number argument.
+ * @details Might exit the program with <strong>EXIT_FAILURE</strong> if the argument is invalid.
+ * @param src Argument string.
+ * @return Parsed number.
+ */
+static long long parse_num(char *src) {
+    char *end = NULL;
+    errno = 0;
+    long long num = strtoll(src, &end, 10);
+    if (end == src || *end != '\0' || num <= 0 || errno != 0) usage();
+    return num;
+}
+
+/**
+ * @brief Parses the program arguments.
+ * @details Might exit the program with <strong>EXIT_FAILURE</strong> if arguments are invalid.
+ * @param opts Pointer to program options.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ */
+static void parse_args(t_opt *opts, int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:s:n:b:B:d:r:k:m:F:")) != -1) {
+        switch (opt) {
+            case 'c': opts->client = optarg; break;
+            case 's': opts->server = optarg; break;
+            case 'n': opts->count = parse_num(optarg); break;
+            case 'b': opts->size = parse_num(optarg); break;
+            case 'B': opts->big = parse_num(optarg); break;
+            case 'd': parse_num(optarg), opts->delay = optarg; break;
+            case 'r': parse_num(optarg), opts->rate = optarg; break;
+            case 'k': parse_num(optarg), opts->chunk = optarg; break;
+            case 'm': opts->mode = optarg; break;
+            case 'F': opts->files = optarg; break;
+            case '?':
+            default: usage();
+        }
+    }
+    if (optind != argc) usage();
+    if (opts->files != NULL && (opts->delay != NULL || opts->rate != NULL || opts->chunk != NULL)) usage();
+}
+
+/**
+ * @brief Writes a resource with generated content to the document root.
+ * @details The name of the file is its length, like the path of the test server.
+ * @param bench Benchmark.
+ * @param size Length of the resource.
+ * @return 0 on success, -1 on error.
+ */
+static int write_resource(t_bench *bench, long long size) {
+    char path[96];
+    snprintf(path, sizeof(path), "%s/%lld", bench->www, size);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) return t_err("open");
+    static char buf[1 << 16];
+    for (long long off = 0; off < size;) {
+        size_t len = (size - off < (long long) sizeof(buf)) ? (size_t) (size - off) : sizeof(buf);
+        gen_fill(buf, off, len);
+        ssize_t n = write(fd, buf, len);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) {
+            close(fd);
+            return t_err("write");
+        }
+        off += n;
+    }
+    close(fd);
+    return 0;
+}
+
+/**
+ * @brief Removes the document root.
+ * @param bench Benchmark.
+ */
+static void remove_resources(t_bench *bench) {
+    char path[96];
+    snprintf(path, sizeof(path), "%s/%lld", bench->www, bench->opts->size);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/%lld", bench->www, bench->opts->big);
+    unlink(path);
+    rmdir(bench->www);
+}
+
+/**
+ * @brief Starts the test server or the static-file server.
+ * @details The server listens on a free port, which it prints as its first line of output. The static-file server
+ * gets a document root with both resources.
+ * @param bench Benchmark, its port is updated.
+ * @return Process id of the server, -1 on error.
+ */
+static pid_t start_server(t_bench *bench) {
+    const t_opt *opts = bench->opts;
+    char *argv[ARG_MAX_C] = { opts->server, "-p", "0" };
+    int argc = 3;
+    if (opts->delay != NULL) argv[argc++] = "-d", argv[argc++] = opts->delay;
+    if (opts->rate != NULL) argv[argc++] = "-r", argv[argc++] = opts->rate;
+    if (opts->chunk != NULL) argv[argc++] = "-c", argv[argc++] = opts->chunk;
+    if (opts->files != NULL) {
+        bool big = opts->mode == NULL || strcmp(opts->mode, "ranged") == 0;
+        if (
+            mkdir(bench->www, 0755) == -1 ||
+            write_resource(bench, opts->size) == -1 ||
+            (big && write_resource(bench, opts->big) == -1)
+        ) return t_err("start_server");
+        argv[0] = opts->files;
+        argv[argc++] = bench->www;
+    }
+    int pfd[P_N];
+    if (pipe(pfd) == -1) return t_err("pipe");
+    pid_t pid = fork();
+    switch (pid) {
+        case -1:
+            return t_err("fork");
+        case 0:
+            close(pfd[0]);
+            if (dup2(pfd[1], STDOUT_FILENO) == -1) _exit(EXIT_FAILURE);
+            close(pfd[1]);
+            execv(argv[0], argv);
+            t_err("execv");
+            _exit(EXIT_FAILURE);
+        default:
+            break;
+    }
+    close(pfd[1]);
+    size_t len = 0;
+    while (len + 1 < sizeof(bench->port)) {
+        ssize_t n = read(pfd[0], bench->port + len, 1);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0 || bench->port[len] == '\n') break;
+        len++;
+    }
+    close(pfd[0]);
+    bench->port[len] = '\0';
+    if (len == 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+        errno = ECONNREFUSED;
+        return t_err("start_server");
+    }
+    return pid;
+}
+
+/**
+ * @brief Runs the client once and measures it.
+ * @details Output of the client goes to the output file of the benchmark, unless the arguments start with -d. The
+ * client is killed after the timeout of the benchmark (if set), so a hanging client fails the run.
+ * @param bench Benchmark.
+ * @param args Null terminated arguments after the port and output options.
+ * @param res Result, the run is added to it.
+ * @return 0 on success, -1 on error or if the client failed.
+ */
+static int run_client(t_bench *bench, char **args, t_result *res) {
+    char *argv[ARG_MAX_C] = { bench->opts->client, "-p", bench->port };
+    int argc = 3;
+    if (*args == NULL || strcmp(*args, "-d") != 0) argv[argc++] = "-o", argv[argc++] = bench->out;
+    while (*args != NULL && argc + 1 < ARG_MAX_C) argv[argc++] = *args++;
+    argv[argc] = NULL;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    switch (pid) {
+        case -1:
+            return t_err("fork");
+        case 0:
+            alarm(bench->timeout);
+            execv(argv[0], argv);
+            t_err("execv");
+            _exit(EXIT_FAILURE);
+        default:
+            break;
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == -1) return t_err("wait4");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    res->wall_ms += (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    res->cpu_ms += (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 +
+        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+    return (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) ? 0 : -1;
+}
+
+/**
+ * @brief Checks an output file of the client.
+ * @details The output must consist of <strong>count</strong> complete resources of length <strong>size</strong>.
+ * @param path Path to the output file.
+ * @param count Count of resources.
+ * @param size Length of a resource.
+ * @return 0 if the output is correct, -1 otherwise.
+ */
+static int check_file(const char *path, long long count, long long size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return t_err("open");
+    static char buf[1 << 16];
+    long long pos = 0;
+    int err = 0;
+    while (err == 0) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) err = t_err("read");
+        if (n <= 0) break;
+        for (ssize_t i = 0; i < n && err == 0;) {
+            long long off = pos % size;
+            size_t len = (size - off < n - i) ? (size_t) (size - off) : (size_t) (n - i);
+            if (!gen_check(buf + i, off, len)) err = -1;
+            i += len;
+            pos += len;
+        }
+    }
+    close(fd);
+    return (err == 0 && pos == count * size) ? 0 : -1;
+}
+
+/**
+ * @brief Checks the output file of the benchmark (see check_file()).
+ * @param bench Benchmark.
+ * @param count Count of resources.
+ * @param size Length of a resource.
+ * @return 0 if the output is correct, -1 otherwise.
+ */
+static int check_output(t_bench *bench, long long count, long long size) {
+    return check_file(bench->out, count, size);
+}
+
+/**
+ * @brief Writes the url list of the benchmark.
+ * @details Every url has a distinct query, so no two requests are alike.
+ * @param bench Benchmark.
+ * @return 0 on success, -1 on error.
+ */
+static int write_list(t_bench *bench) {
+    FILE *fp = fopen(bench->list, "w");
+    if (fp == NULL) return t_err("fopen");
+    for (long long i = 0; i < bench->opts->count; i++) {
+        fprintf(fp, "http://127.0.0.1/%lld?i=%lld\n", bench->opts->size, i);
+    }
+    if (fclose(fp) == EOF) return t_err("fclose");
+    return 0;
+}
+
+/**
+ * @brief Runs the single mode: one client process per request.
+ * @param bench Benchmark.
+ * @param res Result to be updated.
+ * @return 0 on success, -1 on error.
+ */
+static int run_single(t_bench *bench, t_result *res) {
+    char url[64];
+    char *args[] = { url, NULL };
+    for (long long i = 0; i < bench->opts->count; i++) {
+        snprintf(url, sizeof(url), "http://127.0.0.1/%lld?i=%lld", bench->opts->size, i);
+        if (run_client(bench, args, res) == -1 || check_output(bench, 1, bench->opts->size) == -1) return -1;
+    }
+    res->requests = bench->opts->count;
+    res->bytes = bench->opts->count * bench->opts->size;
+    return 0;
+}
+
+/**
+ * @brief Runs a mode that downloads the url list in one client process.
+ * @param bench Benchmark.
+ * @param res Result to be updated.
+ * @param conns Maximum count of connections.
+ * @param depth Pipeline depth.
+ * @return 0 on success, -1 on error.
+ */
+static int run_list(t_bench *bench, t_result *res, char *conns, char *depth) {
+    char *args[] = { "-c", conns, "-P", depth, "-i", bench->list, NULL };
+    if (run_client(bench, args, res) == -1 || check_output(bench, bench->opts->count, bench->opts->size) == -1) {
+        return -1;
+    }
+    res->requests = bench->opts->count;
+    res->bytes = bench->opts->count * bench->opts->size;
+    return 0;
+}
+
+/**
+ * @brief Runs the keepalive mode: all requests over one connection, one at a time.
+ * @param bench Benchmark.
+ * @param res Result to be updated.
+ * @return 0 on success, -1 on error.
+ */
+static int run_keepalive(t_bench *bench, t_result *res) {
+    return run_list(bench, res, "1", "1");
+}
+
+/**
+ * @brief Runs the pipelined mode: all requests over one connection with pipelining.
+ * @param bench Benchmark.
+ * @param res Result to be updated.
+ * @return 0 on success, -1 on error.
+ */
+static int run_pipelined(t_bench *bench, t_result *res) {
+    return run_list(bench, res, "1", PIPE_DEPTH);
+}
+
+/**
+ * @brief Runs the concurrent mode: all requests over several connections at once.
+ * @param bench Benchmark.
+ * @param res Result to be updated.
+ * @return 0 on success, -1 on error.
+ */
+static int run_concurrent(t_bench *bench, t_result *res) {
+    return run_list(bench, res, CONCURRENCY, "1");
+}
+
+/**
+ * @brief Runs the ranged mode: one large resource in parts over several connections.
+ * @param bench Benchmark.
+ * @param res Result to be updated.
+ * @return 0 on success, -1 on error.
+ */
+static int run_ranged(t_bench *bench, t_result *res) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://127.0.0.1/%lld", bench->opts->big);
+    char *args[] = { "-c", RANGE_PARTS, "-j", RANGE_PARTS, url, NULL };
+    if (run_client(bench, args, res) == -1 || check_output(bench, 1, bench->opts->big) == -1) return -1;
+    res->requests = 1;
+    res->bytes = bench->opts->big;
+    return 0;
+}
+
+/**
+ * @brief Runs the batch mode: a url list in batch mode with a small window.
+ * @details Urls alternate between two names of the loopback host in groups of four: a fast request to the first name,
+ * two delayed ones to the second and another fast one to the first. While the delayed requests are in the window, the
+ * first host runs out of jobs, the fourth url queues a job on it again. Every url requests a distinct length, so each
+ * body lands in its own file of the output directory. Needs the test server, with -F the mode is skipped.
+ * @param bench Benchmark.
+ * @param res Result to be updated.
+ * @return 0 on success, -1 on error.
+ */
+static int run_batch(t_bench *bench, t_result *res) {
+    if (bench->opts->files != NULL) return 0;
+    char list[96], dir[96], manifest[96], path[128];
+    snprintf(list, sizeof(list), "%s/batch", bench->dir);
+    snprintf(dir, sizeof(dir), "%s/batch.out", bench->dir);
+    snprintf(manifest, sizeof(manifest), "%s/batch.tsv", bench->dir);
+    long long count = bench->opts->count;
+    long long size = bench->opts->size;
+    FILE *fp = fopen(list, "w");
+    if (fp == NULL) return t_err("fopen");
+    for (long long i = 0; i < count; i++) {
+        if (i % 4 == 1 || i % 4 == 2) {
+            fprintf(fp, "http://localhost/%lld?delay=%d\n", size + i, BATCH_DELAY);
+        } else {
+            fprintf(fp, "http://127.0.0.1/%lld\n", size + i);
+        }
+    }
+    if (fclose(fp) == EOF) return t_err("fclose");
+    if (mkdir(dir, 0755) == -1) return t_err("mkdir");
+    char *args[] = { "-d", dir, "-m", manifest, "-w", BATCH_WINDOW, "-i", list, NULL };
+    bench->timeout = BATCH_TIMEOUT;
+    int err = run_client(bench, args, res);
+    bench->timeout = 0;
+    for (long long i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/%lld", dir, size + i);
+        if (err == 0 && check_file(path, 1, size + i) == -1) err = -1;
+        unlink(path);
+    }
+    rmdir(dir);
+    unlink(manifest);
+    unlink(list);
+    if (err == -1) return -1;
+    res->requests = count;
+    res->bytes = count * size + count * (count - 1) / 2;
+    return 0;
+}
+
+static const t_mode modes[M_N] = {
+    { "single", run_single },
+    { "keepalive", run_keepalive },
+    { "pipelined", run_pipelined },
+    { "concurrent", run_concurrent },
+    { "ranged", run_ranged },
+    { "batch", run_batch }
+}; /**< All modes. */
+
+/**
+ * @brief Entry point of the benchmark.
+ * @details Starts the test server, runs every mode (or the one passed with -m) and prints one CSV line per mode to
+ * <strong>stdout</strong>. The server and the temporary files are removed afterwards.<br>
+ * Exits with <strong>EXIT_FAILURE</strong> if any run failed or downloaded wrong content.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ * @return <strong>EXIT_SUCCESS</strong> if all downloads are correct.
+ */
+int main(int argc, char **argv) {
+    prog_name = argv[0];
+    t_opt opts = {
+        DEFAULT_CLIENT, DEFAULT_SERVER, DEFAULT_COUNT, DEFAULT_SIZE, DEFAULT_BIG, NULL, NULL, NULL, NULL, NULL
+    };
+    parse_args(&opts, argc, argv);
+    t_bench bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.opts = &opts;
+    strcpy(bench.dir, "/tmp/httpbench.XXXXXX");
+    if (mkdtemp(bench.dir) == NULL) {
+        t_err("mkdtemp");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(bench.out, sizeof(bench.out), "%s/out", bench.dir);
+    snprintf(bench.list, sizeof(bench.list), "%s/list", bench.dir);
+    snprintf(bench.www, sizeof(bench.www), "%s/www", bench.dir);
+    pid_t server = (write_list(&bench) == 0) ? start_server(&bench) : -1;
+    int failed = server == -1;
+    if (!failed) {
+        printf("mode,requests,body_bytes,wall_ms,cpu_ms,req_per_s,mb_per_s,check\n");
+        fflush(stdout);
+    }
+    for (int i = 0; i < M_N && !failed; i++) {
+        if (opts.mode != NULL && strcmp(opts.mode, modes[i].name) != 0) continue;
+        t_result res = { 0, 0, 0, 0 };
+        bool ok = modes[i].run(&bench, &res) == 0;
+        double secs = res.wall_ms / 1e3;
+        printf(
+            "%s,%lld,%lld,%.3f,%.3f,%.1f,%.2f,%s\n",
+            modes[i].name, res.requests, res.bytes, res.wall_ms, res.cpu_ms,
+            (secs > 0) ? res.requests / secs : 0, (secs > 0) ? res.bytes / secs / 1e6 : 0, ok ? "ok" : "fail"
+        );
+        fflush(stdout);
+        if (!ok) failed = 1;
+    }
+    if (server != -1) {
+        kill(server, SIGTERM);
+        waitpid(server, NULL, 0);
+    }
+    unlink(bench.out);
+    unlink(bench.list);
+    if (opts.files != NULL) remove_resources(&bench);
+    rmdir(bench.dir);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
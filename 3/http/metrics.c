@@ -0,0 +1,65 @@
+/**
+ * Metrics module.
+ * @brief Implementation of the metrics module definitions.
+ * @file metrics.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "metrics.h"
+#include "misc.h"
+#include <string.h>
+#include <errno.h>
+
+#define PHASE_C 6 /**< Count of reported phases of a request. */
+
+/**
+ * @brief Prints a string as a JSON string literal.
+ * @param fp Stream.
+ * @param s String.
+ */
+static void print_json_string(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char) *s;
+        if (c == '"' || c == '\\') fprintf(fp, "\\%c", c);
+        else if (c < 0x20) fprintf(fp, "\\u%04x", c);
+        else fputc(c, fp);
+    }
+    fputc('"', fp);
+}
+
+int metrics_format(t_mformat *dst, const char *name) {
+    if (strcmp(name, "text") == 0) *dst = METRICS_TEXT;
+    else if (strcmp(name, "json") == 0) *dst = METRICS_JSON;
+    else {
+        errno = EINVAL;
+        return m_err("Timing format must be text or json");
+    }
+    return 0;
+}
+
+void metrics_print(FILE *fp, t_mformat format, const char *method, const char *url, const t_timing *t) {
+    static const char *names[PHASE_C] = { "resolve", "connect", "send", "wait", "headers", "body" };
+    long long ends[PHASE_C] = { t->resolved, t->connected, t->sent, t->first_byte, t->headers, t->done };
+    double ms[PHASE_C];
+    long long prev = t->start;
+    for (int i = 0; i < PHASE_C; i++) {
+        if (ends[i] < prev) ends[i] = prev;
+        ms[i] = (ends[i] - prev) / 1000.0;
+        prev = ends[i];
+    }
+    double total = (prev - t->start) / 1000.0;
+    double rate = (prev > t->start) ? t->bytes * 1e6 / (prev - t->start) : 0;
+    if (format == METRICS_JSON) {
+        fprintf(fp, "{\"method\":\"%s\",\"url\":", method);
+        print_json_string(fp, url);
+        fprintf(fp, ",\"status\":%d,\"conn\":%lu,\"reused\":%s", t->status, t->conn, t->reused ? "true" : "false");
+        for (int i = 0; i < PHASE_C; i++) fprintf(fp, ",\"%s_ms\":%.3f", names[i], ms[i]);
+        fprintf(fp, ",\"total_ms\":%.3f,\"bytes\":%llu,\"bytes_per_sec\":%.0f}\n", total, t->bytes, rate);
+        return;
+    }
+    fprintf(fp, "%-4s %s %d conn %lu%s\n ", method, url, t->status, t->conn, t->reused ? " (reused)" : "");
+    for (int i = 0; i < PHASE_C; i++) fprintf(fp, " %s %.3f", names[i], ms[i]);
+    fprintf(fp, " total %.3f ms, %llu bytes, %.2f MB/s\n", total, t->bytes, rate / 1e6);
+}
@@ -0,0 +1,61 @@
+/**
+ * Metrics module definitions.
+ * @brief Covers the timing report of requests.
+ * @details The engine records when each phase of a request ended, as monotonic timestamps taken at events it handles
+ * anyway (reading the clock needs no system call). When a response is complete, the phases are reported as
+ * durations: resolving and connecting (zero on a reused connection), sending the request, waiting for the first byte
+ * of the response (which includes earlier responses on a pipelined connection), receiving the headers and receiving
+ * the body. The throughput is the count of received body bytes per total duration. Records are either text lines or
+ * one JSON object per line.
+ * @file metrics.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @brief Formats of the timing report.
+ */
+typedef enum MetricsFormat {
+    METRICS_OFF, /**< No report. */
+    METRICS_TEXT, /**< Human-readable text lines. */
+    METRICS_JSON /**< JSON lines. */
+} t_mformat;
+
+/**
+ * @brief Timestamps (see now_us()) and counters of a request, timestamps are 0 if not reached.
+ */
+typedef struct Timing {
+    long long start; /**< Time the connection was opened, or the request was queued on a reused connection. */
+    long long resolved; /**< Time the addresses of the host were available. */
+    long long connected; /**< Time the connection was established. */
+    long long sent; /**< Time the request was sent completely. */
+    long long first_byte; /**< Time the first byte of the response arrived. */
+    long long headers; /**< Time the header block of the response was complete. */
+    long long done; /**< Time the response was complete. */
+    unsigned long long bytes; /**< Count of received body bytes (before decoding). */
+    int status; /**< Status of the response. */
+    unsigned long conn; /**< Number of the connection, counted from 1. */
+    bool reused; /**< Whether the connection served an earlier response. */
+} t_timing;
+
+/**
+ * @brief Parses the name of a report format.
+ * @param dst Format to be updated.
+ * @param name "text" or "json".
+ * @return 0 on success, -1 if the name is unknown.
+ */
+int metrics_format(t_mformat *dst, const char *name);
+
+/**
+ * @brief Prints the record of a complete request.
+ * @details Missing timestamps count as the previous one, so their phase is reported as zero.
+ * @param fp Stream the record is printed to.
+ * @param format Report format (not METRICS_OFF).
+ * @param method Request method.
+ * @param url Requested url.
+ * @param t Timing of the request.
+ */
+void metrics_print(FILE *fp, t_mformat format, const char *method, const char *url, const t_timing *t);
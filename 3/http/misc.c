@@ -13,6 +13,7 @@
 #include <string.h>
 #include <limits.h>
 #include <ctype.h>
+#include <time.h>
 
 int m_err(char *msg) {
     fprintf(stderr, "[%s] Error: %s\n", prog_name, msg);
@@ -46,3 +47,9 @@ int parse_int(int *dst, char *src) {
     if (dst != NULL) *dst = (int) num;
     return 0;
 }
+
+long long now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
@@ -9,7 +9,7 @@
 
 #include <stdbool.h>
 
-char *prog_name; /**> The programs name. */
+extern char *prog_name; /**> The programs name. */
 
 /**
  * @brief Logs an error.
@@ -45,3 +45,9 @@ void e_err(char *fun_name);
  * @return 0 on success and if valid, -1 on error or if invalid.
  */
 int parse_int(int *dst, char *src);
+
+/**
+ * @brief Reads a monotonic clock.
+ * @return Current time in microseconds since an unspecified point.
+ */
+long long now_us(void);
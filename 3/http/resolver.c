@@ -0,0 +1,109 @@
+/**
+ * Resolver module.
+ * @brief Implementation of the resolver module definitions.
+ * @file resolver.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "resolver.h"
+#include "misc.h"
+#include <string.h>
+#include <netdb.h>
+
+/**
+ * @brief Finds a cached address.
+ * @param res Cached addresses.
+ * @param addr Address to be found.
+ * @return Pointer to the cached address, NULL if it is not cached.
+ */
+static t_addr *find_addr(t_resolved *res, const t_addr *addr) {
+    for (int i = 0; i < res->addr_c; i++) {
+        if (res->addrs[i].len == addr->len && memcmp(&res->addrs[i].sa, &addr->sa, addr->len) == 0) {
+            return &res->addrs[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Ranks an address for ordering.
+ * @param addr Address.
+ * @return 0 if it connected, 1 if it was never tried, 2 if its last connect failed.
+ */
+static int rank(const t_addr *addr) {
+    if (addr->fails > 0) return 2;
+    return (addr->connect_us > 0) ? 0 : 1;
+}
+
+int resolver_lookup(t_resolved *res, const char *name, const char *port, long long now) {
+    if (res->resolved_us != 0 && now - res->resolved_us < RESOLVER_TTL * 1000000LL) return 0;
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *ai;
+    if (getaddrinfo(name, port, &hints, &ai) != 0) {
+        if (res->addr_c == 0) return t_err("getaddrinfo");
+        res->resolved_us = now;
+        return 0;
+    }
+    struct addrinfo *family[2][RESOLVER_ADDR_MAX];
+    int family_c[2] = { 0, 0 };
+    for (struct addrinfo *p = ai; p != NULL; p = p->ai_next) {
+        if (p->ai_addrlen > sizeof(struct sockaddr_storage)) continue;
+        int f = p->ai_family != ai->ai_family;
+        if (family_c[f] < RESOLVER_ADDR_MAX) family[f][family_c[f]++] = p;
+    }
+    t_resolved next;
+    memset(&next, 0, sizeof(next));
+    for (int i = 0; next.addr_c < RESOLVER_ADDR_MAX && (i < family_c[0] || i < family_c[1]); i++) {
+        for (int f = 0; f < 2 && next.addr_c < RESOLVER_ADDR_MAX; f++) {
+            if (i >= family_c[f]) continue;
+            t_addr *addr = &next.addrs[next.addr_c++];
+            memcpy(&addr->sa, family[f][i]->ai_addr, family[f][i]->ai_addrlen);
+            addr->len = family[f][i]->ai_addrlen;
+            addr->family = family[f][i]->ai_family;
+            t_addr *old = find_addr(res, addr);
+            if (old != NULL) {
+                addr->connect_us = old->connect_us;
+                addr->fails = old->fails;
+            }
+        }
+    }
+    freeaddrinfo(ai);
+    if (next.addr_c == 0) return m_err("No usable address");
+    next.resolved_us = now;
+    *res = next;
+    return 0;
+}
+
+int resolver_order(const t_resolved *res, t_addr *dst) {
+    for (int i = 0; i < res->addr_c; i++) {
+        t_addr addr = res->addrs[i];
+        int j = i;
+        for (; j > 0; j--) {
+            const t_addr *prev = &dst[j - 1];
+            int r = rank(&addr);
+            int p = rank(prev);
+            bool before = r < p || (r == p && r == 0 && addr.connect_us < prev->connect_us) ||
+                (r == p && r == 2 && addr.fails < prev->fails);
+            if (!before) break;
+            dst[j] = *prev;
+        }
+        dst[j] = addr;
+    }
+    return res->addr_c;
+}
+
+void resolver_report(t_resolved *res, const t_addr *addr, long long connect_us) {
+    t_addr *cached = find_addr(res, addr);
+    if (cached == NULL) return;
+    if (connect_us < 0) {
+        cached->fails++;
+        return;
+    }
+    if (connect_us == 0) connect_us = 1;
+    cached->connect_us = (cached->connect_us == 0) ? connect_us : (cached->connect_us * 3 + connect_us) / 4;
+    cached->fails = 0;
+}
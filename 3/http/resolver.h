@@ -0,0 +1,69 @@
+/**
+ * Resolver module definitions.
+ * @brief Covers resolving host names with a cache and ordering their addresses for connecting.
+ * @details Resolved addresses are reused for RESOLVER_TTL seconds (getaddrinfo() does not report the TTL of the DNS
+ * records), so a host is resolved once however many connections are opened to it. If resolving fails again later,
+ * the stale addresses are kept.<br>
+ * IPv6 and IPv4 addresses are interleaved as recommended by RFC 8305, so connection attempts alternate between the
+ * families. Every connect is recorded per address: addresses that connected fastest are tried first, addresses whose
+ * last connect failed are tried last.
+ * @file resolver.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stdbool.h>
+#include <sys/socket.h>
+
+#define RESOLVER_TTL 60 /**< Seconds for which resolved addresses are reused. */
+#define RESOLVER_ADDR_MAX 16 /**< Maximum count of addresses per host. */
+
+/**
+ * @brief Address of a host with its connect metrics.
+ */
+typedef struct Addr {
+    struct sockaddr_storage sa; /**< Socket address. */
+    socklen_t len; /**< Length of the socket address. */
+    int family; /**< Address family (AF_INET or AF_INET6). */
+    long long connect_us; /**< Smoothed duration of successful connects in microseconds, 0 if none succeeded. */
+    int fails; /**< Count of failed connects since the last successful one. */
+} t_addr;
+
+/**
+ * @brief Cached addresses of a host.
+ */
+typedef struct Resolved {
+    t_addr addrs[RESOLVER_ADDR_MAX]; /**< Addresses in the order they were resolved (families interleaved). */
+    int addr_c; /**< Count of addresses. */
+    long long resolved_us; /**< Time of the last resolution (see now_us()), 0 if never resolved. */
+} t_resolved;
+
+/**
+ * @brief Resolves a host name unless its cached addresses are still valid.
+ * @details Metrics of addresses that are resolved again are kept.
+ * @param res Cached addresses to be updated.
+ * @param name Host name.
+ * @param port Port name.
+ * @param now Current time (see now_us()).
+ * @return 0 if addresses are available, -1 if the name cannot be resolved.
+ */
+int resolver_lookup(t_resolved *res, const char *name, const char *port, long long now);
+
+/**
+ * @brief Orders the cached addresses for a new connection.
+ * @details Addresses that connected are tried first (fastest first), then addresses that were never tried (in
+ * resolved order), then addresses whose last connect failed.
+ * @param res Cached addresses.
+ * @param dst Array for the ordered addresses, at least RESOLVER_ADDR_MAX long.
+ * @return Count of addresses.
+ */
+int resolver_order(const t_resolved *res, t_addr *dst);
+
+/**
+ * @brief Records the outcome of a connect to an address.
+ * @details Does nothing if the address is no longer cached.
+ * @param res Cached addresses.
+ * @param addr Address that was connected to.
+ * @param connect_us Duration of the connect in microseconds, negative if it failed.
+ */
+void resolver_report(t_resolved *res, const t_addr *addr, long long connect_us);
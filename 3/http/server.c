@@ -0,0 +1,764 @@
+/**
+ * Server module.
+ * @brief Main entry point for the http server.
+ * @details Implements a server for the HTTP protocol (version 1.1) that serves static files of a document root for
+ * GET and HEAD requests.<br>
+ * One worker thread runs per processor core. Every worker has its own listening socket on the same port
+ * (SO_REUSEPORT), so the kernel spreads new connections across the workers and no state is shared between them. A
+ * worker drives all of its connections from one non-blocking epoll loop: connections are kept alive, pipelined
+ * requests are answered in order, and bodies are sent with sendfile() straight from the page cache.<br>
+ * Open files are kept in a small cache per worker, so frequently requested files are neither opened nor looked up
+ * again. A cached file is compared with the file system at most once per second, changed files are opened again.<br>
+ * A single byte range (Range, also guarded by If-Range) is answered with 206, and a matching If-None-Match with 304.
+ * Requests are parsed by the http module (see http.h), like the responses of the client.
+ * @file server.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "http.h"
+#include "misc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#define DEFAULT_PORT "8080" /**< Default port to listen on. */
+#define DEFAULT_INDEX "index.html" /**< Default file that is served for directories. */
+#define THREAD_MAX 256 /**< Maximum count of worker threads. */
+#define IN_SIZE 16384 /**< Size of the receive buffer of a connection (limits the size of a request). */
+#define HEAD_SIZE 1024 /**< Size of the buffer of the header block of a response. */
+#define EVENT_MAX 256 /**< Maximum count of events per wait. */
+#define SEND_MAX (1 << 30) /**< Maximum count of bytes per sendfile() call. */
+#define FILE_SLOTS 1024 /**< Count of slots of the file cache of a worker (a power of two). */
+#define FILE_CHECK 1000000 /**< Time in microseconds after which a cached file is compared with the file system. */
+#define IDLE_TIMEOUT 60000000 /**< Time in microseconds after which an inactive connection is closed. */
+#define SWEEP_INTERVAL 1000 /**< Time in milliseconds between checks for inactive connections. */
+
+/**
+ * @brief Program options.
+ * @details The program configurations that are specified by the arguments.
+ */
+typedef struct Options {
+    char *port; /**< Port to listen on, 0 for any free port. */
+    char *index; /**< File that is served for directories. */
+    char *root; /**< Path to the document root. */
+    int threads; /**< Count of worker threads. */
+} t_opt;
+
+/**
+ * @brief Open file of the document root.
+ * @details Cached files are shared by the responses that send them. A file that is evicted from the cache while it
+ * is sent is closed after its last response.
+ */
+typedef struct File {
+    char *path; /**< Path relative to the document root. */
+    int fd; /**< File descriptor. */
+    struct stat st; /**< Status of the file when it was opened. */
+    const char *type; /**< Content type. */
+    char etag[64]; /**< Strong validator, derived from inode, size and modification time. */
+    char modified[32]; /**< Modification time as HTTP date. */
+    long long checked; /**< Time (see now_us()) the file was last compared with the file system. */
+    int refs; /**< Count of responses that send the file. */
+    bool cached; /**< Whether the file is in the cache. */
+} t_file;
+
+/**
+ * @brief Connection of a client.
+ * @details A connection answers one request at a time. Requests that arrive while a response is sent stay in the
+ * receive buffer.
+ */
+typedef struct Conn {
+    int fd; /**< Socket file descriptor. */
+    struct Conn *prev; /**< Previous connection. */
+    struct Conn *next; /**< Next connection. */
+    uint32_t events; /**< Events the connection waits for. */
+    long long active; /**< Time (see now_us()) of the last progress. */
+    size_t in_len; /**< Count of received bytes. */
+    unsigned long long discard; /**< Count of bytes of a request body that are still to be discarded. */
+    size_t out_len; /**< Length of the header block. */
+    size_t out_pos; /**< Count of sent bytes of the header block. */
+    t_file *file; /**< File whose body is sent, NULL if there is none. */
+    off_t off; /**< Offset of the next body byte in the file. */
+    off_t end; /**< Offset after the last body byte. */
+    bool busy; /**< Whether a response is being sent. */
+    bool close; /**< Whether the connection is closed after the response. */
+    char in[IN_SIZE]; /**< Received bytes of requests that are not answered yet. */
+    char out[HEAD_SIZE]; /**< Header block of the current response. */
+} t_conn;
+
+/**
+ * @brief Worker thread.
+ */
+typedef struct Worker {
+    const t_opt *opts; /**< Program options. */
+    int root; /**< File descriptor of the document root. */
+    int lfd; /**< Listening socket. */
+    int epfd; /**< Epoll instance. */
+    pthread_t thread; /**< Thread of the worker. */
+    t_conn *conns; /**< First connection. */
+    t_file *files[FILE_SLOTS]; /**< File cache, slots are chosen by the hash of the path. */
+    char date[32]; /**< Current time as HTTP date. */
+    time_t date_at; /**< Time the date was formatted for. */
+} t_worker;
+
+/**
+ * @brief Content type of a file extension.
+ */
+typedef struct Type {
+    const char *ext; /**< File extension (without dot). */
+    const char *type; /**< Content type. */
+} t_type;
+
+static const t_type types[] = {
+    { "html", "text/html; charset=utf-8" },
+    { "htm", "text/html; charset=utf-8" },
+    { "css", "text/css; charset=utf-8" },
+    { "js", "text/javascript; charset=utf-8" },
+    { "json", "application/json" },
+    { "txt", "text/plain; charset=utf-8" },
+    { "xml", "application/xml" },
+    { "svg", "image/svg+xml" },
+    { "png", "image/png" },
+    { "jpg", "image/jpeg" },
+    { "jpeg", "image/jpeg" },
+    { "gif", "image/gif" },
+    { "ico", "image/x-icon" },
+    { "pdf", "application/pdf" },
+    { "gz", "application/gzip" },
+    { NULL, "application/octet-stream" }
+}; /**< Known content types, the last one is the default. */
+
+char *prog_name;
+
+/**
+ * @brief Prints the usage of the program to stderr and exists with an error.
+ * @details Exits the program with EXIT_FAILURE.<br>
+ * Used global variables: prog_name
+ */
+static void usage(void) {
+    fprintf(stderr, "Usage: %s [-p PORT] [-i INDEX] [-t THREADS] DOC_ROOT\n", prog_name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses the program arguments.
+ * @details Might exit the program with EXIT_FAILURE if arguments are invalid.
+ * @param opts Pointer to program options.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ */
+static void parse_args(t_opt *opts, int argc, char **argv) {
+    int opt, num;
+    while ((opt = getopt(argc, argv, "p:i:t:")) != -1) {
+        switch (opt) {
+            case 'p':
+                if (parse_int(&num, optarg) == -1 || num > 65535) usage();
+                opts->port = optarg;
+                break;
+            case 'i':
+                if (strlen(optarg) == 0 || strchr(optarg, '/') != NULL) usage();
+                opts->index = optarg;
+                break;
+            case 't':
+                if (parse_int(&opts->threads, optarg) == -1 || opts->threads == 0 || opts->threads > THREAD_MAX) {
+                    usage();
+                }
+                break;
+            default: usage();
+        }
+    }
+    if (optind != argc - 1) usage();
+    opts->root = argv[optind];
+}
+
+/**
+ * @brief Closes a file that is no longer used.
+ * @param file File.
+ */
+static void free_file(t_file *file) {
+    close(file->fd);
+    free(file->path);
+    free(file);
+}
+
+/**
+ * @brief Releases a file after its response.
+ * @details Closes the file if it was its last response and it is no longer cached.
+ * @param file File.
+ */
+static void release_file(t_file *file) {
+    if (--file->refs == 0 && !file->cached) free_file(file);
+}
+
+/**
+ * @brief Removes a file from the cache of a worker.
+ * @param w Worker.
+ * @param slot Slot of the file.
+ */
+static void evict_file(t_worker *w, size_t slot) {
+    t_file *file = w->files[slot];
+    w->files[slot] = NULL;
+    file->cached = false;
+    if (file->refs == 0) free_file(file);
+}
+
+/**
+ * @brief Computes the cache slot of a path.
+ * @details FNV-1a hash of the path.
+ * @param path Path.
+ * @return Slot.
+ */
+static size_t file_slot(const char *path) {
+    uint32_t h = 2166136261u;
+    for (; *path != '\0'; path++) h = (h ^ (unsigned char) *path) * 16777619u;
+    return h & (FILE_SLOTS - 1);
+}
+
+/**
+ * @brief Chooses the content type of a file by its extension.
+ * @param path Path of the file.
+ * @return Content type.
+ */
+static const char *file_type(const char *path) {
+    const char *dot = strrchr(path, '.');
+    size_t i = 0;
+    if (dot == NULL || strchr(dot, '/') != NULL) i = sizeof(types) / sizeof(t_type) - 1;
+    for (; types[i].ext != NULL && strcasecmp(types[i].ext, dot + 1) != 0; i++) continue;
+    return types[i].type;
+}
+
+/**
+ * @brief Formats a time as HTTP date.
+ * @param dst Buffer of at least 30 bytes.
+ * @param size Size of the buffer.
+ * @param t Time.
+ */
+static void format_date(char *dst, size_t size, time_t t) {
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(dst, size, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+}
+
+/**
+ * @brief Opens a file of the document root, from the cache if possible.
+ * @details The file is held by the caller until it is passed to release_file().
+ * @param w Worker.
+ * @param path Path relative to the document root.
+ * @param status Pointer to be updated with the status to answer with if the file cannot be served (301 for
+ * directories, 403 for other files that are no regular files).
+ * @return File, NULL if it cannot be served.
+ */
+static t_file *open_file(t_worker *w, const char *path, int *status) {
+    long long now = now_us();
+    size_t slot = file_slot(path);
+    t_file *file = w->files[slot];
+    struct stat st;
+    if (file != NULL && strcmp(file->path, path) == 0) {
+        if (now - file->checked < FILE_CHECK) {
+            file->refs++;
+            return file;
+        }
+        bool same = fstatat(w->root, path, &st, 0) == 0 && st.st_ino == file->st.st_ino &&
+            st.st_dev == file->st.st_dev && st.st_size == file->st.st_size &&
+            st.st_mtim.tv_sec == file->st.st_mtim.tv_sec && st.st_mtim.tv_nsec == file->st.st_mtim.tv_nsec;
+        if (same) {
+            file->checked = now;
+            file->refs++;
+            return file;
+        }
+        evict_file(w, slot);
+    }
+    int fd = openat(w->root, path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1) {
+        *status = (errno == ENOENT || errno == ENOTDIR || errno == ENAMETOOLONG) ? 404 : (errno == EACCES) ? 403 : 500;
+        return NULL;
+    }
+    bool stated = fstat(fd, &st) == 0;
+    if (!stated || !S_ISREG(st.st_mode)) {
+        *status = !stated ? 500 : S_ISDIR(st.st_mode) ? 301 : 403;
+        close(fd);
+        return NULL;
+    }
+    file = (t_file *) malloc(sizeof(t_file));
+    char *copy = strdup(path);
+    if (file == NULL || copy == NULL) {
+        t_err("open_file");
+        free(file);
+        free(copy);
+        close(fd);
+        *status = 500;
+        return NULL;
+    }
+    file->path = copy;
+    file->fd = fd;
+    file->st = st;
+    file->type = file_type(path);
+    snprintf(file->etag, sizeof(file->etag), "\"%llx-%llx-%llx\"", (unsigned long long) st.st_ino,
+        (unsigned long long) st.st_size, (unsigned long long) st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec);
+    format_date(file->modified, sizeof(file->modified), st.st_mtim.tv_sec);
+    file->checked = now;
+    file->refs = 1;
+    file->cached = true;
+    if (w->files[slot] != NULL) evict_file(w, slot);
+    w->files[slot] = file;
+    return file;
+}
+
+/**
+ * @brief Converts a request target into a path relative to the document root.
+ * @details Decodes percent-encoded bytes and drops the query. Targets that end with a slash get the index file.
+ * Targets with ".." segments or encoded null bytes are rejected.
+ * @param dst Buffer of the path.
+ * @param size Size of the buffer.
+ * @param target Request target.
+ * @param len Length of the target.
+ * @param index Name of the index file.
+ * @return 0 on success, -1 if the target is invalid.
+ */
+static int target_path(char *dst, size_t size, const char *target, size_t len, const char *index) {
+    if (len == 0 || target[0] != '/') return -1;
+    size_t n = 0;
+    for (size_t i = 1; i < len && target[i] != '?' && target[i] != '#'; i++) {
+        char c = target[i];
+        if (c == '%') {
+            unsigned int byte;
+            if (i + 2 >= len || sscanf(target + i + 1, "%2x", &byte) != 1 || byte == 0) return -1;
+            c = (char) byte;
+            i += 2;
+        }
+        if (n + 1 >= size) return -1;
+        dst[n++] = c;
+    }
+    dst[n] = '\0';
+    for (char *seg = dst; seg != NULL; seg = strchr(seg, '/')) {
+        if (*seg == '/') seg++;
+        if (strncmp(seg, "..", 2) == 0 && (seg[2] == '/' || seg[2] == '\0')) return -1;
+    }
+    if (n == 0 || dst[n - 1] == '/') {
+        if (n + strlen(index) + 1 > size) return -1;
+        strcpy(dst + n, index);
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the reason phrase of a status.
+ * @param status Status.
+ * @return Reason phrase.
+ */
+static const char *reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        case 501: return "Not Implemented";
+        default: return "Internal Server Error";
+    }
+}
+
+/**
+ * @brief Chooses the response to a request and builds its header block.
+ * @param w Worker.
+ * @param conn Connection, its response is set up.
+ * @param req Parsed request.
+ * @param status Status if the request is already known to be invalid, 0 otherwise.
+ */
+static void build_response(t_worker *w, t_conn *conn, const t_request *req, int status) {
+    char path[PATH_MAX];
+    t_file *file = NULL;
+    if (status == 0 && req->method == M_OTHER) status = 501;
+    if (status == 0 && target_path(path, sizeof(path), conn->in + req->target.off, req->target.len,
+        w->opts->index) == -1) status = 400;
+    if (status == 0) file = open_file(w, path, &status);
+    unsigned long long size = (file != NULL) ? (unsigned long long) file->st.st_size : 0;
+    unsigned long long first = 0, last = size - 1;
+    if (file != NULL) {
+        size_t len;
+        const char *match = http_request_header(req, conn->in, "If-None-Match", &len);
+        int range = http_range(req, conn->in, size, file->etag, &first, &last);
+        if (match != NULL && ((len == 1 && *match == '*') || memmem(match, len, file->etag, strlen(file->etag)))) {
+            status = 304;
+        } else {
+            status = (range == 1) ? 206 : (range == 0) ? 416 : 200;
+        }
+        if (range != 1) first = 0, last = size - 1;
+    }
+    time_t now = time(NULL);
+    if (now != w->date_at) {
+        format_date(w->date, sizeof(w->date), now);
+        w->date_at = now;
+    }
+    bool body = status == 200 || status == 206;
+    conn->off = body ? (off_t) first : 0;
+    conn->end = (body && size > 0) ? (off_t) last + 1 : 0;
+    size_t n = snprintf(conn->out, HEAD_SIZE, "HTTP/1.1 %d %s\r\nDate: %s\r\nServer: tuwien-osue-http/1.0\r\n",
+        status, reason(status), w->date);
+    if (status != 304) n += snprintf(conn->out + n, HEAD_SIZE - n, "Content-Length: %llu\r\n",
+        (unsigned long long) (conn->end - conn->off));
+    if (file != NULL) n += snprintf(conn->out + n, HEAD_SIZE - n, "Content-Type: %s\r\nLast-Modified: %s\r\n"
+        "ETag: %s\r\nAccept-Ranges: bytes\r\n", file->type, file->modified, file->etag);
+    if (status == 206) n += snprintf(conn->out + n, HEAD_SIZE - n, "Content-Range: bytes %llu-%llu/%llu\r\n",
+        first, last, size);
+    if (status == 416) n += snprintf(conn->out + n, HEAD_SIZE - n, "Content-Range: bytes */%llu\r\n", size);
+    if (status == 301) {
+        const char *target = conn->in + req->target.off;
+        const char *args = (const char *) memchr(target, '?', req->target.len);
+        size_t len = (args != NULL) ? (size_t) (args - target) : req->target.len;
+        n += snprintf(conn->out + n, HEAD_SIZE - n, "Location: %.*s/\r\n", (int) (len < 512 ? len : 512), target);
+    }
+    if (conn->close) n += snprintf(conn->out + n, HEAD_SIZE - n, "Connection: close\r\n");
+    else if (req->minor == 0) n += snprintf(conn->out + n, HEAD_SIZE - n, "Connection: keep-alive\r\n");
+    n += snprintf(conn->out + n, HEAD_SIZE - n, "\r\n");
+    conn->out_len = (n < HEAD_SIZE) ? n : HEAD_SIZE - 1;
+    conn->out_pos = 0;
+    if (!body || req->method == M_HEAD || conn->end == conn->off) {
+        conn->off = conn->end = 0;
+        if (file != NULL) release_file(file);
+        file = NULL;
+    }
+    conn->file = file;
+}
+
+/**
+ * @brief Starts the response to the next complete request of a connection.
+ * @details Does nothing if no request is complete. The body of a request is discarded. Invalid requests, requests
+ * with chunked bodies and requests that do not fit into the receive buffer are answered with an error and the
+ * connection is closed afterwards.
+ * @param w Worker.
+ * @param conn Connection (not busy).
+ */
+static void start_response(t_worker *w, t_conn *conn) {
+    size_t skip = (conn->discard < conn->in_len) ? (size_t) conn->discard : conn->in_len;
+    conn->discard -= skip;
+    conn->in_len -= skip;
+    memmove(conn->in, conn->in + skip, conn->in_len);
+    if (conn->discard > 0) return;
+    t_request req;
+    long used = http_parse_request(&req, conn->in, conn->in_len);
+    if (used == 0 && conn->in_len < IN_SIZE) return;
+    int status = (used == 0) ? 431 : (used == -1 || req.chunked) ? 400 : 0;
+    conn->close = status != 0 || !req.keep_alive;
+    if (status != 0) used = conn->in_len;
+    build_response(w, conn, &req, status);
+    conn->discard = (status == 0) ? req.content_len : 0;
+    conn->in_len -= used;
+    memmove(conn->in, conn->in + used, conn->in_len);
+    conn->busy = true;
+}
+
+/**
+ * @brief Closes a connection.
+ * @param w Worker.
+ * @param conn Connection to be closed.
+ */
+static void close_conn(t_worker *w, t_conn *conn) {
+    if (conn->file != NULL) release_file(conn->file);
+    close(conn->fd);
+    if (conn->prev != NULL) conn->prev->next = conn->next;
+    else w->conns = conn->next;
+    if (conn->next != NULL) conn->next->prev = conn->prev;
+    free(conn);
+}
+
+/**
+ * @brief Sends the current response of a connection.
+ * @details Sends until the socket would block. The header block is sent with MSG_MORE, so it leaves in the same
+ * segment as the start of the body. Completed responses are followed by the responses to the next received
+ * requests.
+ * @param w Worker.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int send_response(t_worker *w, t_conn *conn) {
+    while (conn->busy) {
+        ssize_t n;
+        if (conn->out_pos < conn->out_len) {
+            int flags = MSG_NOSIGNAL | ((conn->file != NULL) ? MSG_MORE : 0);
+            n = send(conn->fd, conn->out + conn->out_pos, conn->out_len - conn->out_pos, flags);
+            if (n > 0) conn->out_pos += n;
+        } else if (conn->off < conn->end) {
+            size_t len = (conn->end - conn->off < SEND_MAX) ? (size_t) (conn->end - conn->off) : SEND_MAX;
+            n = sendfile(conn->fd, conn->file->fd, &conn->off, len);
+            if (n == 0) {
+                errno = EIO;
+                n = -1;
+            }
+        } else {
+            if (conn->file != NULL) release_file(conn->file);
+            conn->file = NULL;
+            conn->busy = false;
+            if (conn->close) {
+                close_conn(w, conn);
+                return -1;
+            }
+            start_response(w, conn);
+            continue;
+        }
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n == -1) {
+            close_conn(w, conn);
+            return -1;
+        }
+        conn->active = now_us();
+    }
+    return 0;
+}
+
+/**
+ * @brief Receives requests of a connection and answers them.
+ * @param w Worker.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int receive_requests(t_worker *w, t_conn *conn) {
+    ssize_t n = recv(conn->fd, conn->in + conn->in_len, IN_SIZE - conn->in_len, 0);
+    if (n == -1 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+    if (n <= 0) {
+        close_conn(w, conn);
+        return -1;
+    }
+    conn->in_len += n;
+    conn->active = now_us();
+    if (!conn->busy) start_response(w, conn);
+    return send_response(w, conn);
+}
+
+/**
+ * @brief Updates the events a connection waits for.
+ * @details A connection receives while its buffer has room and sends while it is busy.
+ * @param w Worker.
+ * @param conn Connection.
+ */
+static void update_events(t_worker *w, t_conn *conn) {
+    uint32_t events = ((conn->in_len < IN_SIZE) ? EPOLLIN : 0) | (conn->busy ? EPOLLOUT : 0);
+    if (events == conn->events) return;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = conn;
+    if (epoll_ctl(w->epfd, EPOLL_CTL_MOD, conn->fd, &ev) == -1) {
+        t_err("epoll_ctl");
+        close_conn(w, conn);
+        return;
+    }
+    conn->events = events;
+}
+
+/**
+ * @brief Accepts all pending connections of a worker.
+ * @details Responses are sent without delay (no Nagle algorithm), the header block and the body are joined by
+ * MSG_MORE instead.
+ * @param w Worker.
+ */
+static void accept_conns(t_worker *w) {
+    while (true) {
+        int fd = accept4(w->lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) t_err("accept4");
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        t_conn *conn = (t_conn *) malloc(sizeof(t_conn));
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (conn == NULL || epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            t_err("accept_conns");
+            free(conn);
+            close(fd);
+            continue;
+        }
+        memset(conn, 0, offsetof(t_conn, in));
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        conn->active = now_us();
+        conn->next = w->conns;
+        if (w->conns != NULL) w->conns->prev = conn;
+        w->conns = conn;
+    }
+}
+
+/**
+ * @brief Closes the connections of a worker that made no progress for too long.
+ * @param w Worker.
+ */
+static void close_idle(t_worker *w) {
+    long long now = now_us();
+    t_conn *next;
+    for (t_conn *conn = w->conns; conn != NULL; conn = next) {
+        next = conn->next;
+        if (now - conn->active > IDLE_TIMEOUT) close_conn(w, conn);
+    }
+}
+
+/**
+ * @brief Runs the event loop of a worker.
+ * @details Never returns, errors of single connections only close the connection.
+ * @param arg Worker.
+ * @return Nothing.
+ */
+static void *run_worker(void *arg) {
+    t_worker *w = (t_worker *) arg;
+    struct epoll_event events[EVENT_MAX];
+    long long swept = now_us();
+    while (true) {
+        int n = epoll_wait(w->epfd, events, EVENT_MAX, SWEEP_INTERVAL);
+        if (n == -1 && errno != EINTR) e_err("epoll_wait");
+        for (int i = 0; i < n; i++) {
+            t_conn *conn = (t_conn *) events[i].data.ptr;
+            if (conn == NULL) {
+                accept_conns(w);
+                continue;
+            }
+            int rc = 0;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) rc = receive_requests(w, conn);
+            else if (events[i].events & EPOLLOUT) rc = send_response(w, conn);
+            if (rc == 0) update_events(w, conn);
+        }
+        if (now_us() - swept >= SWEEP_INTERVAL * 1000LL) {
+            close_idle(w);
+            swept = now_us();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Opens a listening socket.
+ * @details Listens on all IPv6 and IPv4 addresses, or only IPv4 addresses if IPv6 is unavailable. The port can be
+ * shared with further sockets (SO_REUSEPORT).
+ * @param port Port, 0 for any free port.
+ * @param bound Pointer to be updated with the port the socket is bound to.
+ * @return Listening socket, -1 on error.
+ */
+static int listen_on(int port, int *bound) {
+    int fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    bool v6 = fd != -1;
+    if (!v6) fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) return t_err("socket");
+    int one = 1, zero = 0;
+    struct sockaddr_storage addr;
+    socklen_t len = v6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+    memset(&addr, 0, sizeof(addr));
+    if (v6) {
+        struct sockaddr_in6 *a = (struct sockaddr_in6 *) &addr;
+        a->sin6_family = AF_INET6;
+        a->sin6_addr = in6addr_any;
+        a->sin6_port = htons(port);
+    } else {
+        struct sockaddr_in *a = (struct sockaddr_in *) &addr;
+        a->sin_family = AF_INET;
+        a->sin_addr.s_addr = htonl(INADDR_ANY);
+        a->sin_port = htons(port);
+    }
+    if (
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == -1 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1 ||
+        (v6 && setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero)) == -1) ||
+        bind(fd, (struct sockaddr *) &addr, len) == -1 ||
+        listen(fd, SOMAXCONN) == -1 ||
+        getsockname(fd, (struct sockaddr *) &addr, &len) == -1
+    ) {
+        close(fd);
+        return t_err("listen_on");
+    }
+    *bound = ntohs(v6 ? ((struct sockaddr_in6 *) &addr)->sin6_port : ((struct sockaddr_in *) &addr)->sin_port);
+    return fd;
+}
+
+/**
+ * @brief Sets up a worker.
+ * @param w Worker to be initialized.
+ * @param opts Program options.
+ * @param root File descriptor of the document root.
+ * @param port Port to listen on.
+ * @param bound Pointer to be updated with the port the worker listens on.
+ * @return 0 on success, -1 on error.
+ */
+static int init_worker(t_worker *w, const t_opt *opts, int root, int port, int *bound) {
+    memset(w, 0, sizeof(t_worker));
+    w->opts = opts;
+    w->root = root;
+    w->lfd = listen_on(port, bound);
+    if (w->lfd == -1) return -1;
+    w->epfd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (w->epfd == -1 || epoll_ctl(w->epfd, EPOLL_CTL_ADD, w->lfd, &ev) == -1) return t_err("epoll");
+    return 0;
+}
+
+/**
+ * @brief Serves the files of the document root until the program is terminated.
+ * @details Parses the arguments, sets up one worker per processor core (or as many as passed with -t) and runs them.
+ * Allows as many open files as the hard limit permits. If any free port was requested (port 0), the chosen port is
+ * printed to stdout.<br>
+ * Global variables: prog_name
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ * @return EXIT_FAILURE if the server could not be started.
+ */
+int main(int argc, char **argv) {
+    prog_name = argv[0];
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    t_opt opts = { DEFAULT_PORT, DEFAULT_INDEX, NULL, (cores < 1) ? 1 : (cores > THREAD_MAX) ? THREAD_MAX : cores };
+    parse_args(&opts, argc, argv);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_IGN;
+    if (sigaction(SIGPIPE, &sa, NULL) == -1) e_err("sigaction");
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    int root = open(opts.root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root == -1) e_err("open");
+    t_worker *workers = (t_worker *) malloc(sizeof(t_worker) * opts.threads);
+    if (workers == NULL) e_err("malloc");
+    int port;
+    parse_int(&port, opts.port);
+    for (int i = 0; i < opts.threads; i++) {
+        if (init_worker(&workers[i], &opts, root, port, &port) == -1) e_err("init_worker");
+    }
+    if (strcmp(opts.port, "0") == 0) {
+        printf("%d\n", port);
+        fflush(stdout);
+    }
+    for (int i = 1; i < opts.threads; i++) {
+        errno = pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]);
+        if (errno != 0) e_err("pthread_create");
+    }
+    run_worker(&workers[0]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,485 @@
+/**
+ * Testserver module.
+ * @brief Main entry point for the http test server.
+ * @details Serves generated content (see gen.h) over HTTP/1.1 on the loopback interface, so the client can be tested
+ * and benchmarked without an outside server. The path of a request is the length of the resource in bytes, e.g.
+ * "/1048576".<br>
+ * Connections are kept alive and pipelined requests are answered in order. GET and HEAD are supported, a single byte
+ * range (Range, also guarded by If-Range) is answered with 206. Every resource has a strong ETag.<br>
+ * Artificial conditions are set for all responses with options, or per request with arguments of the url: delay=MS
+ * delays the response, rate=BYTES limits the bytes per second of the response, chunk=BYTES sends the body with chunked
+ * transfer encoding in chunks of this size and close=1 closes the connection after the response.<br>
+ * The port is printed to stdout once the server listens, which tells the port if any free one was requested (port
+ * 0).
+ * @file testserver.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "gen.h"
+#include "http.h"
+#include "misc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#define LISTEN_ADDR "127.0.0.1" /**< Address the server listens on. */
+#define IN_SIZE 16384 /**< Size of the receive buffer of a connection (limits the size of a request). */
+#define OUT_SIZE 65536 /**< Size of the send buffer of a connection. */
+#define FRAME_MAX 32 /**< Maximum length of the framing around a chunk. */
+#define EVENT_MAX 64 /**< Maximum count of events per wait. */
+#define RATE_STEP 4096 /**< Count of bytes a rate limited response waits for at least. */
+
+/**
+ * @brief Program options.
+ * @details The program configurations that are specified by the arguments.
+ */
+typedef struct Options {
+    int port; /**< Port to listen on, 0 for any free port. */
+    long delay; /**< Default delay of a response in milliseconds. */
+    long long rate; /**< Default limit of bytes per second of a response, 0 if unlimited. */
+    long long chunk; /**< Default chunk size, 0 if bodies have a Content-Length. */
+} t_opt;
+
+/**
+ * @brief Connection of a client.
+ * @details A connection answers one request at a time. Requests that arrive while a response is sent stay in the
+ * receive buffer.
+ */
+typedef struct Conn {
+    int fd; /**< Socket file descriptor. */
+    struct Conn *prev; /**< Previous connection. */
+    struct Conn *next; /**< Next connection. */
+    uint32_t events; /**< Events the connection waits for. */
+    char in[IN_SIZE]; /**< Received bytes of requests that are not answered yet. */
+    size_t in_len; /**< Count of received bytes. */
+    char out[OUT_SIZE]; /**< Bytes of the current response to be sent. */
+    size_t out_len; /**< Count of bytes to be sent. */
+    size_t out_pos; /**< Count of sent bytes. */
+    bool busy; /**< Whether a response is being sent. */
+    bool close; /**< Whether the connection is closed after the response. */
+    unsigned long long off; /**< Offset of the next body byte in the resource. */
+    unsigned long long end; /**< Offset after the last body byte. */
+    long long chunk; /**< Chunk size of the body, 0 if it has a Content-Length. */
+    bool last_chunk; /**< Whether the last (empty) chunk is queued. */
+    long long rate; /**< Limit of bytes per second of the response, 0 if unlimited. */
+    long long start; /**< Time (see now_us()) the response starts being sent. */
+    unsigned long long sent; /**< Count of sent bytes of the response. */
+} t_conn;
+
+/**
+ * @brief Conditions of a response, from the options and the arguments of the request url.
+ */
+typedef struct Params {
+    long long size; /**< Length of the resource, -1 if the path is no length. */
+    long delay; /**< Delay of the response in milliseconds. */
+    long long rate; /**< Limit of bytes per second, 0 if unlimited. */
+    long long chunk; /**< Chunk size, 0 if the body has a Content-Length. */
+    bool close; /**< Whether the connection is closed after the response. */
+} t_params;
+
+char *prog_name;
+
+/**
+ * @brief Prints the usage of the program to stderr and exists with an error.
+ * @details Exits the program with EXIT_FAILURE.<br>
+ * Used global variables: prog_name
+ */
+static void usage(void) {
+    fprintf(stderr, "Usage: %s [-p PORT] [-d DELAY_MS] [-r RATE] [-c CHUNK]\n", prog_name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses a non-negative number.
+ * @param src String of the number.
+ * @param dst Number to be updated.
+ * @return 0 on success, -1 if the string is no non-negative number.
+ */
+static int parse_num(const char *src, long long *dst) {
+    char *end;
+    errno = 0;
+    long long num = strtoll(src, &end, 10);
+    if (end == src || *end != '\0' || num < 0 || errno != 0) return -1;
+    *dst = num;
+    return 0;
+}
+
+/**
+ * @brief Parses the program arguments.
+ * @details Might exit the program with EXIT_FAILURE if arguments are invalid.
+ * @param opts Pointer to program options.
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ */
+static void parse_args(t_opt *opts, int argc, char **argv) {
+    int opt;
+    long long num;
+    while ((opt = getopt(argc, argv, "p:d:r:c:")) != -1) {
+        if (opt == '?' || parse_num(optarg, &num) == -1) usage();
+        switch (opt) {
+            case 'p':
+                if (num > 65535) usage();
+                opts->port = (int) num;
+                break;
+            case 'd': opts->delay = (long) num; break;
+            case 'r': opts->rate = num; break;
+            case 'c': opts->chunk = num; break;
+            default: usage();
+        }
+    }
+    if (optind != argc) usage();
+}
+
+/**
+ * @brief Closes a connection.
+ * @param conns Pointer to the first connection.
+ * @param conn Connection to be closed.
+ */
+static void close_conn(t_conn **conns, t_conn *conn) {
+    close(conn->fd);
+    if (conn->prev != NULL) conn->prev->next = conn->next;
+    else *conns = conn->next;
+    if (conn->next != NULL) conn->next->prev = conn->prev;
+    free(conn);
+}
+
+/**
+ * @brief Parses the target of a request.
+ * @details The path is the length of the resource, arguments override the default conditions. Unknown arguments are
+ * ignored.
+ * @param opts Program options with the default conditions.
+ * @param params Conditions to be initialized.
+ * @param target Null terminated request target (modified).
+ */
+static void parse_target(const t_opt *opts, t_params *params, char *target) {
+    params->size = -1;
+    params->delay = opts->delay;
+    params->rate = opts->rate;
+    params->chunk = opts->chunk;
+    params->close = false;
+    char *args = strchr(target, '?');
+    if (args != NULL) *args++ = '\0';
+    for (char *arg = (args != NULL) ? strtok(args, "&") : NULL; arg != NULL; arg = strtok(NULL, "&")) {
+        char *value = strchr(arg, '=');
+        long long num;
+        if (value == NULL || parse_num(value + 1, &num) == -1) continue;
+        *value = '\0';
+        if (strcmp(arg, "delay") == 0) params->delay = (long) num;
+        else if (strcmp(arg, "rate") == 0) params->rate = num;
+        else if (strcmp(arg, "chunk") == 0) params->chunk = num;
+        else if (strcmp(arg, "close") == 0) params->close = num != 0;
+    }
+    if (target[0] != '/' || parse_num(target + 1, &params->size) == -1) params->size = -1;
+}
+
+/**
+ * @brief Appends body bytes (and chunk framing) of the response of a connection to its send buffer.
+ * @details Starts at the beginning of the buffer if everything was sent.
+ * @param conn Connection.
+ */
+static void fill_out(t_conn *conn) {
+    if (conn->out_pos == conn->out_len) conn->out_pos = conn->out_len = 0;
+    while (conn->out_len + FRAME_MAX < OUT_SIZE) {
+        size_t room = OUT_SIZE - conn->out_len - FRAME_MAX;
+        unsigned long long left = conn->end - conn->off;
+        size_t n = (left < room) ? (size_t) left : room;
+        if (conn->chunk > 0 && (unsigned long long) conn->chunk < n) n = (size_t) conn->chunk;
+        if (n == 0) {
+            if (conn->chunk > 0 && !conn->last_chunk) {
+                memcpy(conn->out + conn->out_len, "0\r\n\r\n", 5);
+                conn->out_len += 5;
+                conn->last_chunk = true;
+            }
+            return;
+        }
+        if (conn->chunk > 0) conn->out_len += sprintf(conn->out + conn->out_len, "%zx\r\n", n);
+        gen_fill(conn->out + conn->out_len, conn->off, n);
+        conn->out_len += n;
+        conn->off += n;
+        if (conn->chunk > 0) {
+            memcpy(conn->out + conn->out_len, "\r\n", 2);
+            conn->out_len += 2;
+        }
+    }
+}
+
+/**
+ * @brief Starts the response to the next complete request of a connection.
+ * @details Does nothing if no request is complete. Requests that do not fit into the receive buffer are answered
+ * with 431 and the connection is closed afterwards.
+ * @param opts Program options.
+ * @param conn Connection (not busy).
+ */
+static void start_response(const t_opt *opts, t_conn *conn) {
+    t_request req;
+    long used = http_parse_request(&req, conn->in, conn->in_len);
+    if (used == 0 && conn->in_len < IN_SIZE) return;
+    t_params params;
+    int status = (used == 0) ? 431 : 400;
+    if (used > 0) {
+        conn->in[req.target.off + req.target.len] = '\0';
+        parse_target(opts, &params, conn->in + req.target.off);
+        params.close = params.close || !req.keep_alive;
+        status = (req.chunked || req.content_len > 0) ? 400 : (req.method == M_OTHER) ? 405 :
+            (params.size == -1) ? 404 : 0;
+    }
+    if (used <= 0 || status == 400) {
+        memset(&params, 0, sizeof(t_params));
+        params.close = true;
+        used = conn->in_len;
+    }
+    unsigned long long size = (status == 0) ? (unsigned long long) params.size : 0;
+    unsigned long long first = 0, last = size - 1;
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"gen-%llu\"", size);
+    int range = (status == 0) ? http_range(&req, conn->in, size, etag, &first, &last) : -1;
+    if (range == -1) first = 0, last = size - 1;
+    if (status == 0) status = (range == 1) ? 206 : (range == 0) ? 416 : 200;
+    const char *reason = (status == 200) ? "OK" : (status == 206) ? "Partial Content" :
+        (status == 400) ? "Bad Request" : (status == 404) ? "Not Found" : (status == 405) ? "Method Not Allowed" :
+        (status == 416) ? "Range Not Satisfiable" : "Request Header Fields Too Large";
+    bool body = status == 200 || status == 206;
+    conn->off = body ? first : 0;
+    conn->end = (body && size > 0) ? last + 1 : 0;
+    conn->chunk = body ? params.chunk : 0;
+    conn->last_chunk = false;
+    conn->close = params.close;
+    conn->rate = params.rate;
+    conn->start = now_us() + params.delay * 1000LL;
+    conn->sent = 0;
+    int n = sprintf(conn->out, "HTTP/1.1 %d %s\r\n", status, reason);
+    if (conn->chunk > 0) n += sprintf(conn->out + n, "Transfer-Encoding: chunked\r\n");
+    else n += sprintf(conn->out + n, "Content-Length: %llu\r\n", conn->end - conn->off);
+    if (body) n += sprintf(conn->out + n, "Accept-Ranges: bytes\r\nETag: %s\r\n", etag);
+    if (status == 206) n += sprintf(conn->out + n, "Content-Range: bytes %llu-%llu/%llu\r\n", first, last, size);
+    if (status == 416) n += sprintf(conn->out + n, "Content-Range: bytes */%llu\r\n", size);
+    if (conn->close) n += sprintf(conn->out + n, "Connection: close\r\n");
+    n += sprintf(conn->out + n, "\r\n");
+    conn->out_pos = 0;
+    conn->out_len = n;
+    if (used > 0 && req.method == M_HEAD) conn->off = conn->end = conn->chunk = 0;
+    conn->in_len -= used;
+    memmove(conn->in, conn->in + used, conn->in_len);
+    conn->busy = true;
+    fill_out(conn);
+}
+
+/**
+ * @brief Sends the current response of a connection.
+ * @details Sends until the socket would block or the rate limit is reached. Completed responses are followed by the
+ * responses to the next received requests.
+ * @param opts Program options.
+ * @param conns Pointer to the first connection.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int on_writable(const t_opt *opts, t_conn **conns, t_conn *conn) {
+    while (conn->busy) {
+        long long now = now_us();
+        if (now < conn->start) return 0;
+        if (conn->out_pos == conn->out_len) fill_out(conn);
+        if (conn->out_pos == conn->out_len) {
+            conn->busy = false;
+            if (conn->close) {
+                close_conn(conns, conn);
+                return -1;
+            }
+            start_response(opts, conn);
+            continue;
+        }
+        size_t len = conn->out_len - conn->out_pos;
+        if (conn->rate > 0) {
+            long long allowed = (now - conn->start) * conn->rate / 1000000 - (long long) conn->sent;
+            if (allowed <= 0) return 0;
+            if ((unsigned long long) allowed < len) len = (size_t) allowed;
+        }
+        ssize_t n = send(conn->fd, conn->out + conn->out_pos, len, MSG_NOSIGNAL);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n == -1) {
+            close_conn(conns, conn);
+            return -1;
+        }
+        conn->out_pos += n;
+        conn->sent += n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Receives requests of a connection.
+ * @param opts Program options.
+ * @param conns Pointer to the first connection.
+ * @param conn Connection.
+ * @return 0 on success, -1 if the connection was closed.
+ */
+static int on_readable(const t_opt *opts, t_conn **conns, t_conn *conn) {
+    ssize_t n = recv(conn->fd, conn->in + conn->in_len, IN_SIZE - conn->in_len, 0);
+    if (n == -1 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+    if (n <= 0) {
+        close_conn(conns, conn);
+        return -1;
+    }
+    conn->in_len += n;
+    if (!conn->busy) start_response(opts, conn);
+    return 0;
+}
+
+/**
+ * @brief Computes when a connection may send next.
+ * @param conn Busy connection.
+ * @param now Current time (see now_us()).
+ * @return Time (see now_us()) from which on the connection may send.
+ */
+static long long send_time(const t_conn *conn, long long now) {
+    if (now < conn->start || conn->rate == 0) return conn->start;
+    long long allowed = (now - conn->start) * conn->rate / 1000000 - (long long) conn->sent;
+    if (allowed > 0) return now;
+    return conn->start + (long long) ((conn->sent + RATE_STEP) * 1000000 / conn->rate);
+}
+
+/**
+ * @brief Updates the events the connections wait for and computes the timeout of the next wait.
+ * @details Connections receive while their buffer has room and send while they are busy and not held back by a
+ * delay or the rate limit.
+ * @param epfd Epoll instance.
+ * @param conns Pointer to the first connection.
+ * @return Timeout in milliseconds, -1 if no connection is held back.
+ */
+static int update_events(int epfd, t_conn **conns) {
+    long long now = now_us();
+    long long wake = -1;
+    t_conn *next;
+    for (t_conn *conn = *conns; conn != NULL; conn = next) {
+        next = conn->next;
+        long long at = conn->busy ? send_time(conn, now) : -1;
+        if (at > now && (wake == -1 || at < wake)) wake = at;
+        uint32_t events = ((conn->in_len < IN_SIZE) ? EPOLLIN : 0) | ((at != -1 && at <= now) ? EPOLLOUT : 0);
+        if (events == conn->events) continue;
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.ptr = conn;
+        if (epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev) == -1) {
+            t_err("epoll_ctl");
+            close_conn(conns, conn);
+            continue;
+        }
+        conn->events = events;
+    }
+    return (wake == -1) ? -1 : (int) ((wake - now + 999) / 1000);
+}
+
+/**
+ * @brief Accepts all pending connections.
+ * @details Responses are sent without delay (no Nagle algorithm), as pipelined responses are often small.
+ * @param epfd Epoll instance.
+ * @param lfd Listening socket.
+ * @param conns Pointer to the first connection.
+ */
+static void accept_conns(int epfd, int lfd, t_conn **conns) {
+    while (true) {
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) t_err("accept4");
+            if (errno == EINTR) continue;
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        t_conn *conn = (t_conn *) calloc(1, sizeof(t_conn));
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (conn == NULL || epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            t_err("accept_conns");
+            free(conn);
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        conn->next = *conns;
+        if (*conns != NULL) (*conns)->prev = conn;
+        *conns = conn;
+    }
+}
+
+/**
+ * @brief Opens the listening socket.
+ * @details Prints the port to stdout.
+ * @param port Port, 0 for any free port.
+ * @return Listening socket, -1 on error.
+ */
+static int listen_on(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) return t_err("socket");
+    int one = 1;
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, LISTEN_ADDR, &addr.sin_addr);
+    if (
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == -1 ||
+        bind(fd, (struct sockaddr *) &addr, sizeof(addr)) == -1 ||
+        listen(fd, SOMAXCONN) == -1 ||
+        getsockname(fd, (struct sockaddr *) &addr, &len) == -1
+    ) {
+        close(fd);
+        return t_err("listen_on");
+    }
+    printf("%d\n", ntohs(addr.sin_port));
+    fflush(stdout);
+    return fd;
+}
+
+/**
+ * @brief Serves generated content until the program is terminated.
+ * @details Parses the arguments and runs the event loop of all connections.<br>
+ * Global variables: prog_name
+ * @param argc Argument counter.
+ * @param argv Argument vector.
+ * @return EXIT_FAILURE if the server could not be started.
+ */
+int main(int argc, char **argv) {
+    prog_name = argv[0];
+    t_opt opts = { 0, 0, 0, 0 };
+    parse_args(&opts, argc, argv);
+    int lfd = listen_on(opts.port);
+    if (lfd == -1) e_err("listen_on");
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epfd == -1 || epoll_ctl(epfd, EPOLL_CTL_ADD, lfd, &ev) == -1) e_err("epoll");
+    t_conn *conns = NULL;
+    struct epoll_event events[EVENT_MAX];
+    while (true) {
+        int n = epoll_wait(epfd, events, EVENT_MAX, update_events(epfd, &conns));
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) e_err("epoll_wait");
+        for (int i = 0; i < n; i++) {
+            t_conn *conn = (t_conn *) events[i].data.ptr;
+            if (conn == NULL) {
+                accept_conns(epfd, lfd, &conns);
+                continue;
+            }
+            bool readable = events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR);
+            if (readable && on_readable(&opts, &conns, conn) == -1) continue;
+            if (conn->busy) on_writable(&opts, &conns, conn);
+        }
+    }
+}
@@ -0,0 +1,219 @@
+/**
+ * Writer module.
+ * @brief Implementation of the writer module definitions.
+ * @file writer.c
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include "writer.h"
+#include "misc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/**
+ * @brief Creates an io_uring instance.
+ * @param entries Count of submission queue entries.
+ * @param p Parameters to be updated with the offsets of the rings.
+ * @return File descriptor on success, -1 on error.
+ */
+static int uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+/**
+ * @brief Submits queued entries and waits for completions.
+ * @param fd Io_uring file descriptor.
+ * @param submit Count of entries to be submitted.
+ * @param wait Count of completions to wait for.
+ * @return Count of submitted entries on success, -1 on error.
+ */
+static int uring_enter(int fd, unsigned submit, unsigned wait) {
+    return (int) syscall(__NR_io_uring_enter, fd, submit, wait, (wait > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+}
+
+/**
+ * @brief Maps a ring of an io_uring instance.
+ * @param fd Io_uring file descriptor.
+ * @param size Size of the ring.
+ * @param off Offset that selects the ring.
+ * @return Mapped ring on success, NULL on error.
+ */
+static void *map_ring(int fd, size_t size, off_t off) {
+    void *ring = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, off);
+    return (ring == MAP_FAILED) ? NULL : ring;
+}
+
+int writer_init(t_writer *w, t_written written, void *arg) {
+    memset(w, 0, sizeof(t_writer));
+    w->written = written;
+    w->arg = arg;
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    w->fd = uring_setup(WRITER_DEPTH, &p);
+    if (w->fd == -1) return t_err("io_uring_setup");
+    w->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    w->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && w->cq_ring_size > w->sq_ring_size) w->sq_ring_size = w->cq_ring_size;
+    w->sq_ring = map_ring(w->fd, w->sq_ring_size, IORING_OFF_SQ_RING);
+    if (w->sq_ring == NULL) return t_err("mmap");
+    w->cq_ring = single ? w->sq_ring : map_ring(w->fd, w->cq_ring_size, IORING_OFF_CQ_RING);
+    if (w->cq_ring == NULL) return t_err("mmap");
+    w->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    w->sqes = map_ring(w->fd, w->sqes_size, IORING_OFF_SQES);
+    if (w->sqes == NULL) return t_err("mmap");
+    char *sq = (char *) w->sq_ring;
+    char *cq = (char *) w->cq_ring;
+    w->sq_head = (unsigned *) (sq + p.sq_off.head);
+    w->sq_tail = (unsigned *) (sq + p.sq_off.tail);
+    w->sq_mask = (unsigned *) (sq + p.sq_off.ring_mask);
+    w->sq_array = (unsigned *) (sq + p.sq_off.array);
+    w->cq_head = (unsigned *) (cq + p.cq_off.head);
+    w->cq_tail = (unsigned *) (cq + p.cq_off.tail);
+    w->cq_mask = (unsigned *) (cq + p.cq_off.ring_mask);
+    w->cqes = cq + p.cq_off.cqes;
+    return 0;
+}
+
+char *writer_alloc(t_writer *w) {
+    if (w->spare_c > 0) return w->spare[--w->spare_c];
+    void *buf;
+    int err = posix_memalign(&buf, WRITER_ALIGN, WRITER_BUF_SIZE);
+    if (err != 0) {
+        errno = err;
+        t_err("posix_memalign");
+        return NULL;
+    }
+    return (char *) buf;
+}
+
+void writer_release(t_writer *w, char *buf) {
+    if (w->spare_c < WRITER_SPARE_MAX) w->spare[w->spare_c++] = buf;
+    else free(buf);
+}
+
+/**
+ * @brief Queues the rest of a write to the submission queue and submits it.
+ * @details If the submission fails before the kernel took the entry, the entry is taken back from the queue, so the
+ * buffer and the slot of the write may be reused. An entry that the kernel took completes like any other.
+ * @param w Writer.
+ * @param slot Index of the write.
+ * @return 0 on success, -1 on error (the write is not in flight then).
+ */
+static int queue_write(t_writer *w, int slot) {
+    t_write *wr = &w->writes[slot];
+    unsigned tail = *w->sq_tail;
+    unsigned idx = tail & *w->sq_mask;
+    struct io_uring_sqe *sqe = &((struct io_uring_sqe *) w->sqes)[idx];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = wr->fd;
+    sqe->addr = (unsigned long) (wr->buf + wr->done);
+    sqe->len = wr->len - wr->done;
+    sqe->off = wr->off + wr->done;
+    sqe->user_data = slot;
+    w->sq_array[idx] = idx;
+    __atomic_store_n(w->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    while (uring_enter(w->fd, 1, 0) == -1) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+        if (__atomic_load_n(w->sq_head, __ATOMIC_ACQUIRE) != tail) return 0;
+        __atomic_store_n(w->sq_tail, tail, __ATOMIC_RELEASE);
+        return t_err("io_uring_enter");
+    }
+    return 0;
+}
+
+/**
+ * @brief Finishes a write and passes its result to the receiver.
+ * @param w Writer.
+ * @param slot Index of the write.
+ * @param err 0 on success, error number on failure.
+ */
+static void finish_write(t_writer *w, int slot, int err) {
+    t_write *wr = &w->writes[slot];
+    long owner = wr->owner;
+    unsigned long long end = wr->end;
+    writer_release(w, wr->buf);
+    wr->buf = NULL;
+    w->write_c--;
+    if (w->written != NULL) w->written(w->arg, owner, err, end);
+}
+
+int writer_submit(t_writer *w, int fd, char *buf, size_t len, unsigned long long off, unsigned long long end,
+    long owner) {
+    while (w->write_c == WRITER_DEPTH) {
+        if (writer_reap(w, true) == -1) {
+            writer_release(w, buf);
+            return t_err("writer_reap");
+        }
+    }
+    int slot;
+    for (slot = 0; w->writes[slot].buf != NULL; slot++);
+    t_write *wr = &w->writes[slot];
+    wr->buf = buf;
+    wr->fd = fd;
+    wr->len = len;
+    wr->done = 0;
+    wr->off = off;
+    wr->end = end;
+    wr->owner = owner;
+    w->write_c++;
+    if (queue_write(w, slot) == -1) {
+        writer_release(w, buf);
+        wr->buf = NULL;
+        w->write_c--;
+        return t_err("queue_write");
+    }
+    return 0;
+}
+
+int writer_reap(t_writer *w, bool wait) {
+    unsigned head = *w->cq_head;
+    if (wait && w->write_c > 0 && head == __atomic_load_n(w->cq_tail, __ATOMIC_ACQUIRE)) {
+        while (uring_enter(w->fd, 0, 1) == -1) {
+            if (errno != EINTR) return t_err("io_uring_enter");
+        }
+    }
+    unsigned tail = __atomic_load_n(w->cq_tail, __ATOMIC_ACQUIRE);
+    int err = 0;
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = &((struct io_uring_cqe *) w->cqes)[head & *w->cq_mask];
+        int slot = (int) cqe->user_data;
+        t_write *wr = &w->writes[slot];
+        if (cqe->res < 0 && cqe->res != -EINTR && cqe->res != -EAGAIN) {
+            finish_write(w, slot, -cqe->res);
+            continue;
+        }
+        if (cqe->res > 0) wr->done += cqe->res;
+        if (cqe->res == 0 && wr->done < wr->len) {
+            finish_write(w, slot, EIO);
+        } else if (wr->done == wr->len) {
+            finish_write(w, slot, 0);
+        } else if (queue_write(w, slot) == -1) {
+            finish_write(w, slot, errno);
+            err = -1;
+        }
+    }
+    __atomic_store_n(w->cq_head, head, __ATOMIC_RELEASE);
+    return err;
+}
+
+void writer_free(t_writer *w) {
+    if (w->fd != -1) {
+        w->written = NULL;
+        while (w->write_c > 0 && writer_reap(w, true) == 0);
+    }
+    for (int i = 0; i < WRITER_DEPTH; i++) free(w->writes[i].buf);
+    for (int i = 0; i < w->spare_c; i++) free(w->spare[i]);
+    if (w->sqes != NULL) munmap(w->sqes, w->sqes_size);
+    if (w->cq_ring != NULL && w->cq_ring != w->sq_ring) munmap(w->cq_ring, w->cq_ring_size);
+    if (w->sq_ring != NULL) munmap(w->sq_ring, w->sq_ring_size);
+    if (w->fd != -1) close(w->fd);
+    w->fd = -1;
+}
@@ -0,0 +1,125 @@
+/**
+ * Writer module definitions.
+ * @brief Covers asynchronous file writes with io_uring.
+ * @details Writes are queued to an io_uring instance and complete in the background, so the caller keeps receiving
+ * while earlier bytes go to the disk. The instance is set up with the raw system calls, no library is needed.<br>
+ * Buffers are aligned to WRITER_ALIGN and WRITER_BUF_SIZE bytes large, so they can be written to files opened with
+ * O_DIRECT. A submitted buffer belongs to the writer until its write is complete, it is then kept for reuse. Short
+ * writes are continued by the writer, the owner of a write learns about its completion from a callback.
+ * @file writer.h
+ * @author Tobias Gruber, 11912367
+ * @date 19.10.2026
+ **/
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define WRITER_ALIGN 4096 /**< Alignment of buffers, offsets and lengths of writes to files opened with O_DIRECT. */
+#define WRITER_BUF_SIZE 4194304 /**< Size of a buffer. */
+#define WRITER_DEPTH 64 /**< Maximum count of writes in flight. */
+#define WRITER_SPARE_MAX 8 /**< Maximum count of buffers kept for reuse. */
+
+/**
+ * @brief Receives the completion of a write.
+ * @param arg Argument passed to writer_init().
+ * @param owner Owner passed to writer_submit().
+ * @param err 0 on success, error number on failure.
+ * @param end Offset after the last written byte.
+ */
+typedef void (*t_written)(void *arg, long owner, int err, unsigned long long end);
+
+/**
+ * @brief Write in flight.
+ */
+typedef struct Write {
+    char *buf; /**< Buffer of the write, NULL if the slot is free. */
+    int fd; /**< File descriptor. */
+    size_t len; /**< Length of the write. */
+    size_t done; /**< Count of bytes written so far. */
+    unsigned long long off; /**< Offset of the write in the file. */
+    unsigned long long end; /**< Offset reported as the end of the write. */
+    long owner; /**< Owner of the write. */
+} t_write;
+
+/**
+ * @brief Io_uring instance with its writes.
+ */
+typedef struct Writer {
+    int fd; /**< Io_uring file descriptor, -1 if there is none. */
+    void *sq_ring; /**< Mapped submission queue ring. */
+    size_t sq_ring_size; /**< Size of the submission queue ring. */
+    void *cq_ring; /**< Mapped completion queue ring (same as the submission queue ring if mapped together). */
+    size_t cq_ring_size; /**< Size of the completion queue ring. */
+    void *sqes; /**< Mapped submission queue entries. */
+    size_t sqes_size; /**< Size of the submission queue entries. */
+    unsigned *sq_head; /**< Head of the submission queue (advanced by the kernel). */
+    unsigned *sq_tail; /**< Tail of the submission queue. */
+    unsigned *sq_mask; /**< Index mask of the submission queue. */
+    unsigned *sq_array; /**< Indices of the submitted entries. */
+    unsigned *cq_head; /**< Head of the completion queue. */
+    unsigned *cq_tail; /**< Tail of the completion queue. */
+    unsigned *cq_mask; /**< Index mask of the completion queue. */
+    void *cqes; /**< Completion queue entries. */
+    t_write writes[WRITER_DEPTH]; /**< Slots of the writes in flight. */
+    int write_c; /**< Count of writes in flight. */
+    char *spare[WRITER_SPARE_MAX]; /**< Buffers kept for reuse. */
+    int spare_c; /**< Count of buffers kept for reuse. */
+    t_written written; /**< Receiver of completions. */
+    void *arg; /**< Argument of the receiver. */
+} t_writer;
+
+/**
+ * @brief Sets up a writer.
+ * @details Must be released with writer_free() (also on error).
+ * @param w Writer to be initialized.
+ * @param written Receiver of completions.
+ * @param arg Argument of the receiver.
+ * @return 0 on success, -1 on error (e.g. if the kernel does not support io_uring).
+ */
+int writer_init(t_writer *w, t_written written, void *arg);
+
+/**
+ * @brief Returns a buffer for a write.
+ * @details The buffer must be passed to writer_submit() or writer_release().
+ * @param w Writer.
+ * @return Buffer of WRITER_BUF_SIZE bytes aligned to WRITER_ALIGN, NULL on error.
+ */
+char *writer_alloc(t_writer *w);
+
+/**
+ * @brief Takes back a buffer that is not written.
+ * @param w Writer.
+ * @param buf Buffer returned by writer_alloc().
+ */
+void writer_release(t_writer *w, char *buf);
+
+/**
+ * @brief Queues a write of a buffer.
+ * @details Waits for a completion if WRITER_DEPTH writes are in flight. The buffer belongs to the writer afterwards,
+ * also on error.
+ * @param w Writer.
+ * @param fd File descriptor.
+ * @param buf Buffer returned by writer_alloc().
+ * @param len Length of the write.
+ * @param off Offset in the file.
+ * @param end Offset reported as the end of the write (e.g. without padding).
+ * @param owner Owner passed to the receiver of the completion.
+ * @return 0 on success, -1 on error.
+ */
+int writer_submit(t_writer *w, int fd, char *buf, size_t len, unsigned long long off, unsigned long long end,
+    long owner);
+
+/**
+ * @brief Passes completed writes to the receiver.
+ * @param w Writer.
+ * @param wait Whether to wait for a completion if none is there yet (and a write is in flight).
+ * @return 0 on success, -1 on error.
+ */
+int writer_reap(t_writer *w, bool wait);
+
+/**
+ * @brief Releases a writer.
+ * @details Writes in flight are completed without passing them to the receiver.
+ * @param w Writer to be released.
+ */
+void writer_free(t_writer *w);